@@ -0,0 +1,826 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stb_image.h>
+#include "GeometryArena.h"
+#include "MipGenerator.h"
+#include "RenderQueue.h"
+#include "SceneFile.h"
+#include "SceneInstancer.h"
+#include "SceneText.h"
+#include "ShaderLibrary.h"
+#include "ShapeBatcher.h"
+#include "TextureCache.h"
+#include "TextureCompression.h"
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+#include "TransformSystem.h"
+
+// CPU cost of the renderer's GL-facing paths against CountingGlDispatch, and
+// of the transform and scene work that feeds them, so they can be tracked on
+// machines without a GPU. Besides time, the GL benchmarks report the calls
+// they make per iteration; a change in those counters is a change in the work
+// the driver would be given.
+namespace {
+    using render::CountingGlDispatch;
+
+    const std::string ShaderDirectory = std::string(RESOURCE_DIRECTORY) + "/shaders/";
+
+    const std::vector<render::VertexAttribute> PositionLayout = {{0, 2, GL_FLOAT, GL_FALSE, 0}};
+
+    void reportCalls(benchmark::State &state, const CountingGlDispatch::Counters &counters) {
+        double iterations = static_cast<double>(state.iterations());
+        state.counters["calls"] = counters.total() / iterations;
+        state.counters["draws"] = (counters.draws + counters.instancedDraws + counters.multiDraws) / iterations;
+        state.counters["uploadBytes"] = counters.bytesUploaded / iterations;
+    }
+
+    void loadAppPrograms(shaders::ShaderLibrary &library) {
+        library.loadProgram({ShaderDirectory + "ver.glsl", ShaderDirectory + "frag.glsl", {}});
+        library.loadProgram({ShaderDirectory + "shape_vertex.glsl", ShaderDirectory + "shape_fragment.glsl", {}});
+    }
+
+    std::string shaderCacheDirectory() {
+        return (std::filesystem::temp_directory_path() / "render_benchmarks_shader_cache").string();
+    }
+
+    // A quad per mesh, each with its own vertices so none are deduplicated.
+    std::vector<float> makeQuad(size_t index) {
+        float x = static_cast<float>(index % 64) / 32.f - 1.f;
+        float y = static_cast<float>(index / 64 % 64) / 32.f - 1.f;
+        float size = 1.f / 64.f;
+        return {x, y, x + size, y, x + size, y + size, x, y + size};
+    }
+
+    const GLuint QuadIndices[] = {0, 1, 2, 0, 2, 3};
+}
+
+// Reading, preprocessing, compiling and linking the app's two programs.
+static void BM_ShaderLoadCold(benchmark::State &state) {
+    CountingGlDispatch gl;
+    for (auto _ : state) {
+        shaders::ShaderLibrary library(gl, shaderCacheDirectory());
+        loadAppPrograms(library);
+    }
+    reportCalls(state, gl.counters);
+}
+BENCHMARK(BM_ShaderLoadCold);
+
+// Asking a library for programs it already holds, as hot reload does for
+// every program whose files haven't changed.
+static void BM_ShaderLoadCached(benchmark::State &state) {
+    CountingGlDispatch gl;
+    shaders::ShaderLibrary library(gl, shaderCacheDirectory());
+    loadAppPrograms(library);
+    gl.counters = {};
+    for (auto _ : state) {
+        loadAppPrograms(library);
+    }
+    reportCalls(state, gl.counters);
+}
+BENCHMARK(BM_ShaderLoadCached);
+
+// Filling a GeometryArena that starts too small, so it also grows.
+static void BM_BufferSetup(benchmark::State &state) {
+    size_t meshes = static_cast<size_t>(state.range(0));
+    std::vector<std::vector<float>> quads;
+    for (size_t i = 0; i < meshes; ++i) {
+        quads.push_back(makeQuad(i));
+    }
+
+    CountingGlDispatch gl;
+    for (auto _ : state) {
+        render::GeometryArena arena(gl, sizeof(GLfloat) * 2, PositionLayout, 256, 256);
+        for (const auto &quad : quads) {
+            arena.addMesh(quad.data(), 4, QuadIndices, 6);
+        }
+        benchmark::DoNotOptimize(arena.getStats());
+    }
+    reportCalls(state, gl.counters);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BufferSetup)->Arg(64)->Arg(1024)->Arg(8192);
+
+// Submitting and flushing one frame of draws spread over a few materials and
+// layers; the ratio of draws to submitted items is what batching saves.
+static void BM_FrameSubmission(benchmark::State &state) {
+    size_t items = static_cast<size_t>(state.range(0));
+    CountingGlDispatch gl;
+    render::GeometryArena arena(gl, sizeof(GLfloat) * 2, PositionLayout);
+    std::vector<render::MeshRange> meshes;
+    for (size_t i = 0; i < 256; ++i) {
+        meshes.push_back(arena.getMesh(arena.addMesh(makeQuad(i).data(), 4, QuadIndices, 6)));
+    }
+
+    render::RenderQueue queue(gl);
+    render::ProgramId program = queue.addProgram(1);
+    render::VertexArrayId vao = queue.addVertexArray(arena.getVertexArray());
+    std::vector<render::MaterialId> materials;
+    for (int i = 0; i < 16; ++i) {
+        materials.push_back(queue.addMaterial({{{0, 4, {i / 16.f, 0.f, 0.f, 1.f}}}}));
+    }
+    gl.counters = {};
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < items; ++i) {
+            const render::MeshRange &mesh = meshes[i % meshes.size()];
+            queue.submit({program, vao, materials[i * 7 % materials.size()], static_cast<uint8_t>(i % 2),
+                          static_cast<float>(i % 100) / 100.f, mesh.indexCount, mesh.firstIndex, mesh.baseVertex});
+        }
+        queue.flush();
+    }
+    reportCalls(state, gl.counters);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FrameSubmission)->Arg(256)->Arg(4096)->Arg(32768);
+
+// One frame of shapes through the instanced batcher, circles, rings and
+// rounded rects in turn as on a dashboard.
+static void BM_ShapeBatcherFrame(benchmark::State &state) {
+    size_t shapes = static_cast<size_t>(state.range(0));
+    CountingGlDispatch gl;
+    render::ShapeBatcher batcher(gl);
+    batcher.setProgram(1, 0);
+    gl.counters = {};
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < shapes; ++i) {
+            glm::vec2 center(static_cast<float>(i % 640), static_cast<float>(i / 640 % 480));
+            if (i % 3 == 0) {
+                batcher.addCircle(center, 4.f, {1.f, 0.f, 0.f, 1.f});
+            } else if (i % 3 == 1) {
+                batcher.addRing(center, 4.f, 1.5f, {0.f, 1.f, 0.f, 1.f});
+            } else {
+                batcher.addRoundedRect(center, {6.f, 3.f}, 1.f, {0.f, 0.f, 1.f, 1.f});
+            }
+        }
+        batcher.flush({640.f, 480.f});
+    }
+    reportCalls(state, gl.counters);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShapeBatcherFrame)->Arg(1024)->Arg(65536)->Arg(100000);
+
+// A frame of the figure scene the app draws at 640x480: meshes instantiated,
+// uploaded once into the arena and drawn through the queue, circles converted
+// to pixels as the window path does and drawn through the shape batcher.
+// "draws" is the draw-call count per frame for the scene.
+static void BM_SceneFrame(benchmark::State &state) {
+    std::ifstream text(std::string(RESOURCE_DIRECTORY) + "/scenes/figure.scene.txt");
+    scene::SceneFile figure(scene::compileScene(scene::parseSceneText(text, "figure.scene.txt")), "figure");
+
+    threading::ThreadPool pool(1);
+    scene::TransformSystem transforms(pool);
+    scene::SceneInstancer instancer(figure, transforms);
+    const glm::vec2 viewport(640.f, 480.f);
+    const auto &created = instancer.instantiate(scene::Frustum::fromMatrix(glm::mat4(1.f), viewport.y * 0.5f, 0.5f));
+    transforms.update();
+
+    CountingGlDispatch gl;
+    render::GeometryArena arena(gl, sizeof(GLfloat) * 2, PositionLayout);
+    render::RenderQueue queue(gl);
+    render::ShapeBatcher batcher(gl);
+    batcher.setProgram(2, 0);
+    render::ProgramId program = queue.addProgram(1);
+    render::VertexArrayId vao = queue.addVertexArray(arena.getVertexArray());
+    std::vector<render::MaterialId> materials;
+    for (size_t i = 0; i < figure.getMaterialCount(); ++i) {
+        const float *color = figure.getMaterials()[i].color;
+        materials.push_back(queue.addMaterial({{{0, 4, {color[0], color[1], color[2], color[3]}}}}));
+    }
+
+    std::vector<render::DrawItem> draws;
+    std::vector<render::ShapeInstance> circles;
+    for (uint32_t node : created) {
+        const scene::SceneNode &sceneNode = figure.getNodes()[node];
+        if (sceneNode.mesh == scene::NoIndex) {
+            continue;
+        }
+        const scene::SceneMesh &mesh = figure.getMeshes()[sceneNode.mesh];
+        const float *color = figure.getMaterials()[sceneNode.material].color;
+        if (figure.getMaterials()[sceneNode.material].shader == uint32_t(scene::MaterialShader::Circle)) {
+            scene::SceneCircle circle = scene::getInscribedCircle(
+                    mesh, transforms.getWorldMatrix(instancer.getObject(node)));
+            circles.push_back(render::makeNdcCircle(circle.center, circle.radius, viewport,
+                                                    {color[0], color[1], color[2], color[3]}));
+            continue;
+        }
+        render::MeshRange range = arena.getMesh(arena.addMesh(figure.getVertices(mesh), mesh.vertexCount,
+                                                              figure.getIndices(mesh), mesh.indexCount));
+        draws.push_back({program, vao, materials[sceneNode.material], 0, 0.f, range.indexCount, range.firstIndex,
+                         range.baseVertex});
+    }
+    gl.counters = {};
+
+    for (auto _ : state) {
+        gl.clearColor(1.f, 0.5f, 0.f, 1.f);
+        gl.clear(GL_COLOR_BUFFER_BIT);
+        for (const auto &draw : draws) {
+            queue.submit(draw);
+        }
+        queue.flush();
+        batcher.addInstances(circles.data(), circles.size());
+        batcher.flush(viewport);
+    }
+    reportCalls(state, gl.counters);
+    state.counters["nodes"] = static_cast<double>(created.size());
+}
+BENCHMARK(BM_SceneFrame);
+
+namespace {
+    // A forest of roots with seven children each, scattered through a cube
+    // 1000 wide, seen from its middle down +z: half of it is behind the camera
+    // and the far side is mostly below a pixel.
+    struct TransformForest {
+        struct Object {
+            glm::vec3 position;
+            glm::quat rotation;
+            glm::vec3 scale;
+            scene::ObjectId parent;
+            glm::vec4 bounds;
+        };
+
+        std::vector<Object> objects;
+        std::vector<scene::ObjectId> roots;
+        scene::Frustum frustum;
+
+        explicit TransformForest(size_t count) {
+            const size_t Fanout = 7;
+            std::mt19937 random(1);
+            std::uniform_real_distribution<float> spread(-500.f, 500.f);
+            std::uniform_real_distribution<float> offset(-5.f, 5.f);
+            std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+
+            while (objects.size() < count) {
+                bool root = objects.size() % (Fanout + 1) == 0;
+                if (root) {
+                    roots.push_back(static_cast<scene::ObjectId>(objects.size()));
+                }
+                Object object;
+                object.parent = root ? scene::NoParent : roots.back();
+                object.position = root ? glm::vec3(spread(random), spread(random), spread(random))
+                                       : glm::vec3(offset(random), offset(random), offset(random));
+                object.rotation = glm::angleAxis(angle(random), glm::vec3(0.f, 1.f, 0.f));
+                object.scale = glm::vec3(root ? 2.f : 0.5f);
+                object.bounds = glm::vec4(0.f, 0.f, 0.f, root ? 4.f : 1.f);
+                objects.push_back(object);
+            }
+
+            glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 1000.f);
+            glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 0.f));
+            frustum = scene::Frustum::fromMatrix(projection * view, projection[1][1] * 1080.f * 0.5f, 1.f);
+        }
+
+        void addTo(scene::TransformSystem &transforms) const {
+            transforms.reserve(objects.size());
+            for (const Object &object : objects) {
+                scene::ObjectId id = transforms.create(object.parent);
+                transforms.setPosition(id, object.position);
+                transforms.setRotation(id, object.rotation);
+                transforms.setScale(id, object.scale);
+                transforms.setLocalBounds(id, glm::vec3(object.bounds), object.bounds.w);
+            }
+        }
+    };
+
+    const glm::quat Turn = glm::angleAxis(0.01f, glm::vec3(0.f, 1.f, 0.f));
+}
+
+// A frame of TransformSystem on every core: every root turns, then the
+// hierarchy is updated, culled and the visible matrices gathered into the
+// instance buffer, which is orphaned and refilled.
+static void BM_TransformFrame(benchmark::State &state) {
+    TransformForest forest(static_cast<size_t>(state.range(0)));
+    threading::ThreadPool pool(std::thread::hardware_concurrency());
+    scene::TransformSystem transforms(pool);
+    forest.addTo(transforms);
+    transforms.update();
+
+    std::vector<scene::ObjectId> visible;
+    std::vector<glm::mat4> instanceMatrices;
+    CountingGlDispatch gl;
+    for (auto _ : state) {
+        for (scene::ObjectId root : forest.roots) {
+            forest.objects[root].rotation = Turn * forest.objects[root].rotation;
+            transforms.setRotation(root, forest.objects[root].rotation);
+        }
+        transforms.update();
+        transforms.cull(forest.frustum, visible);
+        instanceMatrices.resize(visible.size());
+        transforms.gatherMatrices(visible, instanceMatrices.data());
+        GLsizeiptr bytes = static_cast<GLsizeiptr>(instanceMatrices.size() * sizeof(glm::mat4));
+        gl.bindBuffer(GL_ARRAY_BUFFER, 1);
+        gl.bufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        gl.bufferSubData(GL_ARRAY_BUFFER, 0, bytes, instanceMatrices.data());
+    }
+    reportCalls(state, gl.counters);
+    state.counters["visible"] = static_cast<double>(visible.size());
+    state.counters["threads"] = static_cast<double>(pool.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformFrame)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The same frame per object with glm on one thread, as it would be written
+// without the system; BM_TransformFrame's time over this one is the speedup.
+static void BM_TransformFrameScalar(benchmark::State &state) {
+    TransformForest forest(static_cast<size_t>(state.range(0)));
+    auto &objects = forest.objects;
+    const scene::Frustum &frustum = forest.frustum;
+    std::vector<glm::mat4> world(objects.size());
+    std::vector<scene::ObjectId> visible;
+    std::vector<glm::mat4> instanceMatrices;
+
+    for (auto _ : state) {
+        for (scene::ObjectId root : forest.roots) {
+            objects[root].rotation = Turn * objects[root].rotation;
+        }
+
+        visible.clear();
+        instanceMatrices.clear();
+        for (size_t i = 0; i < objects.size(); ++i) {
+            const auto &object = objects[i];
+            glm::mat4 local = glm::translate(glm::mat4(1.f), object.position) * glm::mat4_cast(object.rotation) *
+                              glm::scale(glm::mat4(1.f), object.scale);
+            world[i] = object.parent == scene::NoParent ? local : world[object.parent] * local;
+
+            glm::vec4 center = world[i] * glm::vec4(glm::vec3(object.bounds), 1.f);
+            float radius = object.bounds.w * std::max({glm::length(glm::vec3(world[i][0])),
+                                                       glm::length(glm::vec3(world[i][1])),
+                                                       glm::length(glm::vec3(world[i][2]))});
+            bool inside = true;
+            for (const auto &plane : frustum.planes) {
+                inside = inside && glm::dot(glm::vec3(plane), glm::vec3(center)) + plane.w >= -radius;
+            }
+            inside = inside && radius * frustum.pixelScale >= frustum.minScreenRadius * glm::dot(frustum.clipW, center);
+            if (inside) {
+                visible.push_back(static_cast<scene::ObjectId>(i));
+                instanceMatrices.push_back(world[i]);
+            }
+        }
+        benchmark::DoNotOptimize(instanceMatrices.data());
+    }
+    state.counters["visible"] = static_cast<double>(visible.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformFrameScalar)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+namespace {
+    // Peak heap use while enabled, relative to where it started. Every block
+    // carries its size in a header so frees can be counted; frees of blocks
+    // from before begin() can only make the peak read low.
+    class HeapTracking {
+    public:
+        void begin() {
+            current = 0;
+            peak = 0;
+            enabled = true;
+        }
+
+        int64_t end() {
+            enabled = false;
+            return peak;
+        }
+
+        void allocated(size_t size) {
+            if (enabled.load(std::memory_order_relaxed)) {
+                int64_t now = current.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) +
+                              static_cast<int64_t>(size);
+                int64_t highest = peak.load(std::memory_order_relaxed);
+                while (now > highest && !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+                }
+            }
+        }
+
+        void freed(size_t size) {
+            if (enabled.load(std::memory_order_relaxed)) {
+                current.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::atomic<bool> enabled{false};
+        std::atomic<int64_t> current{0};
+        std::atomic<int64_t> peak{0};
+    };
+
+    HeapTracking heapTracking;
+
+    const size_t HeapHeader = alignof(std::max_align_t);
+}
+
+void *operator new(size_t size) {
+    auto block = static_cast<char *>(std::malloc(size + HeapHeader));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    std::memcpy(block, &size, sizeof(size));
+    heapTracking.allocated(size);
+    return block + HeapHeader;
+}
+
+void operator delete(void *pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    auto block = static_cast<char *>(pointer) - HeapHeader;
+    size_t size;
+    std::memcpy(&size, block, sizeof(size));
+    heapTracking.freed(size);
+    std::free(block);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+namespace {
+    // Groups of one empty root and 15 children placed around it, scattered over
+    // an extent x extent square at z = 0; three shared meshes and eight materials.
+    scene::SceneDescription makeSpreadScene(size_t nodeCount, float extent) {
+        scene::SceneDescription description;
+        description.meshes.push_back({"quad", {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f}, {0, 1, 2, 0, 2, 3}});
+        description.meshes.push_back({"triangle", {-1.f, -1.f, 1.f, -1.f, 0.f, 1.f}, {0, 1, 2}});
+        scene::MeshDescription hexagon{"hexagon", {}, {}};
+        for (uint32_t corner = 0; corner < 6; ++corner) {
+            hexagon.vertices.push_back(std::cos(corner * 1.0471976f));
+            hexagon.vertices.push_back(std::sin(corner * 1.0471976f));
+            if (corner >= 2) {
+                hexagon.indices.insert(hexagon.indices.end(), {0, corner - 1, corner});
+            }
+        }
+        description.meshes.push_back(std::move(hexagon));
+        for (int i = 0; i < 8; ++i) {
+            description.materials.push_back({"material" + std::to_string(i),
+                                             {(i & 1) * 1.f, (i >> 1 & 1) * 1.f, (i >> 2 & 1) * 1.f, 1.f},
+                                             i == 7 ? scene::MaterialShader::Circle : scene::MaterialShader::Flat});
+        }
+
+        const size_t GroupSize = 16;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> spread(-extent * 0.5f, extent * 0.5f);
+        std::uniform_real_distribution<float> offset(-5.f, 5.f);
+        std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+        std::uniform_real_distribution<float> size(0.5f, 2.f);
+
+        uint32_t root = scene::NoIndex;
+        for (size_t i = 0; i < nodeCount; ++i) {
+            scene::NodeDescription node;
+            node.name = "n" + std::to_string(i);
+            if (i % GroupSize == 0) {
+                root = static_cast<uint32_t>(i);
+                node.position = {spread(random), spread(random), 0.f};
+            } else {
+                node.parent = root;
+                node.mesh = static_cast<uint32_t>(random() % description.meshes.size());
+                node.material = static_cast<uint32_t>(random() % description.materials.size());
+                node.position = {offset(random), offset(random), 0.f};
+                node.rotation = glm::angleAxis(angle(random), glm::vec3(0.f, 0.f, 1.f));
+                node.scale = glm::vec3(size(random));
+            }
+            description.nodes.push_back(std::move(node));
+        }
+        return description;
+    }
+
+    const float SceneExtent = 1000.f;
+
+    // The spread scene of the given size written in both forms to the temp
+    // directory; both stay in the page cache while the benchmarks read them.
+    struct SceneFiles {
+        std::string textPath;
+        std::string binaryPath;
+        size_t textBytes = 0;
+        size_t binaryBytes = 0;
+
+        explicit SceneFiles(size_t nodeCount) {
+            auto directory = std::filesystem::temp_directory_path();
+            textPath = (directory / "render_benchmarks.scene.txt").string();
+            binaryPath = (directory / "render_benchmarks.scene").string();
+
+            scene::SceneDescription description = makeSpreadScene(nodeCount, SceneExtent);
+            std::ofstream text(textPath, std::ios::out | std::ios::trunc);
+            scene::writeSceneText(description, text);
+            std::vector<char> image = scene::compileScene(description);
+            std::ofstream binary(binaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            binary.write(image.data(), static_cast<std::streamsize>(image.size()));
+            if (!text || !binary) {
+                throw std::runtime_error("Can't write the benchmark scene to " + directory.string());
+            }
+            textBytes = static_cast<size_t>(text.tellp());
+            binaryBytes = image.size();
+        }
+
+        ~SceneFiles() {
+            std::filesystem::remove(textPath);
+            std::filesystem::remove(binaryPath);
+        }
+    };
+
+    // A view over the given fraction of the scene's width, at 1080 pixels.
+    scene::Frustum makeSceneView(float fraction) {
+        float half = SceneExtent * fraction * 0.5f;
+        glm::mat4 projection = glm::ortho(-half, half, -half, half, -1.f, 1.f);
+        return scene::Frustum::fromMatrix(projection, projection[1][1] * 1080.f * 0.5f, 1.f);
+    }
+
+    // From nothing to the nodes in view instantiated and their transforms up
+    // to date: parsing and compiling the text form, or mapping the compiled
+    // one. peakHeapBytes is the most heap one open held at once, measured on
+    // a run of its own after the timed ones; the compiled form's mapping isn't
+    // heap, and at most fileBytes of it can be resident.
+    void openScene(benchmark::State &state, bool compiled) {
+        SceneFiles files(static_cast<size_t>(state.range(0)));
+        auto frustum = makeSceneView(0.1f);
+        threading::ThreadPool pool;
+        size_t instantiated = 0;
+
+        auto open = [&] {
+            scene::TransformSystem transforms(pool);
+            std::unique_ptr<scene::SceneFile> sceneFile;
+            if (compiled) {
+                sceneFile = std::make_unique<scene::SceneFile>(files.binaryPath);
+            } else {
+                std::ifstream input(files.textPath);
+                sceneFile = std::make_unique<scene::SceneFile>(
+                        scene::compileScene(scene::parseSceneText(input, files.textPath)), files.textPath);
+            }
+            scene::SceneInstancer instancer(*sceneFile, transforms);
+            instancer.instantiate(frustum);
+            transforms.update();
+            instantiated = instancer.getInstantiatedCount();
+        };
+        for (auto _ : state) {
+            open();
+        }
+
+        heapTracking.begin();
+        open();
+        state.counters["peakHeapBytes"] = static_cast<double>(heapTracking.end());
+        state.counters["instantiated"] = static_cast<double>(instantiated);
+        state.counters["fileBytes"] = static_cast<double>(compiled ? files.binaryBytes : files.textBytes);
+    }
+}
+
+// Opening the text form of a spread scene and instantiating what a view over
+// a tenth of its width sees.
+static void BM_SceneOpenText(benchmark::State &state) {
+    openScene(state, false);
+}
+BENCHMARK(BM_SceneOpenText)->Arg(20000)->Arg(200000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The same from the compiled form, which is mapped rather than read.
+static void BM_SceneOpenCompiled(benchmark::State &state) {
+    openScene(state, true);
+}
+BENCHMARK(BM_SceneOpenCompiled)->Arg(20000)->Arg(200000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+namespace {
+    // A size x size RGBA8 image: smooth gradients with some noise on top, so
+    // neither the filters nor the BC1 encoder see flat blocks.
+    std::vector<uint8_t> makeTextureImage(int size) {
+        std::mt19937 random(1);
+        std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                uint8_t *pixel = pixels.data() + (static_cast<size_t>(y) * size + x) * 4;
+                int noise = static_cast<int>(random() % 32);
+                pixel[0] = static_cast<uint8_t>(x * 223 / size + noise);
+                pixel[1] = static_cast<uint8_t>(y * 223 / size + noise);
+                pixel[2] = static_cast<uint8_t>((x + y) * 111 / size + noise);
+                pixel[3] = 255;
+            }
+        }
+        return pixels;
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) {
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = crc >> 1 ^ (0xedb88320u & (0u - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    void appendBigEndian(std::vector<uint8_t> &out, uint32_t value) {
+        out.insert(out.end(), {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                               static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)});
+    }
+
+    void appendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+        appendBigEndian(png, static_cast<uint32_t>(data.size()));
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        appendBigEndian(png, crc32(png.data() + start, png.size() - start));
+    }
+
+    // The image as an RGBA PNG with the Sub filter on every row. There's no
+    // deflate encoder here, so the zlib stream holds stored blocks: decoding
+    // times the PNG unfiltering and stb_image's per-pixel work, not inflate.
+    std::vector<uint8_t> encodePng(const std::vector<uint8_t> &rgba, int size) {
+        std::vector<uint8_t> filtered;
+        size_t stride = static_cast<size_t>(size) * 4;
+        for (int y = 0; y < size; ++y) {
+            const uint8_t *row = rgba.data() + y * stride;
+            filtered.push_back(1);
+            for (size_t i = 0; i < stride; ++i) {
+                filtered.push_back(static_cast<uint8_t>(row[i] - (i >= 4 ? row[i - 4] : 0)));
+            }
+        }
+
+        std::vector<uint8_t> zlib = {0x78, 0x01};
+        for (size_t offset = 0; offset < filtered.size(); offset += 65535) {
+            size_t length = std::min<size_t>(65535, filtered.size() - offset);
+            zlib.push_back(offset + length == filtered.size() ? 1 : 0);
+            zlib.insert(zlib.end(), {static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                                     static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8)});
+            zlib.insert(zlib.end(), filtered.begin() + offset, filtered.begin() + offset + length);
+        }
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (uint8_t value : filtered) {
+            a = (a + value) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian(zlib, b << 16 | a);
+
+        std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        std::vector<uint8_t> header;
+        appendBigEndian(header, static_cast<uint32_t>(size));
+        appendBigEndian(header, static_cast<uint32_t>(size));
+        header.insert(header.end(), {8, 6, 0, 0, 0});
+        appendChunk(png, "IHDR", header);
+        appendChunk(png, "IDAT", zlib);
+        appendChunk(png, "IEND", {});
+        return png;
+    }
+}
+
+// Decoding a PNG held in memory to RGBA8, as a texture load miss does.
+static void BM_TextureDecode(benchmark::State &state) {
+    int size = static_cast<int>(state.range(0));
+    std::vector<uint8_t> png = encodePng(makeTextureImage(size), size);
+    for (auto _ : state) {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_uc *pixels =
+                stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &width, &height, &channels, 4);
+        if (pixels == nullptr) {
+            state.SkipWithError("stb_image can't decode the generated PNG");
+            break;
+        }
+        stbi_image_free(pixels);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK(BM_TextureDecode)->Arg(256)->Arg(2048)->Unit(benchmark::kMillisecond);
+
+// The full mip chain of an image with either filter.
+static void BM_MipChain(benchmark::State &state, textures::MipFilter filter) {
+    int size = static_cast<int>(state.range(0));
+    std::vector<uint8_t> image = makeTextureImage(size);
+    for (auto _ : state) {
+        textures::MipChain chain = textures::generateMipChain(image.data(), size, size, filter);
+        benchmark::DoNotOptimize(chain.pixels.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK_CAPTURE(BM_MipChain, Box, textures::MipFilter::Box)->Arg(256)->Arg(2048)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_MipChain, Kaiser, textures::MipFilter::Kaiser)->Arg(256)->Arg(2048)
+        ->Unit(benchmark::kMillisecond);
+
+// Encoding level 0 of an image to BC1.
+static void BM_CompressBc1(benchmark::State &state) {
+    int size = static_cast<int>(state.range(0));
+    std::vector<uint8_t> image = makeTextureImage(size);
+    std::vector<uint8_t> blocks(textures::bc1Size(size, size));
+    for (auto _ : state) {
+        textures::compressBc1(image.data(), size, size, blocks.data());
+        benchmark::DoNotOptimize(blocks.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK(BM_CompressBc1)->Arg(256)->Arg(2048)->Unit(benchmark::kMillisecond);
+
+// A warm start: reading a mipped texture back from its cache file, which is
+// mapped rather than copied, so the cost should stay flat with size.
+static void BM_TextureCacheWarm(benchmark::State &state) {
+    int size = static_cast<int>(state.range(0));
+    std::vector<uint8_t> image = makeTextureImage(size);
+    textures::MipChain chain = textures::generateMipChain(image.data(), size, size, textures::MipFilter::Box);
+    textures::TextureData texture;
+    texture.width = size;
+    texture.height = size;
+    for (const auto &level : chain.levels) {
+        texture.levels.push_back({level.width, level.height, chain.pixels.data() + level.offset, level.size});
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / "render_benchmarks_texture.txc").string();
+    const textures::CacheStamp stamp = {1234, 5678, textures::MipFilter::Box, false};
+    if (!textures::writeTextureCache(path, stamp, texture)) {
+        state.SkipWithError("Can't write the texture cache file");
+        return;
+    }
+    for (auto _ : state) {
+        auto cached = textures::readTextureCache(path, stamp);
+        if (cached == nullptr) {
+            state.SkipWithError("The texture cache file doesn't read back");
+            break;
+        }
+        benchmark::DoNotOptimize(cached->levels.data());
+    }
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_TextureCacheWarm)->Arg(256)->Arg(2048);
+
+namespace {
+    // Eight PNGs of the given size in a fresh temp directory, loaded through a
+    // TextureLoader on every core with its cache in that directory.
+    struct TextureFiles {
+        std::filesystem::path directory;
+        std::vector<std::string> paths;
+
+        explicit TextureFiles(int size)
+                : directory(std::filesystem::temp_directory_path() / "render_benchmarks_textures") {
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory);
+            std::vector<uint8_t> png = encodePng(makeTextureImage(size), size);
+            for (int i = 0; i < 8; ++i) {
+                paths.push_back((directory / ("texture" + std::to_string(i) + ".png")).string());
+                std::ofstream file(paths.back(), std::ios::out | std::ios::binary | std::ios::trunc);
+                file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+            }
+        }
+
+        ~TextureFiles() {
+            std::error_code error;
+            std::filesystem::remove_all(directory, error);
+        }
+
+        std::string cacheDirectory() const { return (directory / "cache").string(); }
+    };
+
+    void loadTextures(benchmark::State &state, bool warm) {
+        TextureFiles files(static_cast<int>(state.range(0)));
+        threading::ThreadPool pool(std::thread::hardware_concurrency());
+        textures::TextureOptions options;
+        options.compress = true;
+        textures::TextureLoader::Stats stats;
+
+        auto loadAll = [&] {
+            textures::TextureLoader loader(pool, files.cacheDirectory(), options);
+            for (const auto &path : files.paths) {
+                loader.load(path);
+            }
+            loader.wait();
+            stats = loader.getStats();
+        };
+        if (warm) {
+            loadAll();
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            std::error_code error;
+            if (!warm) {
+                std::filesystem::remove_all(files.cacheDirectory(), error);
+            }
+            state.ResumeTiming();
+            loadAll();
+        }
+        state.counters["cacheHits"] = static_cast<double>(stats.cacheHits);
+        state.counters["failures"] = static_cast<double>(stats.failures);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(files.paths.size()));
+    }
+}
+
+// Eight textures from source to compressed mips, written to the cache.
+static void BM_TextureLoadCold(benchmark::State &state) {
+    loadTextures(state, false);
+}
+BENCHMARK(BM_TextureLoadCold)->Arg(512)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The same eight served from a cache filled before timing starts.
+static void BM_TextureLoadWarm(benchmark::State &state) {
+    loadTextures(state, true);
+}
+BENCHMARK(BM_TextureLoadWarm)->Arg(512)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,13 @@
+#version 330 core
+
+// Converted meshes (MeshFormat.h) store positions as unsigned normalized
+// shorts across the mesh bounds; positionOffset + position * positionScale
+// maps them back, with the placement on screen folded in.
+layout (location = 0) in vec3 position;
+
+uniform vec4 positionOffset;
+uniform vec4 positionScale;
+
+void main() {
+    gl_Position = vec4(positionOffset.xyz + position * positionScale.xyz, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 330 core
+
+in vec2 localPosition;
+flat in vec4 shape;      // half size, ring band or corner radius, type
+flat in vec4 shapeColor; // premultiplied
+out vec4 color;
+
+float roundedBoxDistance(vec2 point, vec2 halfSize, float cornerRadius) {
+    vec2 q = abs(point) - halfSize + cornerRadius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - cornerRadius;
+}
+
+void main() {
+    // Same cases as render::shapeDistance; distances are in pixels.
+    float distance;
+    if (shape.w < 0.5) {
+        distance = length(localPosition) - shape.x;
+    } else if (shape.w < 1.5) {
+        float halfBand = shape.z * 0.5;
+        distance = abs(length(localPosition) - (shape.x - halfBand)) - halfBand;
+    } else {
+        distance = roundedBoxDistance(localPosition, shape.xy, shape.z);
+    }
+
+    color = shapeColor * clamp(0.5 - distance, 0.0, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Per instance, see render::ShapeInstance.
+layout (location = 0) in vec4 centerHalfSize;
+layout (location = 1) in float parameter;
+layout (location = 2) in vec4 color;
+layout (location = 3) in float type;
+
+uniform vec2 viewportSize;
+
+out vec2 localPosition;
+flat out vec4 shape;
+flat out vec4 shapeColor;
+
+const vec2 corners[4] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main() {
+    // One extra pixel on every side holds the anti-aliased edge.
+    localPosition = corners[gl_VertexID] * (centerHalfSize.zw + 1.0);
+    vec2 pixel = centerHalfSize.xy + localPosition;
+    gl_Position = vec4(pixel.x / viewportSize.x * 2.0 - 1.0, 1.0 - pixel.y / viewportSize.y * 2.0, 0.0, 1.0);
+
+    shape = vec4(centerHalfSize.zw, parameter, type);
+    shapeColor = vec4(color.rgb * color.a, color.a);
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include "FileWatcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const int PollIntervalMs = 100;
+
+    std::string joinPath(const std::string &directory, const std::string &name) {
+        return (std::filesystem::path(directory) / name).lexically_normal().generic_string();
+    }
+
+#ifndef __linux__
+    std::map<std::string, long long> scanDirectory(const std::string &directory) {
+        std::map<std::string, long long> files;
+        std::error_code error;
+
+        for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+            auto time = entry.last_write_time(error);
+            if (!error && entry.is_regular_file(error)) {
+                files[entry.path().filename().string()] = time.time_since_epoch().count();
+            }
+        }
+
+        return files;
+    }
+#endif
+}
+
+io::FileWatcher::FileWatcher(Callback callback) : callback(std::move(callback)) {
+#ifdef __linux__
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (descriptor < 0) {
+        std::cerr << "Can't initialize inotify, file watching is disabled.\n";
+        return;
+    }
+#endif
+
+    thread = std::thread(&FileWatcher::run, this);
+}
+
+io::FileWatcher::~FileWatcher() {
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+#ifdef __linux__
+    if (descriptor >= 0) {
+        close(descriptor);
+    }
+#endif
+}
+
+void io::FileWatcher::watchDirectory(const std::string &directory) {
+    std::string normalized = std::filesystem::path(directory).lexically_normal().generic_string();
+    std::lock_guard<std::mutex> lock(mutex);
+
+#ifdef __linux__
+    if (descriptor < 0) {
+        return;
+    }
+
+    int watch = inotify_add_watch(descriptor, normalized.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch < 0) {
+        std::cerr << "Can't watch directory '" << normalized << "'.\n";
+        return;
+    }
+    directories[watch] = normalized;
+#else
+    directories[normalized] = scanDirectory(normalized);
+#endif
+}
+
+void io::FileWatcher::run() {
+    while (!stopping) {
+        std::vector<std::string> changed;
+
+#ifdef __linux__
+        pollfd request = {descriptor, POLLIN, 0};
+        if (poll(&request, 1, PollIntervalMs) <= 0) {
+            continue;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t length = read(descriptor, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (char *position = buffer; position < buffer + length;) {
+                auto event = reinterpret_cast<inotify_event *>(position);
+                auto directory = directories.find(event->wd);
+                if (directory != directories.end() && event->len != 0) {
+                    changed.push_back(joinPath(directory->second, event->name));
+                }
+                position += sizeof(inotify_event) + event->len;
+            }
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(PollIntervalMs));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &directory : directories) {
+                auto files = scanDirectory(directory.first);
+                for (const auto &file : files) {
+                    auto previous = directory.second.find(file.first);
+                    if (previous == directory.second.end() || previous->second != file.second) {
+                        changed.push_back(joinPath(directory.first, file.first));
+                    }
+                }
+                directory.second = std::move(files);
+            }
+        }
+#endif
+
+        if (changed.empty()) {
+            continue;
+        }
+
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        callback(changed);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace io {
+    // Watches directories on a background thread and reports files that were
+    // written, created or moved into them. Linux uses inotify; other platforms
+    // poll modification times. Directories are watched rather than files so
+    // editors that save through a rename are still seen. The callback runs on
+    // the watcher thread with the changed paths of one batch, deduplicated.
+    class FileWatcher {
+    public:
+        using Callback = std::function<void(const std::vector<std::string> &paths)>;
+
+        explicit FileWatcher(Callback callback);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        void watchDirectory(const std::string &directory);
+
+    private:
+        void run();
+
+        Callback callback;
+        std::atomic<bool> stopping{false};
+        std::mutex mutex;
+        std::thread thread;
+
+#ifdef __linux__
+        int descriptor = -1;
+        std::map<int, std::string> directories; // watch descriptor -> directory
+#else
+        std::map<std::string, std::map<std::string, long long>> directories; // directory -> file -> mtime
+#endif
+    };
+}
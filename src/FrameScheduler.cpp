@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "FrameScheduler.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // A long stall (debugger, window drag) must not turn into a burst of updates.
+    const double MaxFrameSeconds = 0.25;
+
+    // Below this the sleep is skipped entirely and the whole wait is spun.
+    const timing::Nanoseconds MinSleep = std::chrono::microseconds(200);
+
+    const timing::Nanoseconds MaxSlack = std::chrono::milliseconds(4);
+
+    timing::Nanoseconds periodOf(double rate) {
+        if (rate <= 0.0) {
+            return timing::Nanoseconds(0);
+        }
+        return std::chrono::duration_cast<timing::Nanoseconds>(std::chrono::duration<double>(1.0 / rate));
+    }
+}
+
+timing::Nanoseconds timing::SteadyClock::now() {
+    return std::chrono::duration_cast<Nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void timing::SteadyClock::sleepFor(Nanoseconds duration) {
+    std::this_thread::sleep_for(duration);
+}
+
+void timing::SteadyClock::relax() {
+#if defined(__SSE2__) || defined(_M_X64)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+timing::FrameScheduler::FrameScheduler(Clock &clock, SchedulerConfig config)
+        : clock(clock),
+          config(config),
+          fixedStep(config.updateRate > 0.0 ? 1.0 / config.updateRate : 0.0),
+          framePeriod(config.vsync ? Nanoseconds(0) : periodOf(config.targetRate)) {
+    lastFrame = clock.now();
+    nextDeadline = lastFrame + framePeriod;
+}
+
+timing::FrameScheduler::Frame timing::FrameScheduler::beginFrame() {
+    Nanoseconds now = clock.now();
+    double delta = std::min(std::chrono::duration<double>(now - lastFrame).count(), MaxFrameSeconds);
+    lastFrame = now;
+
+    Frame frame = {0, 0.0, true, delta};
+
+    if (fixedStep > 0.0) {
+        accumulator += delta;
+        frame.updates = static_cast<int>(accumulator / fixedStep);
+        if (frame.updates > config.maxUpdatesPerFrame) {
+            frame.updates = config.maxUpdatesPerFrame;
+            accumulator = std::fmod(accumulator, fixedStep);
+        } else {
+            accumulator -= frame.updates * fixedStep;
+        }
+        frame.alpha = accumulator / fixedStep;
+    }
+
+    if (config.powerSaving) {
+        frame.redraw = dirty;
+        dirty = false;
+    }
+
+    return frame;
+}
+
+void timing::FrameScheduler::endFrame() {
+    if (framePeriod.count() == 0) {
+        return;
+    }
+
+    Nanoseconds now = clock.now();
+    // Missed by more than a whole frame: start counting again from here instead
+    // of rushing the following frames to catch up.
+    if (now > nextDeadline + framePeriod) {
+        nextDeadline = now;
+    }
+
+    waitUntil(nextDeadline);
+    nextDeadline += framePeriod;
+}
+
+void timing::FrameScheduler::waitUntil(Nanoseconds deadline) {
+    Nanoseconds remaining = deadline - clock.now();
+    if (remaining.count() <= 0) {
+        return;
+    }
+
+    // Sleep up to the expected oversleep before the deadline, then measure how
+    // far past the requested wake-up the OS actually let us run. The estimate
+    // jumps up to any larger observation and decays slowly otherwise.
+    Nanoseconds sleep = remaining - timerSlack;
+    if (sleep >= MinSleep) {
+        Nanoseconds before = clock.now();
+        clock.sleepFor(sleep);
+        Nanoseconds overslept = clock.now() - before - sleep;
+
+        if (overslept > timerSlack) {
+            timerSlack = std::min(overslept, MaxSlack);
+        } else {
+            timerSlack -= (timerSlack - std::max(overslept, Nanoseconds(0))) / 16;
+        }
+    }
+
+    while (clock.now() < deadline) {
+        clock.relax();
+    }
+}
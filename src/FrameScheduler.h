@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+
+namespace timing {
+    using Nanoseconds = std::chrono::nanoseconds;
+
+    // Time source used by the scheduler; tests inject a fake one.
+    class Clock {
+    public:
+        virtual ~Clock() = default;
+
+        virtual Nanoseconds now() = 0;
+        virtual void sleepFor(Nanoseconds duration) = 0;
+        // One step of a busy wait.
+        virtual void relax() = 0;
+    };
+
+    class SteadyClock : public Clock {
+    public:
+        Nanoseconds now() override;
+        void sleepFor(Nanoseconds duration) override;
+        void relax() override;
+    };
+
+    struct SchedulerConfig {
+        double targetRate = 60.0;        // frames per second; 0 leaves the rate uncapped
+        bool vsync = false;              // swap blocks on the display, so never wait ourselves
+        double updateRate = 60.0;        // fixed simulation steps per second
+        int maxUpdatesPerFrame = 8;      // simulation time beyond this is dropped
+        bool powerSaving = false;        // only redraw after invalidate()
+        Nanoseconds idleTimeout = std::chrono::milliseconds(100);
+    };
+
+    // Paces the main loop. beginFrame() runs the fixed-timestep accumulator and
+    // returns how many simulation steps to take and the interpolation factor for
+    // rendering between the last two states. endFrame() waits for the next frame
+    // deadline by sleeping for most of the remaining time and spinning for the
+    // rest; the spin margin follows the measured oversleep of the OS timer.
+    class FrameScheduler {
+    public:
+        struct Frame {
+            int updates;        // fixed steps to simulate before rendering
+            double alpha;       // [0, 1) blend between previous and current state
+            bool redraw;        // false in power-saving mode when nothing changed
+            double deltaSeconds;
+        };
+
+        FrameScheduler(Clock &clock, SchedulerConfig config);
+
+        Frame beginFrame();
+        void endFrame();
+
+        // Marks the scene as changed: input arrived, a resource was swapped, the
+        // simulation moved something. Only matters in power-saving mode.
+        void invalidate() { dirty = true; }
+
+        double getFixedStep() const { return fixedStep; }
+        Nanoseconds getTimerSlack() const { return timerSlack; }
+        const SchedulerConfig &getConfig() const { return config; }
+
+    private:
+        void waitUntil(Nanoseconds deadline);
+
+        Clock &clock;
+        SchedulerConfig config;
+        double fixedStep;
+        Nanoseconds framePeriod;
+
+        Nanoseconds lastFrame;
+        Nanoseconds nextDeadline;
+        double accumulator = 0.0;
+        bool dirty = true;
+
+        Nanoseconds timerSlack = std::chrono::milliseconds(1);
+    };
+}
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "GeometryArena.h"
+#include "Hash.h"
+#include "Profiler.h"
+
+render::GeometryArena::GeometryArena(GlDispatch &gl, GLsizei vertexStride, std::vector<VertexAttribute> attributes,
+                                     size_t vertexCapacity, size_t indexCapacity)
+        : gl(gl),
+          vertexStride(vertexStride),
+          attributes(std::move(attributes)) {
+    vertices.target = GL_ARRAY_BUFFER;
+    vertices.elementSize = static_cast<size_t>(vertexStride);
+    vertices.allocator = RangeAllocator(vertexCapacity);
+
+    indices.target = GL_ELEMENT_ARRAY_BUFFER;
+    indices.elementSize = sizeof(GLuint);
+    indices.allocator = RangeAllocator(indexCapacity);
+
+    // Uploads go through the copy targets so they never touch whatever VAO is bound.
+    for (Pool *pool : {&vertices, &indices}) {
+        gl.genBuffers(1, &pool->buffer);
+        gl.bindBuffer(GL_COPY_WRITE_BUFFER, pool->buffer);
+        gl.bufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(pool->allocator.getCapacity() * pool->elementSize),
+                      nullptr, GL_STATIC_DRAW);
+    }
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    gl.genVertexArrays(1, &vao);
+    bindVertexArray();
+}
+
+render::GeometryArena::~GeometryArena() {
+    gl.deleteVertexArrays(1, &vao);
+    gl.deleteBuffers(1, &vertices.buffer);
+    gl.deleteBuffers(1, &indices.buffer);
+}
+
+render::MeshId render::GeometryArena::addMesh(const void *vertexData, size_t vertexCount, const GLuint *indexData,
+                                              size_t indexCount) {
+    PROFILE_SCOPE("GeometryArena::addMesh");
+    if (vertexCount == 0 || indexCount == 0) {
+        throw std::invalid_argument("Can't add an empty mesh to geometry arena");
+    }
+
+    Mesh mesh = {acquire(vertices, vertexData, vertexCount), acquire(indices, indexData, indexCount), true};
+
+    if (!freeMeshes.empty()) {
+        MeshId id = freeMeshes.back();
+        freeMeshes.pop_back();
+        meshes[id] = mesh;
+        return id;
+    }
+
+    meshes.push_back(mesh);
+    return static_cast<MeshId>(meshes.size() - 1);
+}
+
+void render::GeometryArena::removeMesh(MeshId id) {
+    Mesh &mesh = meshes.at(id);
+    if (!mesh.alive) {
+        return;
+    }
+
+    release(vertices, mesh.vertexBlock);
+    release(indices, mesh.indexBlock);
+    mesh.alive = false;
+    freeMeshes.push_back(id);
+}
+
+render::MeshRange render::GeometryArena::getMesh(MeshId id) const {
+    const Mesh &mesh = meshes.at(id);
+    const Block &vertexBlock = vertices.blocks[mesh.vertexBlock];
+    const Block &indexBlock = indices.blocks[mesh.indexBlock];
+
+    return {static_cast<GLint>(vertexBlock.offset),
+            static_cast<GLsizei>(indexBlock.offset),
+            static_cast<GLsizei>(indexBlock.size)};
+}
+
+void render::GeometryArena::compact() {
+    PROFILE_SCOPE("GeometryArena::compact");
+    for (Pool *pool : {&vertices, &indices}) {
+        if (pool->allocator.getFragmentation() > 0.f) {
+            relocate(*pool, pool->allocator.getCapacity(), true);
+        }
+    }
+}
+
+render::GeometryArena::Stats render::GeometryArena::getStats() const {
+    Stats stats;
+    stats.meshes = meshes.size() - freeMeshes.size();
+    stats.vertexBytesUsed = vertices.allocator.getUsed() * vertices.elementSize;
+    stats.vertexBytesCapacity = vertices.allocator.getCapacity() * vertices.elementSize;
+    stats.indexBytesUsed = indices.allocator.getUsed() * indices.elementSize;
+    stats.indexBytesCapacity = indices.allocator.getCapacity() * indices.elementSize;
+    stats.vertexFragmentation = vertices.allocator.getFragmentation();
+    stats.indexFragmentation = indices.allocator.getFragmentation();
+    stats.dedupHits = dedupHits;
+    stats.bytesUploaded = bytesUploaded;
+    stats.reallocations = reallocations;
+
+    return stats;
+}
+
+uint32_t render::GeometryArena::acquire(Pool &pool, const void *data, size_t count) {
+    size_t bytes = count * pool.elementSize;
+    uint64_t hash = hashing::fnv1a(data, bytes, hashing::fnv1a(&bytes, sizeof(bytes)));
+
+    // The hash only finds the candidate; sharing it takes the same bytes. A
+    // colliding mesh gets a block of its own that isn't entered in byHash.
+    auto existing = pool.byHash.find(hash);
+    if (existing != pool.byHash.end() && pool.blocks[existing->second].size == count &&
+        std::memcmp(pool.blocks[existing->second].data.data(), data, bytes) == 0) {
+        ++pool.blocks[existing->second].references;
+        ++dedupHits;
+        return existing->second;
+    }
+
+    size_t offset = pool.allocator.allocate(count);
+    if (offset == RangeAllocator::InvalidOffset) {
+        size_t capacity = pool.allocator.getCapacity();
+        relocate(pool, std::max(capacity * 2, capacity + count), false);
+        offset = pool.allocator.allocate(count);
+    }
+
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, pool.buffer);
+    gl.bufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset * pool.elementSize),
+                     static_cast<GLsizeiptr>(bytes), data);
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    bytesUploaded += bytes;
+
+    auto bytePointer = static_cast<const uint8_t *>(data);
+    Block block = {offset, count, hash, 1, std::vector<uint8_t>(bytePointer, bytePointer + bytes)};
+    uint32_t slot;
+    if (!pool.freeSlots.empty()) {
+        slot = pool.freeSlots.back();
+        pool.freeSlots.pop_back();
+        pool.blocks[slot] = std::move(block);
+    } else {
+        slot = static_cast<uint32_t>(pool.blocks.size());
+        pool.blocks.push_back(std::move(block));
+    }
+
+    pool.byHash.emplace(hash, slot);
+    return slot;
+}
+
+void render::GeometryArena::release(Pool &pool, uint32_t slot) {
+    Block &block = pool.blocks[slot];
+    if (--block.references != 0) {
+        return;
+    }
+
+    pool.allocator.free(block.offset, block.size);
+    std::vector<uint8_t>().swap(block.data);
+
+    auto entry = pool.byHash.find(block.hash);
+    if (entry != pool.byHash.end() && entry->second == slot) {
+        pool.byHash.erase(entry);
+    }
+    pool.freeSlots.push_back(slot);
+}
+
+void render::GeometryArena::relocate(Pool &pool, size_t newCapacity, bool pack) {
+    GLuint buffer;
+    gl.genBuffers(1, &buffer);
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    gl.bufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity * pool.elementSize), nullptr,
+                  GL_STATIC_DRAW);
+    gl.bindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+
+    if (pack) {
+        std::vector<Block *> live;
+        for (auto &block : pool.blocks) {
+            if (block.references != 0) {
+                live.push_back(&block);
+            }
+        }
+        std::sort(live.begin(), live.end(), [](const Block *a, const Block *b) { return a->offset < b->offset; });
+
+        size_t offset = 0;
+        for (Block *block : live) {
+            gl.copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                 static_cast<GLintptr>(block->offset * pool.elementSize),
+                                 static_cast<GLintptr>(offset * pool.elementSize),
+                                 static_cast<GLsizeiptr>(block->size * pool.elementSize));
+            block->offset = offset;
+            offset += block->size;
+        }
+
+        pool.allocator.reset(offset, newCapacity);
+    } else {
+        gl.copyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                             static_cast<GLsizeiptr>(pool.allocator.getCapacity() * pool.elementSize));
+        pool.allocator.grow(newCapacity);
+    }
+
+    gl.bindBuffer(GL_COPY_READ_BUFFER, 0);
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    gl.deleteBuffers(1, &pool.buffer);
+    pool.buffer = buffer;
+    ++reallocations;
+
+    bindVertexArray();
+}
+
+void render::GeometryArena::bindVertexArray() {
+    gl.bindVertexArray(vao);
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+    for (const auto &attribute : attributes) {
+        gl.vertexAttribPointer(attribute.index, attribute.components, attribute.type, attribute.normalized,
+                               vertexStride, reinterpret_cast<const void *>(attribute.offset));
+        gl.enableVertexAttribArray(attribute.index);
+    }
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
+
+    gl.bindVertexArray(0);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
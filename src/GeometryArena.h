@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "GlDispatch.h"
+#include "RangeAllocator.h"
+
+namespace render {
+    struct VertexAttribute {
+        GLuint index;
+        GLint components;
+        GLenum type;
+        GLboolean normalized;
+        size_t offset;
+    };
+
+    // Where a mesh lives inside the arena buffers; feed straight into
+    // glDrawElementsBaseVertex-style calls.
+    struct MeshRange {
+        GLint baseVertex;
+        GLsizei firstIndex;
+        GLsizei indexCount;
+    };
+
+    using MeshId = uint32_t;
+
+    // Suballocates the vertex and index data of all static meshes sharing one
+    // vertex format out of a single VBO/EBO pair and one VAO. Vertex and index
+    // blocks are deduplicated by content and reference counted, so meshes with
+    // identical index lists share one index range; each block keeps a CPU copy
+    // of its data so a hash match is confirmed byte for byte. Growing or compacting the
+    // arena replaces the GL buffers and rebinds the VAO; anything caching bound
+    // state (e.g. RenderQueue) must be invalidated afterwards.
+    class GeometryArena {
+    public:
+        struct Stats {
+            size_t meshes = 0;
+            size_t vertexBytesUsed = 0;
+            size_t vertexBytesCapacity = 0;
+            size_t indexBytesUsed = 0;
+            size_t indexBytesCapacity = 0;
+            float vertexFragmentation = 0.f;
+            float indexFragmentation = 0.f;
+            size_t dedupHits = 0;
+            size_t bytesUploaded = 0;
+            size_t reallocations = 0;
+        };
+
+        GeometryArena(GlDispatch &gl, GLsizei vertexStride, std::vector<VertexAttribute> attributes,
+                      size_t vertexCapacity = 1 << 16, size_t indexCapacity = 1 << 16);
+        ~GeometryArena();
+
+        GeometryArena(const GeometryArena &) = delete;
+        GeometryArena &operator=(const GeometryArena &) = delete;
+
+        MeshId addMesh(const void *vertices, size_t vertexCount, const GLuint *indices, size_t indexCount);
+        void removeMesh(MeshId mesh);
+        MeshRange getMesh(MeshId mesh) const;
+
+        // Packs live blocks to the front of fresh buffers of the same capacity.
+        void compact();
+
+        GLuint getVertexArray() const { return vao; }
+        Stats getStats() const;
+
+    private:
+        struct Block {
+            size_t offset;
+            size_t size;
+            uint64_t hash;
+            uint32_t references;
+            std::vector<uint8_t> data; // what was uploaded, to confirm dedup matches
+        };
+
+        struct Pool {
+            GLenum target;
+            size_t elementSize;
+            GLuint buffer = 0;
+            RangeAllocator allocator;
+            std::vector<Block> blocks;
+            std::vector<uint32_t> freeSlots;
+            std::unordered_map<uint64_t, uint32_t> byHash;
+        };
+
+        struct Mesh {
+            uint32_t vertexBlock;
+            uint32_t indexBlock;
+            bool alive;
+        };
+
+        uint32_t acquire(Pool &pool, const void *data, size_t count);
+        void release(Pool &pool, uint32_t block);
+        void relocate(Pool &pool, size_t newCapacity, bool pack);
+        void bindVertexArray();
+
+        GlDispatch &gl;
+        GLsizei vertexStride;
+        std::vector<VertexAttribute> attributes;
+        GLuint vao = 0;
+
+        Pool vertices;
+        Pool indices;
+        std::vector<Mesh> meshes;
+        std::vector<MeshId> freeMeshes;
+
+        size_t dedupHits = 0;
+        size_t bytesUploaded = 0;
+        size_t reallocations = 0;
+    };
+}
@@ -0,0 +1,281 @@
+#include "GlDispatch.h"
+
+void render::NativeGlDispatch::useProgram(GLuint program) {
+    glUseProgram(program);
+}
+
+void render::NativeGlDispatch::bindVertexArray(GLuint vao) {
+    glBindVertexArray(vao);
+}
+
+void render::NativeGlDispatch::uniform1f(GLint location, GLfloat x) {
+    glUniform1f(location, x);
+}
+
+void render::NativeGlDispatch::uniform2f(GLint location, GLfloat x, GLfloat y) {
+    glUniform2f(location, x, y);
+}
+
+void render::NativeGlDispatch::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    glUniform4f(location, x, y, z, w);
+}
+
+void render::NativeGlDispatch::drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+    glDrawElements(mode, count, type, indices);
+}
+
+void render::NativeGlDispatch::drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                     GLsizei instanceCount) {
+    glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+void render::NativeGlDispatch::multiDrawElements(GLenum mode, const GLsizei *counts, GLenum type,
+                                                 const void *const *indices, GLsizei drawCount) {
+    glMultiDrawElements(mode, counts, type, const_cast<const GLvoid **>(indices), drawCount);
+}
+
+void render::NativeGlDispatch::drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                      GLint baseVertex) {
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+void render::NativeGlDispatch::drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                               const void *indices, GLsizei instanceCount,
+                                                               GLint baseVertex) {
+    glDrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, baseVertex);
+}
+
+void render::NativeGlDispatch::multiDrawElementsBaseVertex(GLenum mode, const GLsizei *counts, GLenum type,
+                                                           const void *const *indices, GLsizei drawCount,
+                                                           const GLint *baseVertices) {
+    glMultiDrawElementsBaseVertex(mode, counts, type, indices, drawCount, baseVertices);
+}
+
+void render::NativeGlDispatch::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) {
+    glDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+void render::NativeGlDispatch::enable(GLenum capability) {
+    glEnable(capability);
+}
+
+void render::NativeGlDispatch::disable(GLenum capability) {
+    glDisable(capability);
+}
+
+void render::NativeGlDispatch::blendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    glBlendFunc(sourceFactor, destinationFactor);
+}
+
+void render::NativeGlDispatch::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    glViewport(x, y, width, height);
+}
+
+void render::NativeGlDispatch::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    glClearColor(red, green, blue, alpha);
+}
+
+void render::NativeGlDispatch::clear(GLbitfield mask) {
+    glClear(mask);
+}
+
+void render::NativeGlDispatch::genBuffers(GLsizei count, GLuint *buffers) {
+    glGenBuffers(count, buffers);
+}
+
+void render::NativeGlDispatch::deleteBuffers(GLsizei count, const GLuint *buffers) {
+    glDeleteBuffers(count, buffers);
+}
+
+void render::NativeGlDispatch::bindBuffer(GLenum target, GLuint buffer) {
+    glBindBuffer(target, buffer);
+}
+
+void render::NativeGlDispatch::bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+}
+
+void render::NativeGlDispatch::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    glBufferSubData(target, offset, size, data);
+}
+
+void render::NativeGlDispatch::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                                                 GLintptr writeOffset, GLsizeiptr size) {
+    glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
+void render::NativeGlDispatch::genVertexArrays(GLsizei count, GLuint *arrays) {
+    glGenVertexArrays(count, arrays);
+}
+
+void render::NativeGlDispatch::deleteVertexArrays(GLsizei count, const GLuint *arrays) {
+    glDeleteVertexArrays(count, arrays);
+}
+
+void render::NativeGlDispatch::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                                   GLsizei stride, const void *pointer) {
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void render::NativeGlDispatch::enableVertexAttribArray(GLuint index) {
+    glEnableVertexAttribArray(index);
+}
+
+void render::NativeGlDispatch::vertexAttribDivisor(GLuint index, GLuint divisor) {
+    glVertexAttribDivisor(index, divisor);
+}
+
+GLuint render::NativeGlDispatch::createShader(GLenum stage) {
+    return glCreateShader(stage);
+}
+
+void render::NativeGlDispatch::shaderSource(GLuint shader, GLsizei count, const GLchar *const *strings,
+                                            const GLint *lengths) {
+    glShaderSource(shader, count, const_cast<const GLchar **>(strings), lengths);
+}
+
+void render::NativeGlDispatch::compileShader(GLuint shader) {
+    glCompileShader(shader);
+}
+
+void render::NativeGlDispatch::getShaderiv(GLuint shader, GLenum name, GLint *value) {
+    glGetShaderiv(shader, name, value);
+}
+
+void render::NativeGlDispatch::getShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log) {
+    glGetShaderInfoLog(shader, size, length, log);
+}
+
+void render::NativeGlDispatch::deleteShader(GLuint shader) {
+    glDeleteShader(shader);
+}
+
+GLuint render::NativeGlDispatch::createProgram() {
+    return glCreateProgram();
+}
+
+void render::NativeGlDispatch::attachShader(GLuint program, GLuint shader) {
+    glAttachShader(program, shader);
+}
+
+void render::NativeGlDispatch::detachShader(GLuint program, GLuint shader) {
+    glDetachShader(program, shader);
+}
+
+void render::NativeGlDispatch::linkProgram(GLuint program) {
+    glLinkProgram(program);
+}
+
+void render::NativeGlDispatch::getProgramiv(GLuint program, GLenum name, GLint *value) {
+    glGetProgramiv(program, name, value);
+}
+
+void render::NativeGlDispatch::getProgramInfoLog(GLuint program, GLsizei size, GLsizei *length, GLchar *log) {
+    glGetProgramInfoLog(program, size, length, log);
+}
+
+void render::NativeGlDispatch::deleteProgram(GLuint program) {
+    glDeleteProgram(program);
+}
+
+void render::NativeGlDispatch::programParameteri(GLuint program, GLenum name, GLint value) {
+    glProgramParameteri(program, name, value);
+}
+
+void render::NativeGlDispatch::getProgramBinary(GLuint program, GLsizei size, GLsizei *length, GLenum *format,
+                                                void *binary) {
+    glGetProgramBinary(program, size, length, format, binary);
+}
+
+void render::NativeGlDispatch::programBinary(GLuint program, GLenum format, const void *binary, GLsizei length) {
+    glProgramBinary(program, format, binary, length);
+}
+
+GLint render::NativeGlDispatch::getUniformLocation(GLuint program, const GLchar *name) {
+    return glGetUniformLocation(program, name);
+}
+
+void render::NativeGlDispatch::genTextures(GLsizei count, GLuint *textures) {
+    glGenTextures(count, textures);
+}
+
+void render::NativeGlDispatch::deleteTextures(GLsizei count, const GLuint *textures) {
+    glDeleteTextures(count, textures);
+}
+
+void render::NativeGlDispatch::bindTexture(GLenum target, GLuint texture) {
+    glBindTexture(target, texture);
+}
+
+void render::NativeGlDispatch::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width,
+                                          GLsizei height, GLint border, GLenum format, GLenum type,
+                                          const void *pixels) {
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void render::NativeGlDispatch::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                             GLsizei height, GLenum format, GLenum type, const void *pixels) {
+    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+}
+
+void render::NativeGlDispatch::compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width,
+                                                    GLsizei height, GLint border, GLsizei size, const void *data) {
+    glCompressedTexImage2D(target, level, internalFormat, width, height, border, size, data);
+}
+
+void render::NativeGlDispatch::compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                                       GLsizei height, GLenum format, GLsizei size,
+                                                       const void *data) {
+    glCompressedTexSubImage2D(target, level, x, y, width, height, format, size, data);
+}
+
+void render::NativeGlDispatch::texParameteri(GLenum target, GLenum name, GLint value) {
+    glTexParameteri(target, name, value);
+}
+
+void render::NativeGlDispatch::pixelStorei(GLenum name, GLint value) {
+    glPixelStorei(name, value);
+}
+
+void render::NativeGlDispatch::genQueries(GLsizei count, GLuint *queries) {
+    glGenQueries(count, queries);
+}
+
+void render::NativeGlDispatch::deleteQueries(GLsizei count, const GLuint *queries) {
+    glDeleteQueries(count, queries);
+}
+
+void render::NativeGlDispatch::beginQuery(GLenum target, GLuint query) {
+    glBeginQuery(target, query);
+}
+
+void render::NativeGlDispatch::endQuery(GLenum target) {
+    glEndQuery(target);
+}
+
+void render::NativeGlDispatch::getQueryObjectiv(GLuint query, GLenum name, GLint *value) {
+    glGetQueryObjectiv(query, name, value);
+}
+
+void render::NativeGlDispatch::getQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value) {
+    glGetQueryObjectui64v(query, name, value);
+}
+
+void render::NativeGlDispatch::getIntegerv(GLenum name, GLint *value) {
+#ifndef __APPLE__
+    if (name == GL_NUM_PROGRAM_BINARY_FORMATS &&
+        (glGetProgramBinary == nullptr || glProgramBinary == nullptr || glProgramParameteri == nullptr)) {
+        *value = 0;
+        return;
+    }
+#endif
+    glGetIntegerv(name, value);
+}
+
+const GLubyte *render::NativeGlDispatch::getString(GLenum name) {
+    return glGetString(name);
+}
+
+const GLubyte *render::NativeGlDispatch::getStringi(GLenum name, GLuint index) {
+    return glGetStringi(name, index);
+}
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <glwrapper.h>
+
+namespace render {
+    // Indirection over every GL entry point the renderer calls, so submission,
+    // resource setup and shader loading can run against something other than a
+    // live context. Only GlDispatch.cpp calls GL directly.
+    class GlDispatch {
+    public:
+        virtual ~GlDispatch() = default;
+
+        virtual void useProgram(GLuint program) = 0;
+        virtual void bindVertexArray(GLuint vao) = 0;
+        virtual void uniform1f(GLint location, GLfloat x) = 0;
+        virtual void uniform2f(GLint location, GLfloat x, GLfloat y) = 0;
+        virtual void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) = 0;
+        virtual void drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) = 0;
+        virtual void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                           GLsizei instanceCount) = 0;
+        virtual void multiDrawElements(GLenum mode, const GLsizei *counts, GLenum type, const void *const *indices,
+                                       GLsizei drawCount) = 0;
+        virtual void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                            GLint baseVertex) = 0;
+        virtual void drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                     GLsizei instanceCount, GLint baseVertex) = 0;
+        virtual void multiDrawElementsBaseVertex(GLenum mode, const GLsizei *counts, GLenum type,
+                                                 const void *const *indices, GLsizei drawCount,
+                                                 const GLint *baseVertices) = 0;
+        virtual void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) = 0;
+        virtual void enable(GLenum capability) = 0;
+        virtual void disable(GLenum capability) = 0;
+        virtual void blendFunc(GLenum sourceFactor, GLenum destinationFactor) = 0;
+        virtual void viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+        virtual void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) = 0;
+        virtual void clear(GLbitfield mask) = 0;
+
+        virtual void genBuffers(GLsizei count, GLuint *buffers) = 0;
+        virtual void deleteBuffers(GLsizei count, const GLuint *buffers) = 0;
+        virtual void bindBuffer(GLenum target, GLuint buffer) = 0;
+        virtual void bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) = 0;
+        virtual void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) = 0;
+        virtual void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                                       GLintptr writeOffset, GLsizeiptr size) = 0;
+        virtual void genVertexArrays(GLsizei count, GLuint *arrays) = 0;
+        virtual void deleteVertexArrays(GLsizei count, const GLuint *arrays) = 0;
+        virtual void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                         GLsizei stride, const void *pointer) = 0;
+        virtual void enableVertexAttribArray(GLuint index) = 0;
+        virtual void vertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+        virtual GLuint createShader(GLenum stage) = 0;
+        virtual void shaderSource(GLuint shader, GLsizei count, const GLchar *const *strings,
+                                  const GLint *lengths) = 0;
+        virtual void compileShader(GLuint shader) = 0;
+        virtual void getShaderiv(GLuint shader, GLenum name, GLint *value) = 0;
+        virtual void getShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log) = 0;
+        virtual void deleteShader(GLuint shader) = 0;
+        virtual GLuint createProgram() = 0;
+        virtual void attachShader(GLuint program, GLuint shader) = 0;
+        virtual void detachShader(GLuint program, GLuint shader) = 0;
+        virtual void linkProgram(GLuint program) = 0;
+        virtual void getProgramiv(GLuint program, GLenum name, GLint *value) = 0;
+        virtual void getProgramInfoLog(GLuint program, GLsizei size, GLsizei *length, GLchar *log) = 0;
+        virtual void deleteProgram(GLuint program) = 0;
+        virtual void programParameteri(GLuint program, GLenum name, GLint value) = 0;
+        virtual void getProgramBinary(GLuint program, GLsizei size, GLsizei *length, GLenum *format,
+                                      void *binary) = 0;
+        virtual void programBinary(GLuint program, GLenum format, const void *binary, GLsizei length) = 0;
+        virtual GLint getUniformLocation(GLuint program, const GLchar *name) = 0;
+
+        virtual void genTextures(GLsizei count, GLuint *textures) = 0;
+        virtual void deleteTextures(GLsizei count, const GLuint *textures) = 0;
+        virtual void bindTexture(GLenum target, GLuint texture) = 0;
+        virtual void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                GLint border, GLenum format, GLenum type, const void *pixels) = 0;
+        virtual void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                   GLenum format, GLenum type, const void *pixels) = 0;
+        virtual void compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width,
+                                          GLsizei height, GLint border, GLsizei size, const void *data) = 0;
+        virtual void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                             GLsizei height, GLenum format, GLsizei size, const void *data) = 0;
+        virtual void texParameteri(GLenum target, GLenum name, GLint value) = 0;
+        virtual void pixelStorei(GLenum name, GLint value) = 0;
+
+        virtual void genQueries(GLsizei count, GLuint *queries) = 0;
+        virtual void deleteQueries(GLsizei count, const GLuint *queries) = 0;
+        virtual void beginQuery(GLenum target, GLuint query) = 0;
+        virtual void endQuery(GLenum target) = 0;
+        virtual void getQueryObjectiv(GLuint query, GLenum name, GLint *value) = 0;
+        virtual void getQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value) = 0;
+
+        virtual void getIntegerv(GLenum name, GLint *value) = 0;
+        virtual const GLubyte *getString(GLenum name) = 0;
+        virtual const GLubyte *getStringi(GLenum name, GLuint index) = 0;
+    };
+
+    // Forwards every call to the current GL context.
+    class NativeGlDispatch : public GlDispatch {
+    public:
+        void useProgram(GLuint program) override;
+        void bindVertexArray(GLuint vao) override;
+        void uniform1f(GLint location, GLfloat x) override;
+        void uniform2f(GLint location, GLfloat x, GLfloat y) override;
+        void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override;
+        void drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) override;
+        void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                   GLsizei instanceCount) override;
+        void multiDrawElements(GLenum mode, const GLsizei *counts, GLenum type, const void *const *indices,
+                               GLsizei drawCount) override;
+        void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                    GLint baseVertex) override;
+        void drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                             GLsizei instanceCount, GLint baseVertex) override;
+        void multiDrawElementsBaseVertex(GLenum mode, const GLsizei *counts, GLenum type, const void *const *indices,
+                                         GLsizei drawCount, const GLint *baseVertices) override;
+        void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) override;
+        void enable(GLenum capability) override;
+        void disable(GLenum capability) override;
+        void blendFunc(GLenum sourceFactor, GLenum destinationFactor) override;
+        void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+        void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) override;
+        void clear(GLbitfield mask) override;
+
+        void genBuffers(GLsizei count, GLuint *buffers) override;
+        void deleteBuffers(GLsizei count, const GLuint *buffers) override;
+        void bindBuffer(GLenum target, GLuint buffer) override;
+        void bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) override;
+        void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) override;
+        void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+                               GLsizeiptr size) override;
+        void genVertexArrays(GLsizei count, GLuint *arrays) override;
+        void deleteVertexArrays(GLsizei count, const GLuint *arrays) override;
+        void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                                 const void *pointer) override;
+        void enableVertexAttribArray(GLuint index) override;
+        void vertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+        GLuint createShader(GLenum stage) override;
+        void shaderSource(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths) override;
+        void compileShader(GLuint shader) override;
+        void getShaderiv(GLuint shader, GLenum name, GLint *value) override;
+        void getShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log) override;
+        void deleteShader(GLuint shader) override;
+        GLuint createProgram() override;
+        void attachShader(GLuint program, GLuint shader) override;
+        void detachShader(GLuint program, GLuint shader) override;
+        void linkProgram(GLuint program) override;
+        void getProgramiv(GLuint program, GLenum name, GLint *value) override;
+        void getProgramInfoLog(GLuint program, GLsizei size, GLsizei *length, GLchar *log) override;
+        void deleteProgram(GLuint program) override;
+        void programParameteri(GLuint program, GLenum name, GLint value) override;
+        void getProgramBinary(GLuint program, GLsizei size, GLsizei *length, GLenum *format, void *binary) override;
+        void programBinary(GLuint program, GLenum format, const void *binary, GLsizei length) override;
+        GLint getUniformLocation(GLuint program, const GLchar *name) override;
+
+        void genTextures(GLsizei count, GLuint *textures) override;
+        void deleteTextures(GLsizei count, const GLuint *textures) override;
+        void bindTexture(GLenum target, GLuint texture) override;
+        void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                        GLenum format, GLenum type, const void *pixels) override;
+        void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
+                           GLenum type, const void *pixels) override;
+        void compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                  GLint border, GLsizei size, const void *data) override;
+        void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                     GLenum format, GLsizei size, const void *data) override;
+        void texParameteri(GLenum target, GLenum name, GLint value) override;
+        void pixelStorei(GLenum name, GLint value) override;
+
+        void genQueries(GLsizei count, GLuint *queries) override;
+        void deleteQueries(GLsizei count, const GLuint *queries) override;
+        void beginQuery(GLenum target, GLuint query) override;
+        void endQuery(GLenum target) override;
+        void getQueryObjectiv(GLuint query, GLenum name, GLint *value) override;
+        void getQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value) override;
+
+        // Reports no program binary formats when the driver lacks the
+        // glGetProgramBinary entry points, so callers never reach them.
+        void getIntegerv(GLenum name, GLint *value) override;
+        const GLubyte *getString(GLenum name) override;
+        const GLubyte *getStringi(GLenum name, GLuint index) override;
+    };
+
+    // Drops every call and only counts it; lets benchmarks measure the submitted
+    // call stream without a GPU.
+    class CountingGlDispatch : public GlDispatch {
+    public:
+        struct Counters {
+            size_t programBinds = 0;
+            size_t vertexArrayBinds = 0;
+            size_t uniforms = 0;
+            size_t draws = 0;
+            size_t instancedDraws = 0;
+            size_t multiDraws = 0;
+            size_t bufferCalls = 0;
+            size_t renderStates = 0;
+            size_t clears = 0;
+            size_t shaderCalls = 0;
+            size_t textureCalls = 0;
+            size_t queryCalls = 0;
+            size_t bytesUploaded = 0;
+
+            size_t total() const {
+                return programBinds + vertexArrayBinds + uniforms + draws + instancedDraws + multiDraws + bufferCalls +
+                       renderStates + clears + shaderCalls + textureCalls + queryCalls;
+            }
+        };
+
+        Counters counters;
+
+        void useProgram(GLuint) override { ++counters.programBinds; }
+        void bindVertexArray(GLuint) override { ++counters.vertexArrayBinds; }
+        void uniform1f(GLint, GLfloat) override { ++counters.uniforms; }
+        void uniform2f(GLint, GLfloat, GLfloat) override { ++counters.uniforms; }
+        void uniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) override { ++counters.uniforms; }
+        void drawElements(GLenum, GLsizei, GLenum, const void *) override { ++counters.draws; }
+        void drawElementsInstanced(GLenum, GLsizei, GLenum, const void *, GLsizei) override {
+            ++counters.instancedDraws;
+        }
+        void multiDrawElements(GLenum, const GLsizei *, GLenum, const void *const *, GLsizei) override {
+            ++counters.multiDraws;
+        }
+        void drawElementsBaseVertex(GLenum, GLsizei, GLenum, const void *, GLint) override { ++counters.draws; }
+        void drawElementsInstancedBaseVertex(GLenum, GLsizei, GLenum, const void *, GLsizei, GLint) override {
+            ++counters.instancedDraws;
+        }
+        void multiDrawElementsBaseVertex(GLenum, const GLsizei *, GLenum, const void *const *, GLsizei,
+                                         const GLint *) override {
+            ++counters.multiDraws;
+        }
+        void drawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) override { ++counters.instancedDraws; }
+        void enable(GLenum) override { ++counters.renderStates; }
+        void disable(GLenum) override { ++counters.renderStates; }
+        void blendFunc(GLenum, GLenum) override { ++counters.renderStates; }
+        void viewport(GLint, GLint, GLsizei, GLsizei) override { ++counters.renderStates; }
+        void clearColor(GLfloat, GLfloat, GLfloat, GLfloat) override { ++counters.renderStates; }
+        void clear(GLbitfield) override { ++counters.clears; }
+
+        void genBuffers(GLsizei count, GLuint *buffers) override {
+            for (GLsizei i = 0; i < count; ++i) {
+                buffers[i] = ++lastName;
+            }
+        }
+        void deleteBuffers(GLsizei, const GLuint *) override {}
+        void bindBuffer(GLenum, GLuint) override { ++counters.bufferCalls; }
+        void bufferData(GLenum, GLsizeiptr size, const void *data, GLenum) override {
+            ++counters.bufferCalls;
+            counters.bytesUploaded += data != nullptr ? static_cast<size_t>(size) : 0;
+        }
+        void bufferSubData(GLenum, GLintptr, GLsizeiptr size, const void *) override {
+            ++counters.bufferCalls;
+            counters.bytesUploaded += static_cast<size_t>(size);
+        }
+        void copyBufferSubData(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr) override { ++counters.bufferCalls; }
+        void genVertexArrays(GLsizei count, GLuint *arrays) override {
+            for (GLsizei i = 0; i < count; ++i) {
+                arrays[i] = ++lastName;
+            }
+        }
+        void deleteVertexArrays(GLsizei, const GLuint *) override {}
+        void vertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void *) override {}
+        void enableVertexAttribArray(GLuint) override {}
+        void vertexAttribDivisor(GLuint, GLuint) override {}
+
+        // Every shader compiles and every program links; there are no binary
+        // formats, so ShaderLibrary always takes the compile path.
+        GLuint createShader(GLenum) override {
+            ++counters.shaderCalls;
+            return ++lastName;
+        }
+        void shaderSource(GLuint, GLsizei, const GLchar *const *, const GLint *) override { ++counters.shaderCalls; }
+        void compileShader(GLuint) override { ++counters.shaderCalls; }
+        void getShaderiv(GLuint, GLenum, GLint *value) override { *value = GL_TRUE; }
+        void getShaderInfoLog(GLuint, GLsizei size, GLsizei *length, GLchar *log) override {
+            emptyLog(size, length, log);
+        }
+        void deleteShader(GLuint) override { ++counters.shaderCalls; }
+        GLuint createProgram() override {
+            ++counters.shaderCalls;
+            return ++lastName;
+        }
+        void attachShader(GLuint, GLuint) override { ++counters.shaderCalls; }
+        void detachShader(GLuint, GLuint) override { ++counters.shaderCalls; }
+        void linkProgram(GLuint) override { ++counters.shaderCalls; }
+        void getProgramiv(GLuint, GLenum name, GLint *value) override { *value = name == GL_LINK_STATUS ? GL_TRUE : 0; }
+        void getProgramInfoLog(GLuint, GLsizei size, GLsizei *length, GLchar *log) override {
+            emptyLog(size, length, log);
+        }
+        void deleteProgram(GLuint) override { ++counters.shaderCalls; }
+        void programParameteri(GLuint, GLenum, GLint) override { ++counters.shaderCalls; }
+        void getProgramBinary(GLuint, GLsizei, GLsizei *length, GLenum *format, void *) override {
+            *length = 0;
+            *format = 0;
+        }
+        void programBinary(GLuint, GLenum, const void *, GLsizei) override { ++counters.shaderCalls; }
+        GLint getUniformLocation(GLuint, const GLchar *) override { return 0; }
+
+        void genTextures(GLsizei count, GLuint *textures) override {
+            for (GLsizei i = 0; i < count; ++i) {
+                textures[i] = ++lastName;
+            }
+        }
+        void deleteTextures(GLsizei, const GLuint *) override {}
+        void bindTexture(GLenum, GLuint) override { ++counters.textureCalls; }
+        void texImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *) override {
+            ++counters.textureCalls;
+        }
+        void texSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *) override {
+            ++counters.textureCalls;
+        }
+        void compressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei size,
+                                  const void *data) override {
+            ++counters.textureCalls;
+            counters.bytesUploaded += data != nullptr ? static_cast<size_t>(size) : 0;
+        }
+        void compressedTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei size,
+                                     const void *) override {
+            ++counters.textureCalls;
+            counters.bytesUploaded += static_cast<size_t>(size);
+        }
+        void texParameteri(GLenum, GLenum, GLint) override { ++counters.textureCalls; }
+        void pixelStorei(GLenum, GLint) override { ++counters.textureCalls; }
+
+        void genQueries(GLsizei count, GLuint *queries) override {
+            for (GLsizei i = 0; i < count; ++i) {
+                queries[i] = ++lastName;
+            }
+        }
+        void deleteQueries(GLsizei, const GLuint *) override {}
+        void beginQuery(GLenum, GLuint) override { ++counters.queryCalls; }
+        void endQuery(GLenum) override { ++counters.queryCalls; }
+        void getQueryObjectiv(GLuint, GLenum, GLint *value) override {
+            ++counters.queryCalls;
+            *value = GL_TRUE;
+        }
+        void getQueryObjectui64v(GLuint, GLenum, GLuint64 *value) override {
+            ++counters.queryCalls;
+            *value = 0;
+        }
+
+        void getIntegerv(GLenum, GLint *value) override { *value = 0; }
+        const GLubyte *getString(GLenum) override { return reinterpret_cast<const GLubyte *>(""); }
+        const GLubyte *getStringi(GLenum, GLuint) override { return nullptr; }
+
+    private:
+        static void emptyLog(GLsizei size, GLsizei *length, GLchar *log) {
+            if (length != nullptr) {
+                *length = 0;
+            }
+            if (size > 0) {
+                log[0] = '\0';
+            }
+        }
+
+        GLuint lastName = 0;
+    };
+}
@@ -0,0 +1,54 @@
+#include "GpuTimer.h"
+
+profiling::GpuTimer::~GpuTimer() {
+    for (auto &frame : frames) {
+        for (auto &query : frame.queries) {
+            gl.deleteQueries(1, &query.id);
+        }
+    }
+}
+
+void profiling::GpuTimer::begin(const char *name) {
+    FrameQueries &frame = frames[current];
+    if (frame.used == frame.queries.size()) {
+        GLuint id;
+        gl.genQueries(1, &id);
+        frame.queries.push_back({id, name});
+    }
+
+    Query &query = frame.queries[frame.used++];
+    query.name = name;
+    gl.beginQuery(GL_TIME_ELAPSED, query.id);
+    active = true;
+}
+
+void profiling::GpuTimer::end() {
+    if (active) {
+        gl.endQuery(GL_TIME_ELAPSED);
+        active = false;
+    }
+}
+
+void profiling::GpuTimer::endFrame() {
+    end();
+
+    current ^= 1;
+    FrameQueries &previous = frames[current];
+
+    results.clear();
+    for (size_t i = 0; i < previous.used; ++i) {
+        const Query &query = previous.queries[i];
+
+        GLint available = GL_FALSE;
+        gl.getQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            continue;
+        }
+
+        GLuint64 elapsed = 0;
+        gl.getQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsed);
+        results.push_back({query.name, elapsed / 1e6});
+        PROFILE_COUNTER(query.name, elapsed / 1e6);
+    }
+    previous.used = 0;
+}
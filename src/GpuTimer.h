@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "GlDispatch.h"
+#include "Profiler.h"
+
+namespace profiling {
+    // Measures draw groups with GL_TIME_ELAPSED queries. Queries issued in one
+    // frame are read back at the end of the next, by which time the GPU has
+    // normally finished them; a result that still isn't available is skipped
+    // rather than waited for, so the timer never stalls the pipeline.
+    // GL_TIME_ELAPSED queries can't nest: scopes must not overlap.
+    class GpuTimer {
+    public:
+        struct Result {
+            const char *name;
+            double milliseconds;
+        };
+
+        explicit GpuTimer(render::GlDispatch &gl) : gl(gl) {}
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer &) = delete;
+        GpuTimer &operator=(const GpuTimer &) = delete;
+
+        // name must outlive the timer; use literals.
+        void begin(const char *name);
+        void end();
+
+        // Reads back the frame before this one and flips buffers. Results are
+        // also reported as profiler counters when profiling is enabled.
+        void endFrame();
+
+        // Timings of the last frame that could be read back.
+        const std::vector<Result> &getResults() const { return results; }
+
+    private:
+        struct Query {
+            GLuint id;
+            const char *name;
+        };
+
+        struct FrameQueries {
+            std::vector<Query> queries;
+            size_t used = 0;
+        };
+
+        render::GlDispatch &gl;
+        FrameQueries frames[2];
+        size_t current = 0;
+        bool active = false;
+        std::vector<Result> results;
+    };
+
+    class GpuScope {
+    public:
+        GpuScope(GpuTimer &timer, const char *name) : timer(timer) { timer.begin(name); }
+        ~GpuScope() { timer.end(); }
+
+        GpuScope(const GpuScope &) = delete;
+        GpuScope &operator=(const GpuScope &) = delete;
+
+    private:
+        GpuTimer &timer;
+    };
+}
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_GPU_SCOPE(timer, name) profiling::GpuScope PROFILE_CONCAT(profileGpuScope, __LINE__)(timer, name)
+#define PROFILE_GPU_END_FRAME(timer) (timer).endFrame()
+// For a measured range that begins and ends in different functions.
+#define PROFILE_GPU_BEGIN(timer, name) (timer).begin(name)
+#define PROFILE_GPU_END(timer) (timer).end()
+#else
+#define PROFILE_GPU_SCOPE(timer, name) do {} while (false)
+#define PROFILE_GPU_END_FRAME(timer) do {} while (false)
+#define PROFILE_GPU_BEGIN(timer, name) do {} while (false)
+#define PROFILE_GPU_END(timer) do {} while (false)
+#endif
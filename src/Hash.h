@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hashing {
+    const uint64_t Fnv1aBasis = 14695981039346656037ull;
+
+    // 64-bit FNV-1a; pass the previous result as seed to hash several buffers.
+    inline uint64_t fnv1a(const void *data, size_t size, uint64_t seed = Fnv1aBasis) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        uint64_t hash = seed;
+
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+}
@@ -0,0 +1,92 @@
+#include <fstream>
+#include <utility>
+#include "MappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IO_HAS_MMAP 1
+#endif
+
+io::MappedFile::MappedFile(const std::string &path) {
+#ifdef IO_HAS_MMAP
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0) {
+        ::close(descriptor);
+        return;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    opened = true;
+
+    // mmap of an empty file fails; an open, empty view is still valid.
+    if (length != 0) {
+        void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            opened = false;
+            length = 0;
+        } else {
+            view = static_cast<const char *>(address);
+            mapped = true;
+        }
+    }
+
+    ::close(descriptor);
+#else
+    std::ifstream stream(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!stream.is_open()) {
+        return;
+    }
+
+    fallback.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(fallback.data(), static_cast<std::streamsize>(fallback.size()));
+
+    view = fallback.data();
+    length = fallback.size();
+    opened = true;
+#endif
+}
+
+io::MappedFile::~MappedFile() {
+    close();
+}
+
+io::MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+
+io::MappedFile &io::MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+
+        view = std::exchange(other.view, nullptr);
+        length = std::exchange(other.length, 0);
+        opened = std::exchange(other.opened, false);
+        mapped = std::exchange(other.mapped, false);
+        fallback = std::move(other.fallback);
+    }
+
+    return *this;
+}
+
+void io::MappedFile::close() {
+#ifdef IO_HAS_MMAP
+    if (mapped) {
+        munmap(const_cast<char *>(view), length);
+    }
+#endif
+
+    view = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+    fallback.clear();
+}
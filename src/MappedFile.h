@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace io {
+    // Read-only view of a whole file. Uses mmap where available and falls back to
+    // reading the file into memory elsewhere, so callers only see data()/size().
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string &path);
+        ~MappedFile();
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool isOpen() const { return opened; }
+        const char *data() const { return view; }
+        size_t size() const { return length; }
+
+    private:
+        void close();
+
+        const char *view = nullptr;
+        size_t length = 0;
+        bool opened = false;
+        bool mapped = false;
+        std::vector<char> fallback;
+    };
+}
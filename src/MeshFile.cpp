@@ -0,0 +1,94 @@
+#include <cstring>
+#include <stdexcept>
+#include "MeshFile.h"
+#include "Profiler.h"
+
+namespace {
+    bool sectionFits(uint64_t offset, uint64_t size, size_t fileSize) {
+        return offset % meshes::MeshAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+meshes::MeshFile::MeshFile(const std::string &path) : file(path) {
+    PROFILE_SCOPE("MeshFile::open");
+
+    if (!file.isOpen()) {
+        throw std::runtime_error("Can't open mesh '" + path + "'");
+    }
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Mesh '" + path + "' is truncated");
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != MeshMagic) {
+        throw std::runtime_error("'" + path + "' is not a converted mesh");
+    }
+    if (header.version != MeshVersion) {
+        throw std::runtime_error("Mesh '" + path + "' has version " + std::to_string(header.version) +
+                                 ", expected " + std::to_string(MeshVersion) + "; convert it again");
+    }
+
+    uint64_t indexSize = header.indexType == static_cast<uint32_t>(IndexType::Uint16) ? 2 : 4;
+    if (header.indexType > static_cast<uint32_t>(IndexType::Uint32) ||
+        !sectionFits(header.vertexOffset, uint64_t(header.vertexCount) * sizeof(PackedVertex), file.size()) ||
+        !sectionFits(header.indexOffset, uint64_t(header.indexCount) * indexSize, file.size()) ||
+        !sectionFits(header.submeshOffset, uint64_t(header.submeshCount) * sizeof(Submesh), file.size())) {
+        throw std::runtime_error("Mesh '" + path + "' is corrupt");
+    }
+
+    vertices = reinterpret_cast<const PackedVertex *>(file.data() + header.vertexOffset);
+    indices = file.data() + header.indexOffset;
+    submeshes = reinterpret_cast<const Submesh *>(file.data() + header.submeshOffset);
+
+    // The submesh table is small; the indices themselves are left unread.
+    for (size_t i = 0; i < header.submeshCount; ++i) {
+        const Submesh &submesh = submeshes[i];
+        if (uint64_t(submesh.firstIndex) + submesh.indexCount > header.indexCount ||
+            uint64_t(submesh.baseVertex) + submesh.vertexCount > header.vertexCount) {
+            throw std::runtime_error("Mesh '" + path + "' has submesh " + std::to_string(i) + " out of range");
+        }
+    }
+}
+
+glm::vec3 meshes::MeshFile::getPositionOffset() const {
+    return {header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]};
+}
+
+glm::vec3 meshes::MeshFile::getPositionScale() const {
+    return glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]) - getPositionOffset();
+}
+
+std::vector<render::VertexAttribute> meshes::MeshFile::getAttributes() {
+    return {
+            {0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PackedVertex, position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, normal)},
+            {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, uv)}
+    };
+}
+
+meshes::MeshBuffers meshes::MeshFile::upload(render::GlDispatch &gl, GLenum usage) const {
+    PROFILE_SCOPE("MeshFile::upload");
+    MeshBuffers buffers;
+    buffers.indexType = getIndexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    gl.genVertexArrays(1, &buffers.vertexArray);
+    gl.genBuffers(1, &buffers.vertexBuffer);
+    gl.genBuffers(1, &buffers.indexBuffer);
+    gl.bindVertexArray(buffers.vertexArray);
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+    gl.bufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(header.vertexCount * sizeof(PackedVertex)), vertices,
+                  usage);
+    for (const auto &attribute : getAttributes()) {
+        gl.vertexAttribPointer(attribute.index, attribute.components, attribute.type, attribute.normalized,
+                               sizeof(PackedVertex), reinterpret_cast<const GLvoid *>(attribute.offset));
+        gl.enableVertexAttribArray(attribute.index);
+    }
+
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indexBuffer);
+    gl.bufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(header.indexCount * getIndexSize()), indices,
+                  usage);
+
+    gl.bindVertexArray(0);
+    return buffers;
+}
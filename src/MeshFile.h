@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/vec3.hpp>
+#include "GeometryArena.h"
+#include "GlDispatch.h"
+#include "MappedFile.h"
+#include "MeshFormat.h"
+
+namespace meshes {
+    struct MeshBuffers {
+        GLuint vertexArray;
+        GLuint vertexBuffer;
+        GLuint indexBuffer;
+        GLenum indexType;   // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    };
+
+    // A converted mesh mapped into memory. Opening checks the header, that
+    // every section lies inside the file and that every submesh lies inside
+    // the index and vertex sections; vertices and indices aren't read, so the
+    // cost is an mmap regardless of size. Throws std::runtime_error on a
+    // missing, truncated, foreign or corrupt file.
+    class MeshFile {
+    public:
+        explicit MeshFile(const std::string &path);
+
+        const MeshHeader &getHeader() const { return header; }
+        const PackedVertex *getVertices() const { return vertices; }
+        const void *getIndices() const { return indices; }
+        size_t getIndexSize() const { return header.indexType == static_cast<uint32_t>(IndexType::Uint16) ? 2 : 4; }
+        const Submesh *getSubmeshes() const { return submeshes; }
+        size_t getSubmeshCount() const { return header.submeshCount; }
+
+        // Undo the position quantization: boundsMin + position * extent.
+        glm::vec3 getPositionOffset() const;
+        glm::vec3 getPositionScale() const;
+
+        // Layout of PackedVertex: position 0, normal 1, uv 2.
+        static std::vector<render::VertexAttribute> getAttributes();
+
+        // Creates a vertex array with both buffers filled straight from the
+        // mapping. Leaves the vertex array unbound.
+        MeshBuffers upload(render::GlDispatch &gl, GLenum usage = GL_STATIC_DRAW) const;
+
+    private:
+        io::MappedFile file;
+        MeshHeader header;
+        const PackedVertex *vertices;
+        const void *indices;
+        const Submesh *submeshes;
+    };
+}
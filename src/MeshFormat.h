@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout written by the mesh_converter tool and mapped by MeshFile.
+// Every section starts at a MeshAlignment boundary, so the file can be used in
+// place: vertex and index sections go to glBufferData as they are.
+namespace meshes {
+    const uint32_t MeshMagic = 0x4853454d; // "MESH"
+    const uint32_t MeshVersion = 1;
+    const uint64_t MeshAlignment = 16;
+
+    enum class IndexType : uint32_t {
+        Uint16,
+        Uint32
+    };
+
+    // 16 bytes instead of the 32 of float position, normal and UV.
+    //  position: unsigned normalized shorts across the file bounds; the vertex
+    //            shader maps them back with boundsMin + position * extent
+    //  normal:   signed normalized 10:10:10:2 (GL_INT_2_10_10_10_REV)
+    //  uv:       half floats
+    struct PackedVertex {
+        uint16_t position[4]; // w is padding
+        uint32_t normal;
+        uint16_t uv[2];
+    };
+    static_assert(sizeof(PackedVertex) == 16, "PackedVertex is part of the file format");
+
+    struct MeshHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexType;
+        uint32_t submeshCount;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t submeshOffset;
+    };
+
+    // Indices of a submesh are relative to its baseVertex, which keeps them
+    // within 16 bits for all but very large submeshes.
+    struct Submesh {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t baseVertex;
+        uint32_t vertexCount;
+        uint32_t materialIndex;
+    };
+}
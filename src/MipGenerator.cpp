@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "MipGenerator.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIP_SSE2 1
+#endif
+
+namespace {
+    const int KaiserTaps = 8;
+    const double KaiserAlpha = 4.0;
+    const double Pi = 3.14159265358979323846;
+
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Taps sit at source offsets -3.5 .. 3.5 from the destination pixel centre.
+    // Halving makes them the same for every pixel, so they're computed once.
+    struct KaiserWeights {
+        float weights[KaiserTaps];
+
+        KaiserWeights() {
+            double total = 0.0;
+            double raw[KaiserTaps];
+            for (int i = 0; i < KaiserTaps; ++i) {
+                double offset = i - KaiserTaps / 2 + 0.5;
+                double x = offset / 2.0;
+                double sinc = std::sin(Pi * x) / (Pi * x);
+                double window = offset / (KaiserTaps / 2);
+                raw[i] = sinc * besselI0(KaiserAlpha * std::sqrt(1.0 - window * window)) / besselI0(KaiserAlpha);
+                total += raw[i];
+            }
+            for (int i = 0; i < KaiserTaps; ++i) {
+                weights[i] = static_cast<float>(raw[i] / total);
+            }
+        }
+    };
+
+    const KaiserWeights &kaiserWeights() {
+        static const KaiserWeights weights;
+        return weights;
+    }
+
+    inline int clampIndex(int index, int size) {
+        return std::min(std::max(index, 0), size - 1);
+    }
+
+    void boxRowScalar(const uint8_t *row0, const uint8_t *row1, int width, int x0, int x1, uint8_t *destination) {
+        for (int x = x0; x < x1; ++x) {
+            int left = 2 * x;
+            int right = std::min(left + 1, width - 1);
+            for (int channel = 0; channel < 4; ++channel) {
+                int sum = row0[left * 4 + channel] + row0[right * 4 + channel] +
+                          row1[left * 4 + channel] + row1[right * 4 + channel];
+                destination[x * 4 + channel] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+
+#ifdef MIP_SSE2
+    // Four source pixels of two rows in, two averaged pixels out as 16-bit lanes.
+    inline __m128i boxQuad(const uint8_t *row0, const uint8_t *row1) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0));
+        __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1));
+
+        __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+        return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+    }
+
+    inline __m128 loadPixel(const uint8_t *pixel) {
+        const __m128i zero = _mm_setzero_si128();
+        int32_t packed;
+        std::memcpy(&packed, pixel, sizeof(packed));
+        __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        return _mm_cvtepi32_ps(wide);
+    }
+
+    inline void storePixel(__m128 value, uint8_t *pixel) {
+        __m128i integer = _mm_cvtps_epi32(value);
+        integer = _mm_packs_epi32(integer, integer);
+        integer = _mm_packus_epi16(integer, integer);
+        int32_t packed = _mm_cvtsi128_si32(integer);
+        std::memcpy(pixel, &packed, sizeof(packed));
+    }
+#endif
+}
+
+void textures::downsampleBox(const uint8_t *source, int width, int height, uint8_t *destination) {
+    int targetWidth = std::max(width / 2, 1);
+    int targetHeight = std::max(height / 2, 1);
+
+    for (int y = 0; y < targetHeight; ++y) {
+        const uint8_t *row0 = source + static_cast<size_t>(2 * y) * width * 4;
+        const uint8_t *row1 = source + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width * 4;
+        uint8_t *output = destination + static_cast<size_t>(y) * targetWidth * 4;
+
+        int x = 0;
+#ifdef MIP_SSE2
+        // Whole pairs of source pixels only; a 1-pixel-wide source has none.
+        if (width > 1) {
+            for (; x + 4 <= targetWidth; x += 4) {
+                __m128i first = boxQuad(row0 + x * 8, row1 + x * 8);
+                __m128i second = boxQuad(row0 + x * 8 + 16, row1 + x * 8 + 16);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(output + x * 4), _mm_packus_epi16(first, second));
+            }
+        }
+#endif
+        boxRowScalar(row0, row1, width, x, targetWidth, output);
+    }
+}
+
+void textures::downsampleKaiser(const uint8_t *source, int width, int height, uint8_t *destination) {
+    const float *weights = kaiserWeights().weights;
+    int targetWidth = std::max(width / 2, 1);
+    int targetHeight = std::max(height / 2, 1);
+
+    // Horizontal pass into floats, full source height.
+    std::vector<float> horizontal(static_cast<size_t>(targetWidth) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *row = source + static_cast<size_t>(y) * width * 4;
+        float *output = horizontal.data() + static_cast<size_t>(y) * targetWidth * 4;
+
+        for (int x = 0; x < targetWidth; ++x) {
+            int first = 2 * x - KaiserTaps / 2 + 1;
+#ifdef MIP_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int tap = 0; tap < KaiserTaps; ++tap) {
+                __m128 pixel = loadPixel(row + clampIndex(first + tap, width) * 4);
+                sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weights[tap])));
+            }
+            _mm_storeu_ps(output + x * 4, sum);
+#else
+            for (int channel = 0; channel < 4; ++channel) {
+                float sum = 0.f;
+                for (int tap = 0; tap < KaiserTaps; ++tap) {
+                    sum += row[clampIndex(first + tap, width) * 4 + channel] * weights[tap];
+                }
+                output[x * 4 + channel] = sum;
+            }
+#endif
+        }
+    }
+
+    // Vertical pass: each output row blends eight float rows.
+    for (int y = 0; y < targetHeight; ++y) {
+        const float *rows[KaiserTaps];
+        int first = 2 * y - KaiserTaps / 2 + 1;
+        for (int tap = 0; tap < KaiserTaps; ++tap) {
+            rows[tap] = horizontal.data() + static_cast<size_t>(clampIndex(first + tap, height)) * targetWidth * 4;
+        }
+
+        uint8_t *output = destination + static_cast<size_t>(y) * targetWidth * 4;
+        for (int x = 0; x < targetWidth; ++x) {
+#ifdef MIP_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int tap = 0; tap < KaiserTaps; ++tap) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[tap] + x * 4), _mm_set1_ps(weights[tap])));
+            }
+            // The negative lobes can overshoot; the saturating packs clamp.
+            storePixel(sum, output + x * 4);
+#else
+            for (int channel = 0; channel < 4; ++channel) {
+                float sum = 0.f;
+                for (int tap = 0; tap < KaiserTaps; ++tap) {
+                    sum += rows[tap][x * 4 + channel] * weights[tap];
+                }
+                output[x * 4 + channel] = static_cast<uint8_t>(std::min(std::max(sum + 0.5f, 0.f), 255.f));
+            }
+#endif
+        }
+    }
+}
+
+textures::MipChain textures::generateMipChain(const uint8_t *rgba, int width, int height, MipFilter filter) {
+    PROFILE_SCOPE("generateMipChain");
+    MipChain chain;
+
+    size_t total = 0;
+    for (int levelWidth = width, levelHeight = height;; levelWidth = std::max(levelWidth / 2, 1),
+            levelHeight = std::max(levelHeight / 2, 1)) {
+        size_t size = static_cast<size_t>(levelWidth) * levelHeight * 4;
+        chain.levels.push_back({levelWidth, levelHeight, total, size});
+        total += size;
+
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+    }
+
+    chain.pixels.resize(total);
+    std::memcpy(chain.pixels.data(), rgba, chain.levels[0].size);
+
+    for (size_t level = 1; level < chain.levels.size(); ++level) {
+        const MipLevel &previous = chain.levels[level - 1];
+        const uint8_t *source = chain.pixels.data() + previous.offset;
+        uint8_t *destination = chain.pixels.data() + chain.levels[level].offset;
+
+        if (filter == MipFilter::Kaiser) {
+            downsampleKaiser(source, previous.width, previous.height, destination);
+        } else {
+            downsampleBox(source, previous.width, previous.height, destination);
+        }
+    }
+
+    return chain;
+}
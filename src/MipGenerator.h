@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace textures {
+    enum class MipFilter : uint32_t {
+        Box,    // 2x2 average, fastest
+        Kaiser  // 8-tap Kaiser-windowed sinc, keeps small mips sharper
+    };
+
+    struct MipLevel {
+        int width;
+        int height;
+        size_t offset;  // into the chain's pixel storage
+        size_t size;
+    };
+
+    // RGBA8 levels from full size down to 1x1, stored back to back.
+    struct MipChain {
+        std::vector<MipLevel> levels;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Halves both dimensions (rounding down, at least 1). Odd source edges are
+    // clamped rather than weighted, and channels are filtered as stored, without
+    // an sRGB round trip.
+    void downsampleBox(const uint8_t *source, int width, int height, uint8_t *destination);
+    void downsampleKaiser(const uint8_t *source, int width, int height, uint8_t *destination);
+
+    MipChain generateMipChain(const uint8_t *rgba, int width, int height, MipFilter filter);
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "Profiler.h"
+
+namespace {
+    void writeEscaped(std::ostream &out, const char *text) {
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') {
+                out << '\\';
+            }
+            out << *text;
+        }
+    }
+
+    double percentile(const std::vector<double> &sorted, double fraction) {
+        size_t index = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<size_t>(index, 1)) - 1];
+    }
+}
+
+profiling::Profiler &profiling::Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+profiling::Profiler::ThreadBuffer &profiling::Profiler::threadBuffer() {
+    // The profiler is a process-wide singleton, so the cached pointer can't go
+    // stale: buffers live as long as it does.
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->thread = static_cast<uint32_t>(buffers.size() - 1);
+    }
+    return *buffer;
+}
+
+void profiling::Profiler::push(const Event &event) {
+    ThreadBuffer &buffer = threadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+    Slot &slot = buffer.slots[head % RingCapacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(event.name, std::memory_order_relaxed);
+    slot.type.store(event.type, std::memory_order_relaxed);
+    slot.start.store(event.start, std::memory_order_relaxed);
+    slot.duration.store(event.duration, std::memory_order_relaxed);
+    slot.value.store(event.value, std::memory_order_relaxed);
+    slot.sequence.store(head + 1, std::memory_order_release);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// False when the owner has lapped the slot, before or during the copy.
+bool profiling::Profiler::read(const ThreadBuffer &buffer, uint64_t index, Event &event) {
+    const Slot &slot = buffer.slots[index % RingCapacity];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+        return false;
+    }
+
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.type = slot.type.load(std::memory_order_relaxed);
+    event.thread = buffer.thread;
+    event.start = slot.start.load(std::memory_order_relaxed);
+    event.duration = slot.duration.load(std::memory_order_relaxed);
+    event.value = slot.value.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+void profiling::Profiler::record(const char *name, int64_t start, int64_t end) {
+    push({name, Event::Type::Scope, 0, start, end - start, 0.0});
+}
+
+void profiling::Profiler::counter(const char *name, double value) {
+    push({name, Event::Type::Counter, 0, nowNanoseconds(), 0, value});
+}
+
+void profiling::Profiler::drain(ThreadBuffer &buffer) {
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+    if (head - buffer.tail > RingCapacity) {
+        droppedEvents += head - buffer.tail - RingCapacity;
+        buffer.tail = head - RingCapacity;
+    }
+
+    if (!capturing) {
+        buffer.tail = head;
+        return;
+    }
+
+    for (uint64_t index = buffer.tail; index != head; ++index) {
+        Event event;
+        if (read(buffer, index, event)) {
+            captured.push_back(event);
+        } else {
+            ++droppedEvents;
+        }
+    }
+
+    buffer.tail = head;
+}
+
+void profiling::Profiler::endFrame(int64_t now) {
+    if (lastFrameEnd != 0) {
+        double milliseconds = (now - lastFrameEnd) / 1e6;
+        if (frameTimes.size() < FrameWindow) {
+            frameTimes.push_back(milliseconds);
+        } else {
+            frameTimes[frameIndex % FrameWindow] = milliseconds;
+        }
+        ++frameIndex;
+
+        record("Frame", lastFrameEnd, now);
+    }
+    lastFrameEnd = now;
+
+    lastFrameCounters = frameCounters;
+    frameCounters = FrameCounters();
+    counter("Draw calls", lastFrameCounters.drawCalls);
+    counter("State changes", lastFrameCounters.stateChanges);
+    counter("Bytes uploaded", lastFrameCounters.bytesUploaded);
+
+    drainAll();
+}
+
+void profiling::Profiler::drainAll() {
+    std::vector<ThreadBuffer *> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto &buffer : buffers) {
+            snapshot.push_back(buffer.get());
+        }
+    }
+
+    for (auto buffer : snapshot) {
+        drain(*buffer);
+    }
+}
+
+void profiling::Profiler::startCapture() {
+    // Skip whatever piled up before the capture started.
+    capturing = false;
+    drainAll();
+
+    captured.clear();
+    droppedEvents = 0;
+    capturing = true;
+}
+
+void profiling::Profiler::stopCapture() {
+    drainAll();
+    capturing = false;
+}
+
+profiling::FrameTimeStats profiling::Profiler::getFrameTimeStats() const {
+    FrameTimeStats stats;
+    if (frameTimes.empty()) {
+        return stats;
+    }
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.samples = sorted.size();
+    for (double time : sorted) {
+        stats.mean += time;
+    }
+    stats.mean /= sorted.size();
+    stats.p50 = percentile(sorted, 0.50);
+    stats.p95 = percentile(sorted, 0.95);
+    stats.p99 = percentile(sorted, 0.99);
+    return stats;
+}
+
+bool profiling::Profiler::writeTrace(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    int64_t origin = captured.empty() ? 0 : captured.front().start;
+    for (const auto &event : captured) {
+        origin = std::min(origin, event.start);
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out.precision(3);
+    out << std::fixed;
+
+    bool first = true;
+    for (const auto &event : captured) {
+        out << (first ? "" : ",\n") << "{\"name\":\"";
+        writeEscaped(out, event.name);
+        out << "\",\"pid\":0,\"tid\":" << event.thread << ",\"ts\":" << (event.start - origin) / 1e3;
+
+        if (event.type == Event::Type::Scope) {
+            out << ",\"ph\":\"X\",\"dur\":" << event.duration / 1e3 << '}';
+        } else {
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+        }
+        first = false;
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void profiling::reportProfile(const std::string &tracePath) {
+#ifdef PROFILER_ENABLED
+    auto &profiler = Profiler::instance();
+    auto stats = profiler.getFrameTimeStats();
+    if (stats.samples != 0) {
+        std::cout << "Frame time over the last " << stats.samples << " frames: p50 " << stats.p50 << " ms, p95 "
+                  << stats.p95 << " ms, p99 " << stats.p99 << " ms\n";
+    }
+
+    if (!tracePath.empty()) {
+        profiler.stopCapture();
+        if (profiler.writeTrace(tracePath)) {
+            std::cout << "Wrote " << profiler.getCapturedEventCount() << " events to " << tracePath << '\n';
+        } else {
+            std::cerr << "Can't write trace to '" << tracePath << "'.\n";
+        }
+    }
+#else
+    if (!tracePath.empty()) {
+        std::cerr << "Built without ENABLE_PROFILER, no trace written.\n";
+    }
+#endif
+}
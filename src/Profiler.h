@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Instrumentation is compiled in only with PROFILER_ENABLED (the ENABLE_PROFILER
+// CMake option); otherwise every macro below expands to nothing.
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) profiling::ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) profiling::Profiler::instance().counter(name, static_cast<double>(value))
+#define PROFILE_FRAME_COUNTERS(counters) profiling::Profiler::instance().setFrameCounters(counters)
+#define PROFILE_END_FRAME() profiling::Profiler::instance().endFrame()
+#else
+#define PROFILE_SCOPE(name) do {} while (false)
+#define PROFILE_COUNTER(name, value) do {} while (false)
+#define PROFILE_FRAME_COUNTERS(counters) do {} while (false)
+#define PROFILE_END_FRAME() do {} while (false)
+#endif
+
+namespace profiling {
+    inline int64_t nowNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Names are stored by pointer and must outlive the profiler; use literals.
+    struct Event {
+        enum class Type : uint32_t { Scope, Counter };
+
+        const char *name;
+        Type type;
+        uint32_t thread;
+        int64_t start;      // ns
+        int64_t duration;   // ns, scopes only
+        double value;       // counters only
+    };
+
+    struct FrameCounters {
+        size_t drawCalls = 0;
+        size_t stateChanges = 0;
+        size_t bytesUploaded = 0;
+    };
+
+    struct FrameTimeStats {
+        size_t samples = 0;
+        double mean = 0.0;  // all in ms
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    // Collects scoped timings and counters from any thread. Each thread records
+    // into its own ring buffer of seqlocked slots, so the hot path never locks;
+    // endFrame() on the main thread drains all buffers. Events a thread
+    // overwrites before they are drained are lost and counted, never torn. Frame times
+    // are kept for the last FrameWindow frames for the percentiles, and everything
+    // drained while a capture runs can be written as a Chrome trace_event file
+    // (chrome://tracing, Perfetto).
+    class Profiler {
+    public:
+        static const size_t RingCapacity = 1 << 14;
+        static const size_t FrameWindow = 512;
+
+        static Profiler &instance();
+
+        Profiler(const Profiler &) = delete;
+        Profiler &operator=(const Profiler &) = delete;
+
+        void record(const char *name, int64_t start, int64_t end);
+        void counter(const char *name, double value);
+
+        // Replaces the counters reported for the current frame.
+        void setFrameCounters(const FrameCounters &counters) { frameCounters = counters; }
+
+        void endFrame() { endFrame(nowNanoseconds()); }
+        // now is the frame's end in nowNanoseconds() time, e.g. to replay a
+        // known frame sequence.
+        void endFrame(int64_t now);
+
+        void startCapture();
+        void stopCapture();
+        bool isCapturing() const { return capturing; }
+        size_t getCapturedEventCount() const { return captured.size(); }
+        bool writeTrace(const std::string &path) const;
+
+        FrameTimeStats getFrameTimeStats() const;
+        const FrameCounters &getLastFrameCounters() const { return lastFrameCounters; }
+        size_t getDroppedEventCount() const { return droppedEvents; }
+
+    private:
+        // A ring entry as a single-writer seqlock: the owner zeroes sequence,
+        // stores the fields and then publishes the event's index + 1, so a
+        // reader that sees the same index + 1 before and after its loads has
+        // a whole event. The fields are atomics so those loads aren't a race.
+        struct Slot {
+            std::atomic<uint64_t> sequence{0};
+            std::atomic<const char *> name{nullptr};
+            std::atomic<Event::Type> type{Event::Type::Scope};
+            std::atomic<int64_t> start{0};
+            std::atomic<int64_t> duration{0};
+            std::atomic<double> value{0.0};
+        };
+
+        struct ThreadBuffer {
+            std::unique_ptr<Slot[]> slots{new Slot[RingCapacity]};
+            std::atomic<uint64_t> head{0};  // written by the owning thread only
+            uint64_t tail = 0;              // read position, main thread only
+            uint32_t thread;
+        };
+
+        Profiler() = default;
+
+        ThreadBuffer &threadBuffer();
+        void push(const Event &event);
+        static bool read(const ThreadBuffer &buffer, uint64_t index, Event &event);
+        void drain(ThreadBuffer &buffer);
+        void drainAll();
+
+        std::mutex buffersMutex;            // registration only
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        int64_t lastFrameEnd = 0;
+        std::vector<double> frameTimes;     // ms, ring of FrameWindow
+        size_t frameIndex = 0;
+
+        FrameCounters frameCounters;
+        FrameCounters lastFrameCounters;
+
+        bool capturing = false;
+        std::vector<Event> captured;
+        size_t droppedEvents = 0;
+    };
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const char *name) : name(name), start(nowNanoseconds()) {}
+        ~ScopedTimer() { Profiler::instance().record(name, start, nowNanoseconds()); }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        const char *name;
+        int64_t start;
+    };
+
+    // Prints the frame time percentiles and, when tracePath isn't empty, stops
+    // the capture and writes it there. Without PROFILER_ENABLED there's
+    // nothing to report, and a trace path only gets a warning.
+    void reportProfile(const std::string &tracePath);
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <stdexcept>
+#include "RangeAllocator.h"
+
+render::RangeAllocator::RangeAllocator(size_t capacity) : capacity(capacity) {
+    if (capacity != 0) {
+        freeBlocks[0] = capacity;
+    }
+}
+
+size_t render::RangeAllocator::allocate(size_t size) {
+    if (size == 0) {
+        return InvalidOffset;
+    }
+
+    for (auto block = freeBlocks.begin(); block != freeBlocks.end(); ++block) {
+        if (block->second < size) {
+            continue;
+        }
+
+        size_t offset = block->first;
+        size_t remaining = block->second - size;
+        freeBlocks.erase(block);
+        if (remaining != 0) {
+            freeBlocks[offset + size] = remaining;
+        }
+
+        used += size;
+        return offset;
+    }
+
+    return InvalidOffset;
+}
+
+void render::RangeAllocator::free(size_t offset, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (offset + size > capacity || size > used) {
+        throw std::logic_error("Freeing a range that was not allocated");
+    }
+
+    used -= size;
+
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && next->first == offset + size) {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+
+    if (next != freeBlocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    freeBlocks[offset] = size;
+}
+
+void render::RangeAllocator::grow(size_t newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+
+    size_t offset = capacity;
+    size_t size = newCapacity - capacity;
+    capacity = newCapacity;
+
+    if (!freeBlocks.empty()) {
+        auto last = std::prev(freeBlocks.end());
+        if (last->first + last->second == offset) {
+            last->second += size;
+            return;
+        }
+    }
+
+    freeBlocks[offset] = size;
+}
+
+void render::RangeAllocator::reset(size_t newUsed, size_t newCapacity) {
+    capacity = std::max(newUsed, newCapacity);
+    used = newUsed;
+
+    freeBlocks.clear();
+    if (capacity > used) {
+        freeBlocks[used] = capacity - used;
+    }
+}
+
+size_t render::RangeAllocator::getLargestFreeBlock() const {
+    size_t largest = 0;
+    for (const auto &block : freeBlocks) {
+        largest = std::max(largest, block.second);
+    }
+
+    return largest;
+}
+
+float render::RangeAllocator::getFragmentation() const {
+    size_t freeSpace = capacity - used;
+    if (freeSpace == 0) {
+        return 0.f;
+    }
+
+    return 1.f - static_cast<float>(getLargestFreeBlock()) / static_cast<float>(freeSpace);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <map>
+
+namespace render {
+    // First-fit allocator over an abstract [0, capacity) range. Freed ranges are
+    // coalesced with their neighbours. Units are whatever the caller indexes by
+    // (vertices, indices, bytes).
+    class RangeAllocator {
+    public:
+        static constexpr size_t InvalidOffset = std::numeric_limits<size_t>::max();
+
+        explicit RangeAllocator(size_t capacity = 0);
+
+        size_t allocate(size_t size);
+        void free(size_t offset, size_t size);
+
+        void grow(size_t newCapacity);
+        // Forgets all allocations and marks [0, used) as taken, [used, capacity) as free.
+        void reset(size_t used, size_t newCapacity);
+
+        size_t getCapacity() const { return capacity; }
+        size_t getUsed() const { return used; }
+        size_t getLargestFreeBlock() const;
+        size_t getFreeBlockCount() const { return freeBlocks.size(); }
+
+        // 0 when all free space is one block, approaching 1 as it is scattered.
+        float getFragmentation() const;
+
+    private:
+        std::map<size_t, size_t> freeBlocks; // offset -> size
+        size_t capacity;
+        size_t used = 0;
+    };
+}
@@ -0,0 +1,1253 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "Hash.h"
+#include "RecordingGlDispatch.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace {
+    const GLenum FakeBinaryFormat = 0x8f00;
+    const char FakeBinary[8] = {'R', 'E', 'C', 'O', 'R', 'D', 'E', 'D'};
+
+    std::string format(const char *pattern, ...) {
+        va_list arguments;
+        va_start(arguments, pattern);
+        va_list copy;
+        va_copy(copy, arguments);
+        int length = std::vsnprintf(nullptr, 0, pattern, copy);
+        va_end(copy);
+
+        std::string text(static_cast<size_t>(std::max(length, 0)), '\0');
+        std::vsnprintf(&text[0], text.size() + 1, pattern, arguments);
+        va_end(arguments);
+        return text;
+    }
+
+#define ENUM_NAME(name) case name: return #name;
+
+    std::string enumName(GLenum value) {
+        switch (value) {
+            ENUM_NAME(GL_ARRAY_BUFFER)
+            ENUM_NAME(GL_ELEMENT_ARRAY_BUFFER)
+            ENUM_NAME(GL_COPY_READ_BUFFER)
+            ENUM_NAME(GL_COPY_WRITE_BUFFER)
+            ENUM_NAME(GL_UNIFORM_BUFFER)
+            ENUM_NAME(GL_PIXEL_UNPACK_BUFFER)
+            ENUM_NAME(GL_STREAM_DRAW)
+            ENUM_NAME(GL_STATIC_DRAW)
+            ENUM_NAME(GL_DYNAMIC_DRAW)
+            ENUM_NAME(GL_TRIANGLES)
+            ENUM_NAME(GL_TRIANGLE_STRIP)
+            ENUM_NAME(GL_TRIANGLE_FAN)
+            ENUM_NAME(GL_BYTE)
+            ENUM_NAME(GL_UNSIGNED_BYTE)
+            ENUM_NAME(GL_SHORT)
+            ENUM_NAME(GL_UNSIGNED_SHORT)
+            ENUM_NAME(GL_INT)
+            ENUM_NAME(GL_UNSIGNED_INT)
+            ENUM_NAME(GL_FLOAT)
+            ENUM_NAME(GL_HALF_FLOAT)
+            ENUM_NAME(GL_INT_2_10_10_10_REV)
+            ENUM_NAME(GL_BLEND)
+            ENUM_NAME(GL_DEPTH_TEST)
+            ENUM_NAME(GL_CULL_FACE)
+            ENUM_NAME(GL_SCISSOR_TEST)
+            ENUM_NAME(GL_STENCIL_TEST)
+            ENUM_NAME(GL_FRAMEBUFFER_SRGB)
+            ENUM_NAME(GL_SRC_COLOR)
+            ENUM_NAME(GL_ONE_MINUS_SRC_COLOR)
+            ENUM_NAME(GL_SRC_ALPHA)
+            ENUM_NAME(GL_ONE_MINUS_SRC_ALPHA)
+            ENUM_NAME(GL_DST_ALPHA)
+            ENUM_NAME(GL_ONE_MINUS_DST_ALPHA)
+            ENUM_NAME(GL_DST_COLOR)
+            ENUM_NAME(GL_ONE_MINUS_DST_COLOR)
+            ENUM_NAME(GL_VERTEX_SHADER)
+            ENUM_NAME(GL_FRAGMENT_SHADER)
+            ENUM_NAME(GL_GEOMETRY_SHADER)
+            ENUM_NAME(GL_COMPILE_STATUS)
+            ENUM_NAME(GL_LINK_STATUS)
+            ENUM_NAME(GL_INFO_LOG_LENGTH)
+            ENUM_NAME(GL_SHADER_TYPE)
+            ENUM_NAME(GL_ATTACHED_SHADERS)
+            ENUM_NAME(GL_PROGRAM_BINARY_LENGTH)
+            ENUM_NAME(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+            ENUM_NAME(GL_NUM_PROGRAM_BINARY_FORMATS)
+            ENUM_NAME(GL_VENDOR)
+            ENUM_NAME(GL_RENDERER)
+            ENUM_NAME(GL_VERSION)
+            ENUM_NAME(GL_EXTENSIONS)
+            ENUM_NAME(GL_NUM_EXTENSIONS)
+            ENUM_NAME(GL_TEXTURE_2D)
+            ENUM_NAME(GL_TEXTURE_MIN_FILTER)
+            ENUM_NAME(GL_TEXTURE_MAG_FILTER)
+            ENUM_NAME(GL_TEXTURE_WRAP_S)
+            ENUM_NAME(GL_TEXTURE_WRAP_T)
+            ENUM_NAME(GL_TEXTURE_BASE_LEVEL)
+            ENUM_NAME(GL_TEXTURE_MAX_LEVEL)
+            ENUM_NAME(GL_NEAREST)
+            ENUM_NAME(GL_LINEAR)
+            ENUM_NAME(GL_NEAREST_MIPMAP_NEAREST)
+            ENUM_NAME(GL_LINEAR_MIPMAP_NEAREST)
+            ENUM_NAME(GL_NEAREST_MIPMAP_LINEAR)
+            ENUM_NAME(GL_LINEAR_MIPMAP_LINEAR)
+            ENUM_NAME(GL_REPEAT)
+            ENUM_NAME(GL_CLAMP_TO_EDGE)
+            ENUM_NAME(GL_MIRRORED_REPEAT)
+            ENUM_NAME(GL_RED)
+            ENUM_NAME(GL_RG)
+            ENUM_NAME(GL_RGB)
+            ENUM_NAME(GL_RGBA)
+            ENUM_NAME(GL_R8)
+            ENUM_NAME(GL_RGB8)
+            ENUM_NAME(GL_RGBA8)
+            ENUM_NAME(GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+            ENUM_NAME(GL_PACK_ALIGNMENT)
+            ENUM_NAME(GL_UNPACK_ALIGNMENT)
+            ENUM_NAME(GL_UNPACK_ROW_LENGTH)
+            ENUM_NAME(GL_TIME_ELAPSED)
+            ENUM_NAME(GL_TIMESTAMP)
+            ENUM_NAME(GL_SAMPLES_PASSED)
+            ENUM_NAME(GL_ANY_SAMPLES_PASSED)
+            ENUM_NAME(GL_QUERY_RESULT)
+            ENUM_NAME(GL_QUERY_RESULT_AVAILABLE)
+            default:
+                return format("0x%04x", value);
+        }
+    }
+
+#undef ENUM_NAME
+
+    // The values below GL_TRIANGLES are shared with other enums.
+    std::string modeName(GLenum mode) {
+        switch (mode) {
+            case GL_POINTS:
+                return "GL_POINTS";
+            case GL_LINES:
+                return "GL_LINES";
+            case GL_LINE_LOOP:
+                return "GL_LINE_LOOP";
+            case GL_LINE_STRIP:
+                return "GL_LINE_STRIP";
+            default:
+                return enumName(mode);
+        }
+    }
+
+    std::string factorName(GLenum factor) {
+        return factor == GL_ZERO ? "GL_ZERO" : factor == GL_ONE ? "GL_ONE" : enumName(factor);
+    }
+
+    std::string booleanName(GLboolean value) {
+        return value ? "GL_TRUE" : "GL_FALSE";
+    }
+
+    std::string clearMaskName(GLbitfield mask) {
+        const std::pair<GLbitfield, const char *> bits[] = {{GL_COLOR_BUFFER_BIT, "GL_COLOR_BUFFER_BIT"},
+                                                            {GL_DEPTH_BUFFER_BIT, "GL_DEPTH_BUFFER_BIT"},
+                                                            {GL_STENCIL_BUFFER_BIT, "GL_STENCIL_BUFFER_BIT"}};
+        std::string name;
+        for (const auto &bit : bits) {
+            if (mask & bit.first) {
+                name += (name.empty() ? "" : " | ") + std::string(bit.second);
+                mask &= ~bit.first;
+            }
+        }
+        if (mask != 0 || name.empty()) {
+            name += (name.empty() ? "" : " | ") + format("0x%x", mask);
+        }
+        return name;
+    }
+
+    // Contents are logged by hash, so a golden stream also catches changes to
+    // the uploaded data.
+    std::string dataName(const void *data, size_t size) {
+        if (data == nullptr) {
+            return "null";
+        }
+        return format("data:%016llx", static_cast<unsigned long long>(hashing::fnv1a(data, size)));
+    }
+
+    // Offsets into a bound buffer travel in pointer arguments.
+    std::string offsetName(const void *pointer) {
+        return std::to_string(reinterpret_cast<uintptr_t>(pointer));
+    }
+
+    template<typename T, typename Format>
+    std::string listName(const T *values, GLsizei count, Format name) {
+        std::string list = "[";
+        for (GLsizei i = 0; i < count; ++i) {
+            list += (i == 0 ? "" : ", ") + name(values[i]);
+        }
+        return list + "]";
+    }
+
+    std::string namesList(GLsizei count, const GLuint *names) {
+        return listName(names, count, [](GLuint name) { return std::to_string(name); });
+    }
+
+    size_t indexSize(GLenum type) {
+        switch (type) {
+            case GL_UNSIGNED_BYTE:
+                return 1;
+            case GL_UNSIGNED_SHORT:
+                return 2;
+            case GL_UNSIGNED_INT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    // Bytes glTexImage2D reads for the common uncompressed formats; 0 when unknown.
+    size_t pixelBytes(GLenum format, GLenum type, GLsizei width, GLsizei height, GLint alignment) {
+        size_t components = format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3
+                          : format == GL_RGBA ? 4 : 0;
+        size_t componentSize = type == GL_UNSIGNED_BYTE ? 1 : type == GL_FLOAT ? 4 : 0;
+        if (components == 0 || componentSize == 0 || width <= 0 || height <= 0) {
+            return 0;
+        }
+
+        size_t row = static_cast<size_t>(width) * components * componentSize;
+        size_t stride = (row + alignment - 1) / alignment * alignment;
+        return stride * static_cast<size_t>(height - 1) + row;
+    }
+
+    bool isEnumParameter(GLenum name) {
+        return name == GL_TEXTURE_MIN_FILTER || name == GL_TEXTURE_MAG_FILTER || name == GL_TEXTURE_WRAP_S ||
+               name == GL_TEXTURE_WRAP_T;
+    }
+}
+
+size_t render::RecordingGlDispatch::countIssues(IssueType type) const {
+    return static_cast<size_t>(std::count_if(issues.begin(), issues.end(),
+                                             [type](const Issue &issue) { return issue.type == type; }));
+}
+
+size_t render::RecordingGlDispatch::getLiveObjectCount() const {
+    size_t deletedPrograms = static_cast<size_t>(std::count_if(
+            programs.begin(), programs.end(), [](const auto &entry) { return entry.second.deleted; }));
+    return buffers.size() + vertexArrays.size() + shaders.size() + programs.size() - deletedPrograms +
+           textures.size() + queries.size();
+}
+
+std::string render::RecordingGlDispatch::getLog() const {
+    std::string log;
+    auto issue = issues.begin();
+    for (size_t call = 0; call < calls.size(); ++call) {
+        log += calls[call];
+        log += '\n';
+        for (; issue != issues.end() && issue->call == call; ++issue) {
+            log += issue->type == IssueType::Redundant ? "  ! redundant: " : "  ! invalid: ";
+            log += issue->message;
+            log += '\n';
+        }
+    }
+    return log;
+}
+
+void render::RecordingGlDispatch::clearLog() {
+    calls.clear();
+    issues.clear();
+    drawCalls = 0;
+}
+
+void render::RecordingGlDispatch::record(std::string call) {
+    calls.push_back(std::move(call));
+}
+
+void render::RecordingGlDispatch::redundant(std::string message) {
+    issues.push_back({IssueType::Redundant, calls.size() - 1, std::move(message)});
+}
+
+void render::RecordingGlDispatch::invalid(std::string message) {
+    issues.push_back({IssueType::Invalid, calls.size() - 1, std::move(message)});
+}
+
+std::string render::RecordingGlDispatch::genNames(const char *function, GLsizei count, GLuint *names) {
+    for (GLsizei i = 0; i < count; ++i) {
+        names[i] = ++lastName;
+    }
+    return format("%s(%d) -> ", function, count) + namesList(count, names);
+}
+
+GLuint &render::RecordingGlDispatch::bufferBinding(GLenum target) {
+    // The element array binding belongs to the vertex array.
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        return vertexArray != 0 ? vertexArrays[vertexArray].elementBuffer : elementBufferWithoutVao;
+    }
+    return bufferBindings[target];
+}
+
+render::RecordingGlDispatch::Buffer *render::RecordingGlDispatch::boundBuffer(GLenum target) {
+    auto buffer = buffers.find(bufferBinding(target));
+    return buffer != buffers.end() ? &buffer->second : nullptr;
+}
+
+render::RecordingGlDispatch::Program *render::RecordingGlDispatch::findProgram(GLuint name) {
+    auto entry = programs.find(name);
+    return entry != programs.end() && !entry->second.deleted ? &entry->second : nullptr;
+}
+
+render::RecordingGlDispatch::Texture *render::RecordingGlDispatch::boundTexture(GLenum target) {
+    auto texture = textures.find(textureBindings[target]);
+    return texture != textures.end() ? &texture->second : nullptr;
+}
+
+void render::RecordingGlDispatch::useProgram(GLuint name) {
+    record(format("glUseProgram(%u)", name));
+    if (name == program) {
+        redundant(format("program %u is already in use", name));
+        return;
+    }
+    if (name != 0) {
+        Program *entry = findProgram(name);
+        if (entry == nullptr) {
+            invalid(format("%u is not a program", name));
+            return;
+        }
+        if (!entry->linked) {
+            invalid(format("program %u is not linked", name));
+            return;
+        }
+    }
+
+    auto previous = programs.find(program);
+    if (previous != programs.end() && previous->second.deleted) {
+        programs.erase(previous);
+    }
+    program = name;
+}
+
+void render::RecordingGlDispatch::bindVertexArray(GLuint vao) {
+    record(format("glBindVertexArray(%u)", vao));
+    if (vao != 0 && vertexArrays.find(vao) == vertexArrays.end()) {
+        invalid(format("%u is not a vertex array", vao));
+        return;
+    }
+    if (vao == vertexArray) {
+        redundant(format("vertex array %u is already bound", vao));
+    }
+    vertexArray = vao;
+}
+
+void render::RecordingGlDispatch::setUniform(GLint location, int components, const GLfloat *value) {
+    if (program == 0) {
+        invalid("no program in use");
+        return;
+    }
+    if (location == -1) {
+        redundant("location -1 is ignored");
+        return;
+    }
+
+    Program &entry = programs[program];
+    bool known = std::any_of(entry.locations.begin(), entry.locations.end(),
+                             [location](const auto &uniform) { return uniform.second == location; });
+    if (!known) {
+        invalid(format("location %d is not a uniform of program %u", location, program));
+        return;
+    }
+
+    UniformValue uniform = {components, {0.f, 0.f, 0.f, 0.f}};
+    std::copy(value, value + components, uniform.value);
+
+    auto current = entry.uniforms.find(location);
+    if (current != entry.uniforms.end() && current->second.components == components &&
+        std::equal(value, value + components, current->second.value)) {
+        redundant(format("uniform %d of program %u already holds this value", location, program));
+    }
+    entry.uniforms[location] = uniform;
+}
+
+void render::RecordingGlDispatch::uniform1f(GLint location, GLfloat x) {
+    record(format("glUniform1f(%d, %g)", location, x));
+    setUniform(location, 1, &x);
+}
+
+void render::RecordingGlDispatch::uniform2f(GLint location, GLfloat x, GLfloat y) {
+    record(format("glUniform2f(%d, %g, %g)", location, x, y));
+    GLfloat value[] = {x, y};
+    setUniform(location, 2, value);
+}
+
+void render::RecordingGlDispatch::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    record(format("glUniform4f(%d, %g, %g, %g, %g)", location, x, y, z, w));
+    GLfloat value[] = {x, y, z, w};
+    setUniform(location, 4, value);
+}
+
+void render::RecordingGlDispatch::checkDraw(GLsizei count, GLsizei instanceCount) {
+    ++drawCalls;
+    if (program == 0) {
+        invalid("no program in use");
+    }
+    if (vertexArray == 0) {
+        invalid("no vertex array bound");
+    } else {
+        const VertexArray &vao = vertexArrays[vertexArray];
+        uint32_t missing = vao.enabled & ~vao.configured;
+        for (GLuint index = 0; missing != 0; ++index, missing >>= 1) {
+            if (missing & 1) {
+                invalid(format("attribute %u is enabled without a pointer", index));
+            }
+        }
+    }
+    if (count <= 0 || instanceCount <= 0) {
+        redundant("draws nothing");
+    }
+}
+
+void render::RecordingGlDispatch::checkIndices(GLsizei count, GLenum type, const void *indices) {
+    if (vertexArray == 0) {
+        return;
+    }
+
+    GLuint element = vertexArrays[vertexArray].elementBuffer;
+    if (element == 0) {
+        invalid("no element array buffer bound");
+        return;
+    }
+    size_t size = indexSize(type);
+    if (size == 0) {
+        invalid("index type " + enumName(type) + " is not an index type");
+        return;
+    }
+
+    const Buffer &buffer = buffers[element];
+    uintptr_t end = reinterpret_cast<uintptr_t>(indices) + static_cast<uintptr_t>(std::max(count, 0)) * size;
+    if (buffer.size < 0) {
+        invalid(format("element array buffer %u has no storage", element));
+    } else if (end > static_cast<uintptr_t>(buffer.size)) {
+        invalid(format("reads indices past the end of element array buffer %u", element));
+    }
+}
+
+void render::RecordingGlDispatch::drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+    record(format("glDrawElements(%s, %d, %s, %s)", modeName(mode).c_str(), count, enumName(type).c_str(),
+                  offsetName(indices).c_str()));
+    checkDraw(count, 1);
+    checkIndices(count, type, indices);
+}
+
+void render::RecordingGlDispatch::drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                        GLsizei instanceCount) {
+    record(format("glDrawElementsInstanced(%s, %d, %s, %s, %d)", modeName(mode).c_str(), count,
+                  enumName(type).c_str(), offsetName(indices).c_str(), instanceCount));
+    checkDraw(count, instanceCount);
+    checkIndices(count, type, indices);
+}
+
+void render::RecordingGlDispatch::multiDrawElements(GLenum mode, const GLsizei *counts, GLenum type,
+                                                    const void *const *indices, GLsizei drawCount) {
+    auto countName = [](GLsizei count) { return std::to_string(count); };
+    record(format("glMultiDrawElements(%s, %s, %s, %s, %d)", modeName(mode).c_str(),
+                  listName(counts, drawCount, countName).c_str(), enumName(type).c_str(),
+                  listName(indices, drawCount, offsetName).c_str(), drawCount));
+    checkDraw(drawCount, 1);
+    size_t before = issues.size();
+    for (GLsizei i = 0; i < drawCount && issues.size() == before; ++i) {
+        checkIndices(counts[i], type, indices[i]);
+    }
+}
+
+void render::RecordingGlDispatch::drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                         GLint baseVertex) {
+    record(format("glDrawElementsBaseVertex(%s, %d, %s, %s, %d)", modeName(mode).c_str(), count,
+                  enumName(type).c_str(), offsetName(indices).c_str(), baseVertex));
+    checkDraw(count, 1);
+    checkIndices(count, type, indices);
+}
+
+void render::RecordingGlDispatch::drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                                  const void *indices, GLsizei instanceCount,
+                                                                  GLint baseVertex) {
+    record(format("glDrawElementsInstancedBaseVertex(%s, %d, %s, %s, %d, %d)", modeName(mode).c_str(), count,
+                  enumName(type).c_str(), offsetName(indices).c_str(), instanceCount, baseVertex));
+    checkDraw(count, instanceCount);
+    checkIndices(count, type, indices);
+}
+
+void render::RecordingGlDispatch::multiDrawElementsBaseVertex(GLenum mode, const GLsizei *counts, GLenum type,
+                                                              const void *const *indices, GLsizei drawCount,
+                                                              const GLint *baseVertices) {
+    auto integerName = [](GLint value) { return std::to_string(value); };
+    record(format("glMultiDrawElementsBaseVertex(%s, %s, %s, %s, %d, %s)", modeName(mode).c_str(),
+                  listName(counts, drawCount, integerName).c_str(), enumName(type).c_str(),
+                  listName(indices, drawCount, offsetName).c_str(), drawCount,
+                  listName(baseVertices, drawCount, integerName).c_str()));
+    checkDraw(drawCount, 1);
+    size_t before = issues.size();
+    for (GLsizei i = 0; i < drawCount && issues.size() == before; ++i) {
+        checkIndices(counts[i], type, indices[i]);
+    }
+}
+
+void render::RecordingGlDispatch::drawArraysInstanced(GLenum mode, GLint first, GLsizei count,
+                                                      GLsizei instanceCount) {
+    record(format("glDrawArraysInstanced(%s, %d, %d, %d)", modeName(mode).c_str(), first, count, instanceCount));
+    checkDraw(count, instanceCount);
+}
+
+void render::RecordingGlDispatch::setCapability(GLenum capability, bool enabled) {
+    if ((capabilities.count(capability) != 0) == enabled) {
+        redundant(enumName(capability) + (enabled ? " is already enabled" : " is already disabled"));
+    }
+    if (enabled) {
+        capabilities.insert(capability);
+    } else {
+        capabilities.erase(capability);
+    }
+}
+
+void render::RecordingGlDispatch::enable(GLenum capability) {
+    record("glEnable(" + enumName(capability) + ")");
+    setCapability(capability, true);
+}
+
+void render::RecordingGlDispatch::disable(GLenum capability) {
+    record("glDisable(" + enumName(capability) + ")");
+    setCapability(capability, false);
+}
+
+void render::RecordingGlDispatch::blendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    record("glBlendFunc(" + factorName(sourceFactor) + ", " + factorName(destinationFactor) + ")");
+    if (sourceFactor == blendSource && destinationFactor == blendDestination) {
+        redundant("blend function is unchanged");
+    }
+    blendSource = sourceFactor;
+    blendDestination = destinationFactor;
+}
+
+void render::RecordingGlDispatch::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    record(format("glViewport(%d, %d, %d, %d)", x, y, width, height));
+    GLint rect[] = {x, y, width, height};
+    if (width < 0 || height < 0) {
+        invalid("negative viewport size");
+        return;
+    }
+    if (viewportSet && std::equal(rect, rect + 4, viewportRect)) {
+        redundant("viewport is unchanged");
+    }
+    std::copy(rect, rect + 4, viewportRect);
+    viewportSet = true;
+}
+
+void render::RecordingGlDispatch::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    record(format("glClearColor(%g, %g, %g, %g)", red, green, blue, alpha));
+    GLfloat color[] = {red, green, blue, alpha};
+    if (std::equal(color, color + 4, clearValue)) {
+        redundant("clear color is unchanged");
+    }
+    std::copy(color, color + 4, clearValue);
+}
+
+void render::RecordingGlDispatch::clear(GLbitfield mask) {
+    record("glClear(" + clearMaskName(mask) + ")");
+    if (mask == 0) {
+        redundant("clears nothing");
+    }
+}
+
+void render::RecordingGlDispatch::genBuffers(GLsizei count, GLuint *names) {
+    record(genNames("glGenBuffers", count, names));
+    for (GLsizei i = 0; i < count; ++i) {
+        buffers[names[i]];
+    }
+}
+
+void render::RecordingGlDispatch::deleteBuffers(GLsizei count, const GLuint *names) {
+    record(format("glDeleteBuffers(%d, ", count) + namesList(count, names) + ")");
+    for (GLsizei i = 0; i < count; ++i) {
+        GLuint name = names[i];
+        if (name == 0) {
+            continue;
+        }
+        if (buffers.erase(name) == 0) {
+            invalid(format("%u is not a buffer", name));
+            continue;
+        }
+
+        // Deleting unbinds from the context and from the bound vertex array only.
+        for (auto &binding : bufferBindings) {
+            binding.second = binding.second == name ? 0 : binding.second;
+        }
+        GLuint &element = bufferBinding(GL_ELEMENT_ARRAY_BUFFER);
+        element = element == name ? 0 : element;
+    }
+}
+
+void render::RecordingGlDispatch::bindBuffer(GLenum target, GLuint buffer) {
+    record(format("glBindBuffer(%s, %u)", enumName(target).c_str(), buffer));
+    if (buffer != 0 && buffers.find(buffer) == buffers.end()) {
+        invalid(format("%u is not a buffer", buffer));
+        return;
+    }
+
+    GLuint &binding = bufferBinding(target);
+    if (binding == buffer) {
+        redundant(format("buffer %u is already bound to %s", buffer, enumName(target).c_str()));
+    }
+    binding = buffer;
+}
+
+void render::RecordingGlDispatch::bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    record(format("glBufferData(%s, %lld, %s, %s)", enumName(target).c_str(), static_cast<long long>(size),
+                  dataName(data, static_cast<size_t>(std::max<GLsizeiptr>(size, 0))).c_str(),
+                  enumName(usage).c_str()));
+    Buffer *buffer = boundBuffer(target);
+    if (buffer == nullptr) {
+        invalid("no buffer bound to " + enumName(target));
+        return;
+    }
+    if (size < 0) {
+        invalid("negative buffer size");
+        return;
+    }
+    buffer->size = size;
+}
+
+void render::RecordingGlDispatch::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    record(format("glBufferSubData(%s, %lld, %lld, %s)", enumName(target).c_str(), static_cast<long long>(offset),
+                  static_cast<long long>(size),
+                  dataName(data, static_cast<size_t>(std::max<GLsizeiptr>(size, 0))).c_str()));
+    Buffer *buffer = boundBuffer(target);
+    if (buffer == nullptr) {
+        invalid("no buffer bound to " + enumName(target));
+    } else if (buffer->size < 0) {
+        invalid(format("buffer %u has no storage", bufferBinding(target)));
+    } else if (offset < 0 || size < 0 || offset + size > buffer->size) {
+        invalid(format("writes past the end of buffer %u", bufferBinding(target)));
+    } else if (size == 0) {
+        redundant("writes nothing");
+    }
+}
+
+void render::RecordingGlDispatch::copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+                                                    GLintptr writeOffset, GLsizeiptr size) {
+    record(format("glCopyBufferSubData(%s, %s, %lld, %lld, %lld)", enumName(readTarget).c_str(),
+                  enumName(writeTarget).c_str(), static_cast<long long>(readOffset),
+                  static_cast<long long>(writeOffset), static_cast<long long>(size)));
+    Buffer *source = boundBuffer(readTarget);
+    Buffer *destination = boundBuffer(writeTarget);
+    if (source == nullptr || destination == nullptr) {
+        invalid("no buffer bound to " + enumName(source == nullptr ? readTarget : writeTarget));
+        return;
+    }
+    if (readOffset < 0 || writeOffset < 0 || size < 0 || readOffset + size > source->size ||
+        writeOffset + size > destination->size) {
+        invalid("copies outside a buffer's storage");
+    } else if (source == destination && readOffset < writeOffset + size && writeOffset < readOffset + size) {
+        invalid(format("overlapping copy within buffer %u", bufferBinding(readTarget)));
+    } else if (size == 0) {
+        redundant("copies nothing");
+    }
+}
+
+void render::RecordingGlDispatch::genVertexArrays(GLsizei count, GLuint *arrays) {
+    record(genNames("glGenVertexArrays", count, arrays));
+    for (GLsizei i = 0; i < count; ++i) {
+        vertexArrays[arrays[i]];
+    }
+}
+
+void render::RecordingGlDispatch::deleteVertexArrays(GLsizei count, const GLuint *arrays) {
+    record(format("glDeleteVertexArrays(%d, ", count) + namesList(count, arrays) + ")");
+    for (GLsizei i = 0; i < count; ++i) {
+        if (arrays[i] == 0) {
+            continue;
+        }
+        if (vertexArrays.erase(arrays[i]) == 0) {
+            invalid(format("%u is not a vertex array", arrays[i]));
+        } else if (arrays[i] == vertexArray) {
+            vertexArray = 0;
+        }
+    }
+}
+
+void render::RecordingGlDispatch::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                                      GLsizei stride, const void *pointer) {
+    record(format("glVertexAttribPointer(%u, %d, %s, %s, %d, %s)", index, size, enumName(type).c_str(),
+                  booleanName(normalized).c_str(), stride, offsetName(pointer).c_str()));
+    if (vertexArray == 0) {
+        invalid("no vertex array bound");
+    } else if (bufferBindings[GL_ARRAY_BUFFER] == 0) {
+        invalid("no buffer bound to GL_ARRAY_BUFFER");
+    } else if (index < 32) {
+        vertexArrays[vertexArray].configured |= 1u << index;
+    }
+}
+
+void render::RecordingGlDispatch::enableVertexAttribArray(GLuint index) {
+    record(format("glEnableVertexAttribArray(%u)", index));
+    if (vertexArray == 0) {
+        invalid("no vertex array bound");
+        return;
+    }
+
+    VertexArray &vao = vertexArrays[vertexArray];
+    if (index < 32 && (vao.enabled & (1u << index))) {
+        redundant(format("attribute %u is already enabled", index));
+    }
+    vao.enabled |= index < 32 ? 1u << index : 0;
+}
+
+void render::RecordingGlDispatch::vertexAttribDivisor(GLuint index, GLuint divisor) {
+    record(format("glVertexAttribDivisor(%u, %u)", index, divisor));
+    if (vertexArray == 0) {
+        invalid("no vertex array bound");
+    }
+}
+
+GLuint render::RecordingGlDispatch::createShader(GLenum stage) {
+    GLuint name = ++lastName;
+    record(format("glCreateShader(%s) -> %u", enumName(stage).c_str(), name));
+    shaders[name].stage = stage;
+    return name;
+}
+
+void render::RecordingGlDispatch::shaderSource(GLuint shader, GLsizei count, const GLchar *const *strings,
+                                               const GLint *lengths) {
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i) {
+        if (lengths != nullptr && lengths[i] >= 0) {
+            source.append(strings[i], static_cast<size_t>(lengths[i]));
+        } else {
+            source.append(strings[i]);
+        }
+    }
+
+    record(format("glShaderSource(%u, %d, %s)", shader, count, dataName(source.data(), source.size()).c_str()));
+    auto entry = shaders.find(shader);
+    if (entry == shaders.end()) {
+        invalid(format("%u is not a shader", shader));
+        return;
+    }
+    entry->second.source = std::move(source);
+}
+
+void render::RecordingGlDispatch::compileShader(GLuint shader) {
+    record(format("glCompileShader(%u)", shader));
+    auto entry = shaders.find(shader);
+    if (entry == shaders.end()) {
+        invalid(format("%u is not a shader", shader));
+        return;
+    }
+
+    size_t error = entry->second.source.find("#error");
+    entry->second.compiled = error == std::string::npos;
+    entry->second.log.clear();
+    if (!entry->second.compiled) {
+        size_t end = entry->second.source.find('\n', error);
+        entry->second.log = "ERROR: " + entry->second.source.substr(error, end - error) + "\n";
+    }
+}
+
+void render::RecordingGlDispatch::getShaderiv(GLuint shader, GLenum name, GLint *value) {
+    auto entry = shaders.find(shader);
+    bool known = true;
+    *value = 0;
+    if (entry != shaders.end()) {
+        if (name == GL_COMPILE_STATUS) {
+            *value = entry->second.compiled ? GL_TRUE : GL_FALSE;
+        } else if (name == GL_INFO_LOG_LENGTH) {
+            *value = entry->second.log.empty() ? 0 : static_cast<GLint>(entry->second.log.size() + 1);
+        } else if (name == GL_SHADER_TYPE) {
+            *value = static_cast<GLint>(entry->second.stage);
+        } else {
+            known = false;
+        }
+    }
+
+    record(format("glGetShaderiv(%u, %s) -> %d", shader, enumName(name).c_str(), *value));
+    if (entry == shaders.end()) {
+        invalid(format("%u is not a shader", shader));
+    } else if (!known) {
+        invalid(enumName(name) + " is not supported");
+    }
+}
+
+void render::RecordingGlDispatch::getShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log) {
+    record(format("glGetShaderInfoLog(%u, %d)", shader, size));
+    auto entry = shaders.find(shader);
+    std::string text;
+    if (entry == shaders.end()) {
+        invalid(format("%u is not a shader", shader));
+    } else {
+        text = entry->second.log;
+    }
+
+    GLsizei copied = size > 0 ? std::min(static_cast<GLsizei>(text.size()), size - 1) : 0;
+    if (size > 0) {
+        std::memcpy(log, text.data(), static_cast<size_t>(copied));
+        log[copied] = '\0';
+    }
+    if (length != nullptr) {
+        *length = copied;
+    }
+}
+
+void render::RecordingGlDispatch::deleteShader(GLuint shader) {
+    record(format("glDeleteShader(%u)", shader));
+    if (shader != 0 && shaders.erase(shader) == 0) {
+        invalid(format("%u is not a shader", shader));
+    }
+}
+
+GLuint render::RecordingGlDispatch::createProgram() {
+    GLuint name = ++lastName;
+    record(format("glCreateProgram() -> %u", name));
+    programs[name];
+    return name;
+}
+
+void render::RecordingGlDispatch::attachShader(GLuint name, GLuint shader) {
+    record(format("glAttachShader(%u, %u)", name, shader));
+    Program *entry = findProgram(name);
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (shaders.find(shader) == shaders.end()) {
+        invalid(format("%u is not a shader", shader));
+    } else if (!entry->attached.insert(shader).second) {
+        invalid(format("shader %u is already attached to program %u", shader, name));
+    }
+}
+
+void render::RecordingGlDispatch::detachShader(GLuint name, GLuint shader) {
+    record(format("glDetachShader(%u, %u)", name, shader));
+    Program *entry = findProgram(name);
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (entry->attached.erase(shader) == 0) {
+        invalid(format("shader %u is not attached to program %u", shader, name));
+    }
+}
+
+void render::RecordingGlDispatch::linkProgram(GLuint name) {
+    record(format("glLinkProgram(%u)", name));
+    Program *entry = findProgram(name);
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+        return;
+    }
+
+    // A failed link is reported through GL_LINK_STATUS, as a driver would.
+    bool vertex = false;
+    bool fragment = false;
+    entry->log.clear();
+    for (GLuint shader : entry->attached) {
+        auto attached = shaders.find(shader);
+        if (attached == shaders.end() || !attached->second.compiled) {
+            entry->log += format("ERROR: shader %u is not compiled\n", shader);
+            continue;
+        }
+        vertex |= attached->second.stage == GL_VERTEX_SHADER;
+        fragment |= attached->second.stage == GL_FRAGMENT_SHADER;
+    }
+    if (!vertex || !fragment) {
+        entry->log += vertex ? "ERROR: no fragment shader\n" : "ERROR: no vertex shader\n";
+    }
+
+    entry->linked = entry->log.empty();
+    entry->locations.clear();
+    entry->uniforms.clear();
+}
+
+void render::RecordingGlDispatch::getProgramiv(GLuint name, GLenum parameter, GLint *value) {
+    Program *entry = findProgram(name);
+    bool known = true;
+    *value = 0;
+    if (entry != nullptr) {
+        if (parameter == GL_LINK_STATUS) {
+            *value = entry->linked ? GL_TRUE : GL_FALSE;
+        } else if (parameter == GL_INFO_LOG_LENGTH) {
+            *value = entry->log.empty() ? 0 : static_cast<GLint>(entry->log.size() + 1);
+        } else if (parameter == GL_ATTACHED_SHADERS) {
+            *value = static_cast<GLint>(entry->attached.size());
+        } else if (parameter == GL_PROGRAM_BINARY_LENGTH) {
+            *value = binarySupport && entry->linked ? static_cast<GLint>(sizeof(FakeBinary)) : 0;
+        } else {
+            known = false;
+        }
+    }
+
+    record(format("glGetProgramiv(%u, %s) -> %d", name, enumName(parameter).c_str(), *value));
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (!known) {
+        invalid(enumName(parameter) + " is not supported");
+    }
+}
+
+void render::RecordingGlDispatch::getProgramInfoLog(GLuint name, GLsizei size, GLsizei *length, GLchar *log) {
+    record(format("glGetProgramInfoLog(%u, %d)", name, size));
+    Program *entry = findProgram(name);
+    std::string text;
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else {
+        text = entry->log;
+    }
+
+    GLsizei copied = size > 0 ? std::min(static_cast<GLsizei>(text.size()), size - 1) : 0;
+    if (size > 0) {
+        std::memcpy(log, text.data(), static_cast<size_t>(copied));
+        log[copied] = '\0';
+    }
+    if (length != nullptr) {
+        *length = copied;
+    }
+}
+
+void render::RecordingGlDispatch::deleteProgram(GLuint name) {
+    record(format("glDeleteProgram(%u)", name));
+    if (name == 0) {
+        return;
+    }
+
+    Program *entry = findProgram(name);
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (name == program) {
+        entry->deleted = true;
+    } else {
+        programs.erase(name);
+    }
+}
+
+void render::RecordingGlDispatch::programParameteri(GLuint name, GLenum parameter, GLint value) {
+    record(format("glProgramParameteri(%u, %s, %d)", name, enumName(parameter).c_str(), value));
+    if (findProgram(name) == nullptr) {
+        invalid(format("%u is not a program", name));
+    }
+}
+
+void render::RecordingGlDispatch::getProgramBinary(GLuint name, GLsizei size, GLsizei *length, GLenum *binaryFormat,
+                                                   void *binary) {
+    record(format("glGetProgramBinary(%u, %d)", name, size));
+    Program *entry = findProgram(name);
+    *length = 0;
+    *binaryFormat = 0;
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (!binarySupport || !entry->linked) {
+        invalid(format("program %u has no binary", name));
+    } else if (size < static_cast<GLsizei>(sizeof(FakeBinary))) {
+        invalid("binary buffer too small");
+    } else {
+        std::memcpy(binary, FakeBinary, sizeof(FakeBinary));
+        *length = static_cast<GLsizei>(sizeof(FakeBinary));
+        *binaryFormat = FakeBinaryFormat;
+    }
+}
+
+void render::RecordingGlDispatch::programBinary(GLuint name, GLenum binaryFormat, const void *binary,
+                                                GLsizei length) {
+    record(format("glProgramBinary(%u, %s, %s, %d)", name, enumName(binaryFormat).c_str(),
+                  dataName(binary, static_cast<size_t>(std::max(length, 0))).c_str(), length));
+    Program *entry = findProgram(name);
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+        return;
+    }
+    if (!binarySupport) {
+        invalid("no program binary formats");
+    }
+
+    // Drivers reject binaries through GL_LINK_STATUS rather than an error.
+    entry->linked = binarySupport && binaryFormat == FakeBinaryFormat && length == sizeof(FakeBinary) &&
+                    std::memcmp(binary, FakeBinary, sizeof(FakeBinary)) == 0;
+    entry->log = entry->linked ? "" : "ERROR: binary rejected\n";
+    entry->locations.clear();
+    entry->uniforms.clear();
+}
+
+GLint render::RecordingGlDispatch::getUniformLocation(GLuint name, const GLchar *uniform) {
+    Program *entry = findProgram(name);
+    GLint location = -1;
+    if (entry != nullptr && entry->linked) {
+        location = entry->locations.emplace(uniform, static_cast<GLint>(entry->locations.size())).first->second;
+    }
+
+    record(format("glGetUniformLocation(%u, \"%s\") -> %d", name, uniform, location));
+    if (entry == nullptr) {
+        invalid(format("%u is not a program", name));
+    } else if (!entry->linked) {
+        invalid(format("program %u is not linked", name));
+    }
+    return location;
+}
+
+void render::RecordingGlDispatch::genTextures(GLsizei count, GLuint *names) {
+    record(genNames("glGenTextures", count, names));
+    for (GLsizei i = 0; i < count; ++i) {
+        textures[names[i]];
+    }
+}
+
+void render::RecordingGlDispatch::deleteTextures(GLsizei count, const GLuint *names) {
+    record(format("glDeleteTextures(%d, ", count) + namesList(count, names) + ")");
+    for (GLsizei i = 0; i < count; ++i) {
+        if (names[i] == 0) {
+            continue;
+        }
+        if (textures.erase(names[i]) == 0) {
+            invalid(format("%u is not a texture", names[i]));
+            continue;
+        }
+        for (auto &binding : textureBindings) {
+            binding.second = binding.second == names[i] ? 0 : binding.second;
+        }
+    }
+}
+
+void render::RecordingGlDispatch::bindTexture(GLenum target, GLuint texture) {
+    record(format("glBindTexture(%s, %u)", enumName(target).c_str(), texture));
+    if (texture != 0) {
+        auto entry = textures.find(texture);
+        if (entry == textures.end()) {
+            invalid(format("%u is not a texture", texture));
+            return;
+        }
+        if (entry->second.target != 0 && entry->second.target != target) {
+            invalid(format("texture %u was created as %s", texture, enumName(entry->second.target).c_str()));
+            return;
+        }
+        entry->second.target = target;
+    }
+
+    GLuint &binding = textureBindings[target];
+    if (binding == texture) {
+        redundant(format("texture %u is already bound to %s", texture, enumName(target).c_str()));
+    }
+    binding = texture;
+}
+
+void render::RecordingGlDispatch::setTextureLevel(GLenum target, GLint level, GLsizei width, GLsizei height) {
+    Texture *texture = boundTexture(target);
+    if (texture == nullptr) {
+        invalid("no texture bound to " + enumName(target));
+    } else if (level < 0 || width < 0 || height < 0) {
+        invalid("negative level or size");
+    } else {
+        texture->levels[level] = {width, height};
+    }
+}
+
+void render::RecordingGlDispatch::checkTextureRegion(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                                     GLsizei height) {
+    Texture *texture = boundTexture(target);
+    if (texture == nullptr) {
+        invalid("no texture bound to " + enumName(target));
+        return;
+    }
+
+    GLuint name = textureBindings[target];
+    auto size = texture->levels.find(level);
+    if (size == texture->levels.end()) {
+        invalid(format("level %d of texture %u has no storage", level, name));
+    } else if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > size->second.first ||
+               y + height > size->second.second) {
+        invalid(format("writes outside level %d of texture %u", level, name));
+    } else if (width == 0 || height == 0) {
+        redundant("writes nothing");
+    }
+}
+
+void render::RecordingGlDispatch::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width,
+                                             GLsizei height, GLint border, GLenum pixelFormat, GLenum type,
+                                             const void *pixels) {
+    size_t bytes = pixelBytes(pixelFormat, type, width, height, pixelStore[GL_UNPACK_ALIGNMENT]);
+    record(format("glTexImage2D(%s, %d, %s, %d, %d, %d, %s, %s, %s)", enumName(target).c_str(), level,
+                  enumName(static_cast<GLenum>(internalFormat)).c_str(), width, height, border,
+                  enumName(pixelFormat).c_str(), enumName(type).c_str(),
+                  (pixels != nullptr && bytes == 0 ? std::string("data") : dataName(pixels, bytes)).c_str()));
+    if (border != 0) {
+        invalid("border must be 0");
+    }
+    setTextureLevel(target, level, width, height);
+}
+
+void render::RecordingGlDispatch::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                                GLsizei height, GLenum pixelFormat, GLenum type, const void *pixels) {
+    size_t bytes = pixelBytes(pixelFormat, type, width, height, pixelStore[GL_UNPACK_ALIGNMENT]);
+    record(format("glTexSubImage2D(%s, %d, %d, %d, %d, %d, %s, %s, %s)", enumName(target).c_str(), level, x, y,
+                  width, height, enumName(pixelFormat).c_str(), enumName(type).c_str(),
+                  (pixels != nullptr && bytes == 0 ? std::string("data") : dataName(pixels, bytes)).c_str()));
+    checkTextureRegion(target, level, x, y, width, height);
+}
+
+void render::RecordingGlDispatch::compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat,
+                                                       GLsizei width, GLsizei height, GLint border, GLsizei size,
+                                                       const void *data) {
+    record(format("glCompressedTexImage2D(%s, %d, %s, %d, %d, %d, %d, %s)", enumName(target).c_str(), level,
+                  enumName(internalFormat).c_str(), width, height, border, size,
+                  dataName(data, static_cast<size_t>(std::max(size, 0))).c_str()));
+    if (border != 0) {
+        invalid("border must be 0");
+    }
+    setTextureLevel(target, level, width, height);
+}
+
+void render::RecordingGlDispatch::compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                                          GLsizei height, GLenum dataFormat, GLsizei size,
+                                                          const void *data) {
+    record(format("glCompressedTexSubImage2D(%s, %d, %d, %d, %d, %d, %s, %d, %s)", enumName(target).c_str(), level,
+                  x, y, width, height, enumName(dataFormat).c_str(), size,
+                  dataName(data, static_cast<size_t>(std::max(size, 0))).c_str()));
+    checkTextureRegion(target, level, x, y, width, height);
+}
+
+void render::RecordingGlDispatch::texParameteri(GLenum target, GLenum name, GLint value) {
+    std::string valueName = isEnumParameter(name) ? enumName(static_cast<GLenum>(value)) : std::to_string(value);
+    record(format("glTexParameteri(%s, %s, %s)", enumName(target).c_str(), enumName(name).c_str(),
+                  valueName.c_str()));
+    Texture *texture = boundTexture(target);
+    if (texture == nullptr) {
+        invalid("no texture bound to " + enumName(target));
+        return;
+    }
+
+    auto current = texture->parameters.find(name);
+    if (current != texture->parameters.end() && current->second == value) {
+        redundant(format("%s of texture %u is unchanged", enumName(name).c_str(), textureBindings[target]));
+    }
+    texture->parameters[name] = value;
+}
+
+void render::RecordingGlDispatch::pixelStorei(GLenum name, GLint value) {
+    record(format("glPixelStorei(%s, %d)", enumName(name).c_str(), value));
+    auto current = pixelStore.find(name);
+    if (current != pixelStore.end() && current->second == value) {
+        redundant(enumName(name) + " is unchanged");
+    }
+    pixelStore[name] = value;
+}
+
+void render::RecordingGlDispatch::genQueries(GLsizei count, GLuint *names) {
+    record(genNames("glGenQueries", count, names));
+    for (GLsizei i = 0; i < count; ++i) {
+        queries[names[i]];
+    }
+}
+
+void render::RecordingGlDispatch::deleteQueries(GLsizei count, const GLuint *names) {
+    record(format("glDeleteQueries(%d, ", count) + namesList(count, names) + ")");
+    for (GLsizei i = 0; i < count; ++i) {
+        if (names[i] == 0) {
+            continue;
+        }
+        auto query = queries.find(names[i]);
+        if (query == queries.end()) {
+            invalid(format("%u is not a query", names[i]));
+            continue;
+        }
+        // Deleting an active query ends it.
+        if (query->second.active) {
+            activeQueries[query->second.target] = 0;
+        }
+        queries.erase(query);
+    }
+}
+
+void render::RecordingGlDispatch::beginQuery(GLenum target, GLuint query) {
+    record(format("glBeginQuery(%s, %u)", enumName(target).c_str(), query));
+    auto entry = queries.find(query);
+    if (entry == queries.end()) {
+        invalid(format("%u is not a query", query));
+    } else if (activeQueries[target] != 0) {
+        invalid("a " + enumName(target) + " query is already active");
+    } else if (entry->second.target != 0 && entry->second.target != target) {
+        invalid(format("query %u was used as %s", query, enumName(entry->second.target).c_str()));
+    } else {
+        entry->second.target = target;
+        entry->second.active = true;
+        activeQueries[target] = query;
+    }
+}
+
+void render::RecordingGlDispatch::endQuery(GLenum target) {
+    record("glEndQuery(" + enumName(target) + ")");
+    GLuint &active = activeQueries[target];
+    if (active == 0) {
+        invalid("no " + enumName(target) + " query is active");
+        return;
+    }
+    queries[active].active = false;
+    active = 0;
+}
+
+GLuint64 render::RecordingGlDispatch::queryResult(const char *function, GLuint query, GLenum name) {
+    auto entry = queries.find(query);
+    GLuint64 value = name == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    record(format("%s(%u, %s) -> %llu", function, query, enumName(name).c_str(),
+                  static_cast<unsigned long long>(value)));
+    if (entry == queries.end()) {
+        invalid(format("%u is not a query", query));
+    } else if (entry->second.target == 0) {
+        invalid(format("query %u was never begun", query));
+    } else if (entry->second.active) {
+        invalid(format("query %u is still active", query));
+    } else if (name != GL_QUERY_RESULT && name != GL_QUERY_RESULT_AVAILABLE) {
+        invalid(enumName(name) + " is not supported");
+    }
+    return value;
+}
+
+void render::RecordingGlDispatch::getQueryObjectiv(GLuint query, GLenum name, GLint *value) {
+    *value = static_cast<GLint>(queryResult("glGetQueryObjectiv", query, name));
+}
+
+void render::RecordingGlDispatch::getQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value) {
+    *value = queryResult("glGetQueryObjectui64v", query, name);
+}
+
+void render::RecordingGlDispatch::getIntegerv(GLenum name, GLint *value) {
+    bool known = true;
+    if (name == GL_NUM_EXTENSIONS) {
+        *value = static_cast<GLint>(extensions.size());
+    } else if (name == GL_NUM_PROGRAM_BINARY_FORMATS) {
+        *value = binarySupport ? 1 : 0;
+    } else {
+        *value = 0;
+        known = false;
+    }
+
+    record(format("glGetIntegerv(%s) -> %d", enumName(name).c_str(), *value));
+    if (!known) {
+        invalid(enumName(name) + " is not supported");
+    }
+}
+
+const GLubyte *render::RecordingGlDispatch::getString(GLenum name) {
+    record("glGetString(" + enumName(name) + ")");
+    const char *value = nullptr;
+    switch (name) {
+        case GL_VENDOR:
+            value = "Recording";
+            break;
+        case GL_RENDERER:
+            value = "RecordingGlDispatch";
+            break;
+        case GL_VERSION:
+            value = "3.3.0 Recording";
+            break;
+        default:
+            invalid(enumName(name) + " is not supported");
+            break;
+    }
+    return reinterpret_cast<const GLubyte *>(value);
+}
+
+const GLubyte *render::RecordingGlDispatch::getStringi(GLenum name, GLuint index) {
+    record(format("glGetStringi(%s, %u)", enumName(name).c_str(), index));
+    if (name != GL_EXTENSIONS || index >= extensions.size()) {
+        invalid("no string " + enumName(name) + format(" %u", index));
+        return nullptr;
+    }
+    return reinterpret_cast<const GLubyte *>(extensions[index].c_str());
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GlDispatch.h"
+
+namespace render {
+    // A GL stand-in for tests and benchmarks on machines without a GPU. Every
+    // call is written as one line of text, and enough of GL's state is kept to
+    // check the stream as it goes: calls that change nothing (binding what is
+    // already bound, setting a uniform to its current value) are reported as
+    // redundant, and calls a real context would reject or that would read
+    // outside an object (drawing without a program or element buffer, writing
+    // past a buffer's storage, using a deleted name) as invalid.
+    //
+    // Object names count up from 1 across all object kinds, so a stream is the
+    // same from run to run. Shaders compile unless their source contains
+    // #error, programs link when they have a compiled shader of each stage,
+    // uniform locations are handed out in the order they are asked for and
+    // every query result is available at once and reads 0.
+    class RecordingGlDispatch : public GlDispatch {
+    public:
+        enum class IssueType : uint8_t {
+            Redundant,
+            Invalid
+        };
+
+        struct Issue {
+            IssueType type;
+            size_t call;          // index into getCalls()
+            std::string message;
+        };
+
+        // What getStringi(GL_EXTENSIONS) reports; none by default.
+        void setExtensions(std::vector<std::string> extensions) { this->extensions = std::move(extensions); }
+        // Reports one program binary format, and binaries read back from a
+        // linked program load as linked programs.
+        void setProgramBinarySupport(bool supported) { binarySupport = supported; }
+
+        const std::vector<std::string> &getCalls() const { return calls; }
+        const std::vector<Issue> &getIssues() const { return issues; }
+        size_t countIssues(IssueType type) const;
+        // Draw calls of any kind; a multi-draw counts once.
+        size_t getDrawCalls() const { return drawCalls; }
+        // Buffers, vertex arrays, shaders, programs, textures and queries not yet deleted.
+        size_t getLiveObjectCount() const;
+
+        // The calls one per line, each followed by its issues; what golden
+        // files hold.
+        std::string getLog() const;
+        // Forgets the calls and issues but keeps the GL state, so a test can
+        // record one frame after its setup.
+        void clearLog();
+
+        void useProgram(GLuint program) override;
+        void bindVertexArray(GLuint vao) override;
+        void uniform1f(GLint location, GLfloat x) override;
+        void uniform2f(GLint location, GLfloat x, GLfloat y) override;
+        void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) override;
+        void drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) override;
+        void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                   GLsizei instanceCount) override;
+        void multiDrawElements(GLenum mode, const GLsizei *counts, GLenum type, const void *const *indices,
+                               GLsizei drawCount) override;
+        void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                    GLint baseVertex) override;
+        void drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                             GLsizei instanceCount, GLint baseVertex) override;
+        void multiDrawElementsBaseVertex(GLenum mode, const GLsizei *counts, GLenum type, const void *const *indices,
+                                         GLsizei drawCount, const GLint *baseVertices) override;
+        void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) override;
+        void enable(GLenum capability) override;
+        void disable(GLenum capability) override;
+        void blendFunc(GLenum sourceFactor, GLenum destinationFactor) override;
+        void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+        void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) override;
+        void clear(GLbitfield mask) override;
+
+        void genBuffers(GLsizei count, GLuint *buffers) override;
+        void deleteBuffers(GLsizei count, const GLuint *buffers) override;
+        void bindBuffer(GLenum target, GLuint buffer) override;
+        void bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) override;
+        void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) override;
+        void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+                               GLsizeiptr size) override;
+        void genVertexArrays(GLsizei count, GLuint *arrays) override;
+        void deleteVertexArrays(GLsizei count, const GLuint *arrays) override;
+        void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                                 const void *pointer) override;
+        void enableVertexAttribArray(GLuint index) override;
+        void vertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+        GLuint createShader(GLenum stage) override;
+        void shaderSource(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths) override;
+        void compileShader(GLuint shader) override;
+        void getShaderiv(GLuint shader, GLenum name, GLint *value) override;
+        void getShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log) override;
+        void deleteShader(GLuint shader) override;
+        GLuint createProgram() override;
+        void attachShader(GLuint program, GLuint shader) override;
+        void detachShader(GLuint program, GLuint shader) override;
+        void linkProgram(GLuint program) override;
+        void getProgramiv(GLuint program, GLenum name, GLint *value) override;
+        void getProgramInfoLog(GLuint program, GLsizei size, GLsizei *length, GLchar *log) override;
+        void deleteProgram(GLuint program) override;
+        void programParameteri(GLuint program, GLenum name, GLint value) override;
+        void getProgramBinary(GLuint program, GLsizei size, GLsizei *length, GLenum *format, void *binary) override;
+        void programBinary(GLuint program, GLenum format, const void *binary, GLsizei length) override;
+        GLint getUniformLocation(GLuint program, const GLchar *name) override;
+
+        void genTextures(GLsizei count, GLuint *textures) override;
+        void deleteTextures(GLsizei count, const GLuint *textures) override;
+        void bindTexture(GLenum target, GLuint texture) override;
+        void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                        GLenum format, GLenum type, const void *pixels) override;
+        void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
+                           GLenum type, const void *pixels) override;
+        void compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                  GLint border, GLsizei size, const void *data) override;
+        void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                     GLenum format, GLsizei size, const void *data) override;
+        void texParameteri(GLenum target, GLenum name, GLint value) override;
+        void pixelStorei(GLenum name, GLint value) override;
+
+        void genQueries(GLsizei count, GLuint *queries) override;
+        void deleteQueries(GLsizei count, const GLuint *queries) override;
+        void beginQuery(GLenum target, GLuint query) override;
+        void endQuery(GLenum target) override;
+        void getQueryObjectiv(GLuint query, GLenum name, GLint *value) override;
+        void getQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value) override;
+
+        void getIntegerv(GLenum name, GLint *value) override;
+        const GLubyte *getString(GLenum name) override;
+        const GLubyte *getStringi(GLenum name, GLuint index) override;
+
+    private:
+        struct Buffer {
+            GLsizeiptr size = -1;   // no storage until bufferData
+        };
+
+        struct VertexArray {
+            GLuint elementBuffer = 0;
+            uint32_t enabled = 0;      // attribute bits
+            uint32_t configured = 0;   // attributes given a pointer
+        };
+
+        struct Shader {
+            GLenum stage;
+            std::string source;
+            bool compiled = false;
+            std::string log;
+        };
+
+        struct UniformValue {
+            int components;
+            GLfloat value[4];
+        };
+
+        struct Program {
+            std::set<GLuint> attached;
+            bool linked = false;
+            bool deleted = false;      // deleteProgram while in use defers until unbound
+            std::string log;
+            std::map<std::string, GLint> locations;
+            std::map<GLint, UniformValue> uniforms;
+        };
+
+        struct Texture {
+            GLenum target = 0;         // fixed by the first bind
+            std::map<GLint, std::pair<GLsizei, GLsizei>> levels;
+            std::map<GLenum, GLint> parameters;
+        };
+
+        struct Query {
+            GLenum target = 0;         // 0 until first begun
+            bool active = false;
+        };
+
+        void record(std::string call);
+        void redundant(std::string message);
+        void invalid(std::string message);
+
+        std::string genNames(const char *function, GLsizei count, GLuint *names);
+        GLuint &bufferBinding(GLenum target);
+        Buffer *boundBuffer(GLenum target);
+        Program *findProgram(GLuint program);
+        Texture *boundTexture(GLenum target);
+        void setUniform(GLint location, int components, const GLfloat *value);
+        void checkDraw(GLsizei count, GLsizei instanceCount);
+        void checkIndices(GLsizei count, GLenum type, const void *indices);
+        void setCapability(GLenum capability, bool enabled);
+        void setTextureLevel(GLenum target, GLint level, GLsizei width, GLsizei height);
+        void checkTextureRegion(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height);
+        GLuint64 queryResult(const char *function, GLuint query, GLenum name);
+
+        std::vector<std::string> calls;
+        std::vector<Issue> issues;
+        size_t drawCalls = 0;
+
+        std::vector<std::string> extensions;
+        bool binarySupport = false;
+        GLuint lastName = 0;
+
+        std::unordered_map<GLuint, Buffer> buffers;
+        std::unordered_map<GLuint, VertexArray> vertexArrays;
+        std::unordered_map<GLuint, Shader> shaders;
+        std::unordered_map<GLuint, Program> programs;
+        std::unordered_map<GLuint, Texture> textures;
+        std::unordered_map<GLuint, Query> queries;
+
+        GLuint program = 0;
+        GLuint vertexArray = 0;
+        GLuint elementBufferWithoutVao = 0;
+        std::map<GLenum, GLuint> bufferBindings;
+        std::map<GLenum, GLuint> textureBindings;
+        std::map<GLenum, GLuint> activeQueries;
+        std::set<GLenum> capabilities;
+        std::map<GLenum, GLint> pixelStore = {{GL_PACK_ALIGNMENT, 4}, {GL_UNPACK_ALIGNMENT, 4}};
+        GLenum blendSource = GL_ONE;
+        GLenum blendDestination = GL_ZERO;
+        bool viewportSet = false;
+        GLint viewportRect[4] = {0, 0, 0, 0};
+        GLfloat clearValue[4] = {0.f, 0.f, 0.f, 0.f};
+    };
+}
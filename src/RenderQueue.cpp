@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "Profiler.h"
+#include "RenderQueue.h"
+
+namespace {
+    const GLuint UnknownBinding = std::numeric_limits<GLuint>::max();
+    const int RadixBits = 8;
+    const int RadixPasses = 64 / RadixBits;
+    const size_t RadixBuckets = size_t(1) << RadixBits;
+}
+
+render::RenderQueue::RenderQueue(GlDispatch &gl) : gl(gl) {
+    invalidateState();
+}
+
+render::ProgramId render::RenderQueue::addProgram(GLuint program) {
+    if (programs.size() >= MaxPrograms) {
+        throw std::runtime_error("Too many programs registered in render queue");
+    }
+
+    programs.push_back(program);
+    return static_cast<ProgramId>(programs.size() - 1);
+}
+
+void render::RenderQueue::setProgram(ProgramId id, GLuint program) {
+    programs.at(id) = program;
+    // A new program starts with default uniform values.
+    invalidateState();
+}
+
+render::VertexArrayId render::RenderQueue::addVertexArray(GLuint vao) {
+    if (vertexArrays.size() >= MaxVertexArrays) {
+        throw std::runtime_error("Too many vertex arrays registered in render queue");
+    }
+
+    vertexArrays.push_back(vao);
+    return static_cast<VertexArrayId>(vertexArrays.size() - 1);
+}
+
+render::MaterialId render::RenderQueue::addMaterial(Material material) {
+    if (materials.size() >= MaxMaterials) {
+        throw std::runtime_error("Too many materials registered in render queue");
+    }
+
+    materials.push_back(std::move(material));
+    return static_cast<MaterialId>(materials.size() - 1);
+}
+
+void render::RenderQueue::submit(const DrawItem &item) {
+    keys.push_back(makeKey(item));
+    items.push_back(item);
+}
+
+void render::RenderQueue::invalidateState() {
+    invalidateBindings();
+    uniformCache.clear();
+}
+
+void render::RenderQueue::invalidateBindings() {
+    boundProgram = UnknownBinding;
+    boundVertexArray = UnknownBinding;
+}
+
+uint64_t render::RenderQueue::makeKey(const DrawItem &item) {
+    // layer:8 | program:8 | vertex array:12 | material:12 | depth:24
+    auto depth = static_cast<uint64_t>(std::min(std::max(item.depth, 0.f), 1.f) * 0xFFFFFF);
+
+    return uint64_t(item.layer) << 56 |
+           uint64_t(item.program & 0xFF) << 48 |
+           uint64_t(item.vertexArray & 0xFFF) << 36 |
+           uint64_t(item.material & 0xFFF) << 24 |
+           depth;
+}
+
+void render::RenderQueue::sortKeys() {
+    size_t count = keys.size();
+
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<size_t> histograms(RadixPasses * RadixBuckets, 0);
+    for (uint64_t key : keys) {
+        for (int pass = 0; pass < RadixPasses; ++pass) {
+            ++histograms[pass * RadixBuckets + ((key >> (pass * RadixBits)) & (RadixBuckets - 1))];
+        }
+    }
+
+    scratchKeys.resize(count);
+    scratchOrder.resize(count);
+
+    for (int pass = 0; pass < RadixPasses; ++pass) {
+        size_t *histogram = histograms.data() + pass * RadixBuckets;
+        int shift = pass * RadixBits;
+
+        // A pass where every key has the same digit would only copy the arrays.
+        if (histogram[(keys[0] >> shift) & (RadixBuckets - 1)] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RadixBuckets; ++bucket) {
+            size_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t destination = histogram[(keys[i] >> shift) & (RadixBuckets - 1)]++;
+            scratchKeys[destination] = keys[i];
+            scratchOrder[destination] = order[i];
+        }
+
+        keys.swap(scratchKeys);
+        order.swap(scratchOrder);
+    }
+}
+
+void render::RenderQueue::flush() {
+    PROFILE_SCOPE("RenderQueue::flush");
+    stats = Stats();
+    stats.submitted = items.size();
+
+    if (!items.empty()) {
+        sortKeys();
+
+        // Runs of equal state: everything in the key above the depth bits.
+        size_t begin = 0;
+        for (size_t i = 1; i <= keys.size(); ++i) {
+            if (i == keys.size() || (keys[i] >> 24) != (keys[begin] >> 24)) {
+                emitRun(begin, i);
+                begin = i;
+            }
+        }
+    }
+
+    items.clear();
+    keys.clear();
+}
+
+void render::RenderQueue::bindState(const DrawItem &item) {
+    GLuint program = programs[item.program];
+    if (program != boundProgram) {
+        gl.useProgram(program);
+        boundProgram = program;
+        ++stats.programBinds;
+    } else {
+        ++stats.skippedStateChanges;
+    }
+
+    GLuint vao = vertexArrays[item.vertexArray];
+    if (vao != boundVertexArray) {
+        gl.bindVertexArray(vao);
+        boundVertexArray = vao;
+        ++stats.vertexArrayBinds;
+    } else {
+        ++stats.skippedStateChanges;
+    }
+
+    // Materials can be edited between frames, so compare values rather than ids.
+    for (const auto &uniform : materials[item.material].uniforms) {
+        auto cacheKey = uint64_t(program) << 32 | static_cast<uint32_t>(uniform.location);
+        auto cached = uniformCache.find(cacheKey);
+        if (cached != uniformCache.end() && cached->second == uniform.value) {
+            ++stats.skippedStateChanges;
+            continue;
+        }
+        uniformCache[cacheKey] = uniform.value;
+
+        const auto &v = uniform.value;
+        switch (uniform.components) {
+            case 1:
+                gl.uniform1f(uniform.location, v.x);
+                break;
+            case 2:
+                gl.uniform2f(uniform.location, v.x, v.y);
+                break;
+            default:
+                gl.uniform4f(uniform.location, v.x, v.y, v.z, v.w);
+                break;
+        }
+        ++stats.uniformUploads;
+    }
+}
+
+void render::RenderQueue::emitRun(size_t begin, size_t end) {
+    bindState(items[order[begin]]);
+
+    // Same program, vertex array and material: the draws only differ by index
+    // range. Group a sorted copy of the run to find repeated ranges, then emit
+    // in the run's depth order: a repeated range is one instanced draw where
+    // its frontmost draw was, and the draws between become multi-draws.
+    runByRange.assign(order.begin() + begin, order.begin() + end);
+    std::sort(runByRange.begin(), runByRange.end(), [this](uint32_t left, uint32_t right) {
+        const auto &a = items[left];
+        const auto &b = items[right];
+        if (a.baseVertex != b.baseVertex) {
+            return a.baseVertex < b.baseVertex;
+        }
+        return a.firstIndex != b.firstIndex ? a.firstIndex < b.firstIndex : a.count < b.count;
+    });
+
+    rangeGroups.resize(items.size());
+    groupSizes.clear();
+    for (size_t i = 0; i < runByRange.size();) {
+        const auto &item = items[runByRange[i]];
+        size_t same = i + 1;
+        while (same < runByRange.size() && items[runByRange[same]].baseVertex == item.baseVertex &&
+               items[runByRange[same]].firstIndex == item.firstIndex && items[runByRange[same]].count == item.count) {
+            ++same;
+        }
+        for (size_t j = i; j < same; ++j) {
+            rangeGroups[runByRange[j]] = static_cast<uint32_t>(groupSizes.size());
+        }
+        groupSizes.push_back(static_cast<uint32_t>(same - i));
+        i = same;
+    }
+
+    multiCounts.clear();
+    multiOffsets.clear();
+    multiBaseVertices.clear();
+
+    for (size_t i = begin; i < end; ++i) {
+        const auto &item = items[order[i]];
+        uint32_t &instances = groupSizes[rangeGroups[order[i]]];
+        auto offset = reinterpret_cast<const void *>(sizeof(GLuint) * item.firstIndex);
+        if (instances == 1) {
+            multiCounts.push_back(item.count);
+            multiOffsets.push_back(offset);
+            multiBaseVertices.push_back(item.baseVertex);
+        } else if (instances > 1) {
+            emitMultiDraw();
+            gl.drawElementsInstancedBaseVertex(GL_TRIANGLES, item.count, GL_UNSIGNED_INT, offset,
+                                               static_cast<GLsizei>(instances), item.baseVertex);
+            ++stats.instancedDraws;
+            ++stats.drawCalls;
+            // The later draws of the range are covered by this one.
+            instances = 0;
+        }
+    }
+    emitMultiDraw();
+}
+
+void render::RenderQueue::emitMultiDraw() {
+    if (multiCounts.size() == 1) {
+        gl.drawElementsBaseVertex(GL_TRIANGLES, multiCounts[0], GL_UNSIGNED_INT, multiOffsets[0],
+                                  multiBaseVertices[0]);
+        ++stats.drawCalls;
+    } else if (multiCounts.size() > 1) {
+        gl.multiDrawElementsBaseVertex(GL_TRIANGLES, multiCounts.data(), GL_UNSIGNED_INT, multiOffsets.data(),
+                                       static_cast<GLsizei>(multiCounts.size()), multiBaseVertices.data());
+        ++stats.multiDraws;
+        ++stats.drawCalls;
+    }
+
+    multiCounts.clear();
+    multiOffsets.clear();
+    multiBaseVertices.clear();
+}
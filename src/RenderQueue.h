@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec4.hpp>
+#include "GlDispatch.h"
+
+namespace render {
+    using ProgramId = uint16_t;
+    using VertexArrayId = uint16_t;
+    using MaterialId = uint16_t;
+
+    struct Uniform {
+        GLint location;
+        int components; // 1, 2 or 4
+        glm::vec4 value;
+    };
+
+    // Uniform values uploaded whenever a draw with this material is emitted.
+    struct Material {
+        std::vector<Uniform> uniforms;
+    };
+
+    struct DrawItem {
+        ProgramId program = 0;
+        VertexArrayId vertexArray = 0;
+        MaterialId material = 0;
+        uint8_t layer = 0;   // drawn in ascending order before any state sorting
+        float depth = 0.f;   // [0, 1], front to back within equal state
+        GLsizei count = 0;
+        GLsizei firstIndex = 0;
+        GLint baseVertex = 0;
+    };
+
+    // Collects draws for a frame, radix-sorts them by a packed state key and emits
+    // the shortest GL call stream that reproduces them: binds and uniform uploads
+    // are skipped when the value is already current, repeated draws of the same
+    // range become one instanced draw and the other draws that share all state
+    // become multi-draws. Within equal state, draws stay in depth order, a
+    // repeated range drawn where its frontmost draw is.
+    //
+    // Bound state is kept across frames, so GL code that changes the program or
+    // vertex array binding outside the queue must call invalidateBindings(), and
+    // code that also sets these programs' uniforms must call invalidateState().
+    class RenderQueue {
+    public:
+        static constexpr uint16_t MaxPrograms = 1 << 8;
+        static constexpr uint16_t MaxVertexArrays = 1 << 12;
+        static constexpr uint16_t MaxMaterials = 1 << 12;
+
+        struct Stats {
+            size_t submitted = 0;
+            size_t programBinds = 0;
+            size_t vertexArrayBinds = 0;
+            size_t uniformUploads = 0;
+            size_t drawCalls = 0;
+            size_t instancedDraws = 0;
+            size_t multiDraws = 0;
+            size_t skippedStateChanges = 0;
+        };
+
+        explicit RenderQueue(GlDispatch &gl);
+
+        ProgramId addProgram(GLuint program);
+        // Replaces a registered program, e.g. after a shader reload.
+        void setProgram(ProgramId id, GLuint program);
+        VertexArrayId addVertexArray(GLuint vao);
+        MaterialId addMaterial(Material material);
+        Material &getMaterial(MaterialId material) { return materials[material]; }
+
+        void submit(const DrawItem &item);
+        void flush();
+
+        void invalidateState();
+        void invalidateBindings();
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        static uint64_t makeKey(const DrawItem &item);
+        void sortKeys();
+        void bindState(const DrawItem &item);
+        void emitRun(size_t begin, size_t end);
+        void emitMultiDraw();
+
+        GlDispatch &gl;
+        std::vector<GLuint> programs;
+        std::vector<GLuint> vertexArrays;
+        std::vector<Material> materials;
+
+        std::vector<DrawItem> items;
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> order;
+        std::vector<uint64_t> scratchKeys;
+        std::vector<uint32_t> scratchOrder;
+
+        std::vector<uint32_t> runByRange;
+        std::vector<uint32_t> rangeGroups;   // per item, while its run is emitted
+        std::vector<uint32_t> groupSizes;    // draws left to emit per range group
+
+        std::vector<GLsizei> multiCounts;
+        std::vector<const void *> multiOffsets;
+        std::vector<GLint> multiBaseVertices;
+
+        GLuint boundProgram = 0;
+        GLuint boundVertexArray = 0;
+        std::unordered_map<uint64_t, glm::vec4> uniformCache;
+
+        Stats stats;
+    };
+}
@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <stdexcept>
+#include "GeometryArena.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "RenderThread.h"
+#include "TextureUploader.h"
+
+namespace {
+    const render::MeshId DeadMesh = ~render::MeshId(0);
+
+    double percentile(const std::vector<double> &sorted, double fraction) {
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+    double toMilliseconds(timing::Nanoseconds duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+// GL objects of the render thread, created and destroyed on it.
+struct render::RenderThread::Backend {
+    Backend(GlDispatch &gl, RenderDevice::Programs programs)
+            : geometry(gl, sizeof(GLfloat) * 2, {{0, 2, GL_FLOAT, GL_FALSE, 0}}),
+              queue(gl),
+              shapes(gl),
+              uploader(gl),
+              programs(programs),
+              gl(gl) {
+        flatProgram = queue.addProgram(programs.flat);
+        sceneVao = queue.addVertexArray(geometry.getVertexArray());
+        shapes.setProgram(programs.shape, programs.shapeViewport);
+    }
+
+    ~Backend() {
+        if (!textures.empty()) {
+            // Destroyed handles hold 0, which glDeleteTextures skips.
+            gl.deleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+        }
+        for (const auto &buffers : packedBuffers) {
+            GLuint objects[] = {buffers.vertexBuffer, buffers.indexBuffer};
+            gl.deleteVertexArrays(1, &buffers.vertexArray);
+            gl.deleteBuffers(2, objects);
+        }
+    }
+
+    void applyPrograms() {
+        queue.setProgram(flatProgram, programs.flat);
+        for (MaterialId material : materials) {
+            queue.getMaterial(material).uniforms[0].location = programs.flatColor;
+        }
+        shapes.setProgram(programs.shape, programs.shapeViewport);
+    }
+
+    GeometryArena geometry;
+    RenderQueue queue;
+    ShapeBatcher shapes;
+    textures::TextureUploader uploader;
+    RenderDevice::Programs programs;
+    ProgramId flatProgram;
+    VertexArrayId sceneVao;
+    GlDispatch &gl;
+
+    // Indexed by handle.
+    std::vector<MeshId> meshes;
+    std::vector<MaterialId> materials;
+    std::vector<GLuint> textures;
+    std::vector<std::shared_ptr<const meshes::MeshFile>> packedMeshes;
+    std::vector<meshes::MeshBuffers> packedBuffers;
+
+    size_t uploadedBefore = 0;
+    size_t packedDrawCalls = 0;   // in the last frame
+};
+
+render::RenderThread::RenderThread(RenderDevice &device, GlDispatch &gl, timing::Clock &clock,
+                                   timing::SchedulerConfig config, size_t commandCapacity)
+        : device(device),
+          gl(gl),
+          clock(clock),
+          config(config),
+          commands(commandCapacity) {
+}
+
+render::RenderThread::~RenderThread() {
+    stop();
+}
+
+void render::RenderThread::start() {
+    if (thread.joinable()) {
+        return;
+    }
+
+    stopping.store(false, std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    startedAt = clock.now();
+    thread = std::thread(&RenderThread::run, this);
+}
+
+void render::RenderThread::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    stopping.store(true, std::memory_order_release);
+    wake();
+    thread.join();
+    stoppedAt = clock.now();
+}
+
+render::MeshHandle render::RenderThread::createMesh(std::vector<float> vertices, std::vector<GLuint> indices) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::CreateMesh;
+    command.handle = nextMesh++;
+    command.vertices = std::move(vertices);
+    command.indices = std::move(indices);
+    push(command);
+    return command.handle;
+}
+
+void render::RenderThread::destroyMesh(MeshHandle mesh) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::DestroyMesh;
+    command.handle = mesh;
+    push(command);
+}
+
+render::MaterialHandle render::RenderThread::createMaterial(const glm::vec4 &color) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::CreateMaterial;
+    command.handle = nextMaterial++;
+    command.color = color;
+    push(command);
+    return command.handle;
+}
+
+render::TextureHandle render::RenderThread::createTexture(std::shared_ptr<const textures::TextureData> texture) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::CreateTexture;
+    command.handle = nextTexture++;
+    command.texture = std::move(texture);
+    push(command);
+    return command.handle;
+}
+
+void render::RenderThread::destroyTexture(TextureHandle texture) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::DestroyTexture;
+    command.handle = texture;
+    push(command);
+}
+
+render::PackedMeshHandle render::RenderThread::createPackedMesh(std::shared_ptr<const meshes::MeshFile> mesh) {
+    RenderCommand command;
+    command.type = RenderCommand::Type::CreatePackedMesh;
+    command.handle = nextPackedMesh++;
+    command.packedMesh = std::move(mesh);
+    push(command);
+    return command.handle;
+}
+
+void render::RenderThread::publishSnapshot() {
+    SceneSnapshot &snapshot = snapshots.getBack();
+    snapshot.sequence = nextSequence++;
+    snapshot.publishedAt = clock.now();
+
+    if (!snapshots.publish()) {
+        ++dropped;
+    }
+    ++published;
+    wake();
+}
+
+render::RenderThreadStats render::RenderThread::getStats() const {
+    RenderThreadStats stats;
+    stats.frames = frames;
+    stats.snapshotsPublished = published;
+    stats.snapshotsRendered = rendered;
+    stats.snapshotsDropped = dropped;
+    stats.commands = executed;
+    stats.commandStalls = commandStalls;
+    stats.seconds = toMilliseconds(stoppedAt - startedAt) / 1000.0;
+
+    if (!latencies.empty()) {
+        std::vector<double> sorted(latencies);
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (double latency : sorted) {
+            sum += latency;
+        }
+        stats.latencySamples = sorted.size();
+        stats.latencyMean = sum / sorted.size();
+        stats.latencyP50 = percentile(sorted, 0.50);
+        stats.latencyP99 = percentile(sorted, 0.99);
+        stats.latencyMax = sorted.back();
+    }
+    return stats;
+}
+
+void render::RenderThread::run() {
+    try {
+        device.makeCurrent();
+        Backend backend(gl, device.loadPrograms());
+        renderLoop(backend);
+    } catch (const std::exception &exception) {
+        error = exception.what();
+    }
+
+    device.release();
+    running.store(false, std::memory_order_release);
+}
+
+void render::RenderThread::renderLoop(Backend &backend) {
+    timing::FrameScheduler scheduler(clock, config);
+    uint64_t lastPresented = 0;
+    latencies.reserve(LatencyWindow);
+
+    while (!stopping.load(std::memory_order_acquire)) {
+        // Snapshot first: every command pushed before it was published is
+        // then visible to the drain below.
+        bool changed = snapshots.update();
+        changed |= executeCommands(backend);
+        if (device.reloadPrograms(backend.programs)) {
+            backend.applyPrograms();
+            changed = true;
+        }
+        if (changed || !backend.uploader.isIdle()) {
+            scheduler.invalidate();
+        }
+
+        // Fixed steps belong to the simulation thread; only the pacing matters here.
+        auto frame = scheduler.beginFrame();
+        if (!frame.redraw) {
+            sleep(config.idleTimeout);
+            continue;
+        }
+
+        const SceneSnapshot &snapshot = snapshots.getFront();
+        device.beginFrame();
+
+        size_t textureBytes;
+        {
+            PROFILE_SCOPE("Texture upload");
+            textureBytes = backend.uploader.update();
+        }
+        {
+            PROFILE_SCOPE("Submit");
+            draw(backend, snapshot);
+        }
+
+        const auto &queueStats = backend.queue.getStats();
+        const auto &shapeStats = backend.shapes.getStats();
+        size_t uploaded = backend.geometry.getStats().bytesUploaded;
+        profiling::FrameCounters counters;
+        counters.drawCalls = queueStats.drawCalls + backend.packedDrawCalls + (shapeStats.instances != 0 ? 1 : 0);
+        counters.stateChanges = queueStats.programBinds + queueStats.vertexArrayBinds + queueStats.uniformUploads;
+        counters.bytesUploaded = uploaded - backend.uploadedBefore + textureBytes + shapeStats.bytesUploaded;
+        backend.uploadedBefore = uploaded;
+        PROFILE_FRAME_COUNTERS(counters);
+
+        {
+            PROFILE_SCOPE("Present");
+            device.present();
+        }
+        ++frames;
+
+        if (snapshot.sequence != lastPresented) {
+            lastPresented = snapshot.sequence;
+            double latency = toMilliseconds(clock.now() - snapshot.publishedAt);
+            if (latencies.size() < LatencyWindow) {
+                latencies.push_back(latency);
+            } else {
+                latencies[rendered % LatencyWindow] = latency;
+            }
+            ++rendered;
+            PROFILE_COUNTER("Snapshot latency", latency);
+        }
+
+        {
+            PROFILE_SCOPE("Wait");
+            scheduler.endFrame();
+        }
+        PROFILE_END_FRAME();
+    }
+
+    // Nothing queued is lost: destroys still free their objects and the
+    // command count adds up.
+    executeCommands(backend);
+}
+
+bool render::RenderThread::executeCommands(Backend &backend) {
+    PROFILE_SCOPE("RenderThread::executeCommands");
+    RenderCommand command;
+    bool any = false;
+
+    while (commands.tryPop(command)) {
+        any = true;
+        ++executed;
+
+        switch (command.type) {
+            case RenderCommand::Type::CreateMesh:
+                backend.meshes.resize(std::max<size_t>(backend.meshes.size(), command.handle + 1), DeadMesh);
+                backend.meshes[command.handle] = backend.geometry.addMesh(
+                        command.vertices.data(), command.vertices.size() / 2, command.indices.data(),
+                        command.indices.size());
+                break;
+            case RenderCommand::Type::DestroyMesh:
+                if (command.handle < backend.meshes.size() && backend.meshes[command.handle] != DeadMesh) {
+                    backend.geometry.removeMesh(backend.meshes[command.handle]);
+                    backend.meshes[command.handle] = DeadMesh;
+                }
+                break;
+            case RenderCommand::Type::CreateMaterial: {
+                MaterialId material = backend.queue.addMaterial({{{backend.programs.flatColor, 4, command.color}}});
+                backend.materials.resize(std::max<size_t>(backend.materials.size(), command.handle + 1), 0);
+                backend.materials[command.handle] = material;
+                break;
+            }
+            case RenderCommand::Type::CreateTexture:
+                backend.textures.resize(std::max<size_t>(backend.textures.size(), command.handle + 1), 0);
+                backend.textures[command.handle] = backend.uploader.enqueue(std::move(command.texture));
+                break;
+            case RenderCommand::Type::DestroyTexture:
+                if (command.handle < backend.textures.size() && backend.textures[command.handle] != 0) {
+                    backend.uploader.cancel(backend.textures[command.handle]);
+                    gl.deleteTextures(1, &backend.textures[command.handle]);
+                    backend.textures[command.handle] = 0;
+                }
+                break;
+            case RenderCommand::Type::CreatePackedMesh:
+                // Handles are created in order and never destroyed.
+                backend.packedBuffers.push_back(command.packedMesh->upload(gl));
+                backend.packedMeshes.push_back(std::move(command.packedMesh));
+                break;
+        }
+    }
+
+    // Adding and removing meshes can replace the arena's buffers, which
+    // rebinds vertex arrays.
+    if (any) {
+        backend.queue.invalidateBindings();
+    }
+    return any;
+}
+
+void render::RenderThread::draw(Backend &backend, const SceneSnapshot &snapshot) {
+    gl.viewport(0, 0, snapshot.framebufferSize.x, snapshot.framebufferSize.y);
+    gl.clearColor(snapshot.clearColor.r, snapshot.clearColor.g, snapshot.clearColor.b, snapshot.clearColor.a);
+    gl.clear(GL_COLOR_BUFFER_BIT);
+
+    for (const auto &draw : snapshot.draws) {
+        // The mesh may be gone if this snapshot is older than its destroy command.
+        if (draw.mesh >= backend.meshes.size() || backend.meshes[draw.mesh] == DeadMesh ||
+            draw.material >= backend.materials.size()) {
+            continue;
+        }
+
+        MeshRange mesh = backend.geometry.getMesh(backend.meshes[draw.mesh]);
+        backend.queue.submit({backend.flatProgram, backend.sceneVao, backend.materials[draw.material], draw.layer,
+                              0.f, mesh.indexCount, mesh.firstIndex, mesh.baseVertex});
+    }
+    backend.queue.flush();
+
+    // Converted meshes have a vertex array and layout of their own, so they
+    // bypass the queue.
+    backend.packedDrawCalls = 0;
+    bool meshProgramBound = false;
+    for (const auto &draw : snapshot.packedDraws) {
+        if (draw.mesh >= backend.packedMeshes.size()) {
+            continue;
+        }
+        if (!meshProgramBound) {
+            gl.useProgram(backend.programs.mesh);
+            meshProgramBound = true;
+        }
+
+        const meshes::MeshFile &mesh = *backend.packedMeshes[draw.mesh];
+        const meshes::MeshBuffers &buffers = backend.packedBuffers[draw.mesh];
+        gl.uniform4f(backend.programs.meshColor, draw.color.r, draw.color.g, draw.color.b, draw.color.a);
+        gl.uniform4f(backend.programs.meshOffset, draw.offset.x, draw.offset.y, draw.offset.z, 0.f);
+        gl.uniform4f(backend.programs.meshScale, draw.scale.x, draw.scale.y, draw.scale.z, 0.f);
+        gl.bindVertexArray(buffers.vertexArray);
+        for (size_t i = 0; i < mesh.getSubmeshCount(); ++i) {
+            const meshes::Submesh &submesh = mesh.getSubmeshes()[i];
+            gl.drawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(submesh.indexCount), buffers.indexType,
+                                      reinterpret_cast<const void *>(submesh.firstIndex * mesh.getIndexSize()),
+                                      static_cast<GLint>(submesh.baseVertex));
+            ++backend.packedDrawCalls;
+        }
+    }
+
+    // The queue, the packed meshes and the command batch bind their own
+    // program and vertex arrays.
+    backend.shapes.invalidateBindings();
+    backend.shapes.addInstances(snapshot.shapes.data(), snapshot.shapes.size());
+    backend.shapes.flush(glm::vec2(snapshot.framebufferSize));
+    // The batcher binds its own program and vertex array; the flat program's
+    // uniforms are untouched, so the queue's uniform cache stays valid.
+    backend.queue.invalidateBindings();
+}
+
+void render::RenderThread::push(RenderCommand &command) {
+    if (!commands.tryPush(command)) {
+        ++commandStalls;
+        do {
+            if (!isRunning()) {
+                return;
+            }
+            wake();
+            std::this_thread::yield();
+        } while (!commands.tryPush(command));
+    }
+    wake();
+}
+
+void render::RenderThread::wake() {
+    // Pairs with the fence in sleep(): either the render thread sees the new
+    // data before it waits or this sees it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakePending = true;
+        wakeUp.notify_one();
+    }
+}
+
+void render::RenderThread::sleep(timing::Nanoseconds timeout) {
+    PROFILE_SCOPE("Idle");
+    sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!snapshots.hasUpdate() && commands.sizeApprox() == 0 && !stopping.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeUp.wait_for(lock, timeout, [this] { return wakePending; });
+    }
+
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wakePending = false;
+    sleeping.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include "FrameScheduler.h"
+#include "GlDispatch.h"
+#include "MeshFile.h"
+#include "ShapeBatcher.h"
+#include "SpscQueue.h"
+#include "TextureCache.h"
+#include "TripleBuffer.h"
+
+namespace render {
+    // Names the simulation thread gives resources before the render thread has
+    // created them. Handles count up from 0 and aren't reused.
+    using MeshHandle = uint32_t;
+    using MaterialHandle = uint32_t;
+    using TextureHandle = uint32_t;
+    using PackedMeshHandle = uint32_t;
+
+    struct SnapshotDraw {
+        MeshHandle mesh;
+        MaterialHandle material;
+        uint8_t layer = 0;
+    };
+
+    // A converted mesh drawn in one color; its quantized positions map to
+    // offset + position * scale in NDC.
+    struct SnapshotPackedDraw {
+        PackedMeshHandle mesh;
+        glm::vec4 color;
+        glm::vec3 offset;
+        glm::vec3 scale;
+    };
+
+    // Everything the render thread needs to draw one frame. The simulation
+    // thread fills one in place and never touches it again once published.
+    struct SceneSnapshot {
+        uint64_t sequence = 0;            // stamped by publishSnapshot
+        timing::Nanoseconds publishedAt{0};
+        glm::ivec2 framebufferSize = {0, 0};
+        glm::vec4 clearColor = {0.f, 0.f, 0.f, 1.f};
+        std::vector<SnapshotDraw> draws;  // flat-shaded meshes
+        std::vector<SnapshotPackedDraw> packedDraws; // over the flat meshes
+        std::vector<ShapeInstance> shapes; // drawn over the meshes
+    };
+
+    struct RenderCommand {
+        enum class Type : uint8_t {
+            CreateMesh,
+            DestroyMesh,
+            CreateMaterial,
+            CreateTexture,
+            DestroyTexture,
+            CreatePackedMesh
+        };
+
+        Type type = Type::CreateMesh;
+        uint32_t handle = 0;
+        std::vector<float> vertices;      // CreateMesh: 2 floats per vertex, NDC
+        std::vector<GLuint> indices;      // CreateMesh: GL_TRIANGLES
+        glm::vec4 color = {0.f, 0.f, 0.f, 0.f};           // CreateMaterial
+        std::shared_ptr<const textures::TextureData> texture; // CreateTexture
+        std::shared_ptr<const meshes::MeshFile> packedMesh;   // CreatePackedMesh
+    };
+
+    // What the render thread needs from the platform. All calls come from the
+    // render thread.
+    class RenderDevice {
+    public:
+        struct Programs {
+            GLuint flat = 0;             // ver.glsl + frag.glsl
+            GLint flatColor = -1;        // its outColor
+            GLuint shape = 0;            // shape_vertex.glsl + shape_fragment.glsl
+            GLint shapeViewport = -1;    // its viewportSize
+            GLuint mesh = 0;             // mesh_vertex.glsl + frag.glsl
+            GLint meshColor = -1;        // its outColor
+            GLint meshOffset = -1;       // its positionOffset
+            GLint meshScale = -1;        // its positionScale
+        };
+
+        virtual ~RenderDevice() = default;
+
+        // Makes the context current on the calling thread; first call made.
+        virtual void makeCurrent() = 0;
+        // Throws std::runtime_error when a program can't be built.
+        virtual Programs loadPrograms() = 0;
+        // Polled once a frame; returns true after replacing any of programs.
+        virtual bool reloadPrograms(Programs &programs) = 0;
+        virtual void beginFrame() = 0;
+        virtual void present() = 0;
+        // Last call made, after every GL object of the thread is gone.
+        virtual void release() = 0;
+    };
+
+    struct RenderThreadStats {
+        size_t frames = 0;              // presented
+        size_t snapshotsPublished = 0;
+        size_t snapshotsRendered = 0;   // presented at least once
+        size_t snapshotsDropped = 0;    // overwritten before the render thread got to them
+        size_t commands = 0;            // executed
+        size_t commandStalls = 0;       // times the simulation thread found the queue full
+        double seconds = 0.0;           // from start() to stop()
+
+        // Publish to the end of present() of the first frame showing a
+        // snapshot, over the last LatencyWindow snapshots; all in ms.
+        size_t latencySamples = 0;
+        double latencyMean = 0.0;
+        double latencyP50 = 0.0;
+        double latencyP99 = 0.0;
+        double latencyMax = 0.0;
+    };
+
+    // Runs GL submission on its own thread, so a slow simulation step doesn't
+    // delay presentation and a blocking swap doesn't delay input. One
+    // simulation thread talks to it through two lock-free channels: scene
+    // snapshots through a triple buffer, of which the render thread always
+    // draws the newest, and resource commands through a bounded SPSC queue,
+    // executed in order before the next frame. Frames are paced by a
+    // FrameScheduler on the render thread; in power-saving mode it only
+    // redraws when a new snapshot or command arrives.
+    //
+    // Meshes share one GeometryArena with the 2-float position layout of the
+    // scene; converted meshes keep the vertex array MeshFile::upload() gives
+    // them; textures stream in through a TextureUploader. Every GL call goes
+    // through the GlDispatch, so the thread runs against a recording or
+    // counting dispatch as well as a live context.
+    class RenderThread {
+    public:
+        static constexpr size_t LatencyWindow = 1 << 12;
+
+        RenderThread(RenderDevice &device, GlDispatch &gl, timing::Clock &clock, timing::SchedulerConfig config,
+                     size_t commandCapacity = 1 << 10);
+        ~RenderThread();
+
+        RenderThread(const RenderThread &) = delete;
+        RenderThread &operator=(const RenderThread &) = delete;
+
+        void start();
+        // Joins the thread, which executes the commands still queued, then
+        // releases its GL objects and the context.
+        void stop();
+        // False once stopped or when the render thread failed; getError() says why.
+        bool isRunning() const { return running.load(std::memory_order_acquire); }
+        const std::string &getError() const { return error; }
+
+        // Simulation thread. Commands block while the queue is full.
+        MeshHandle createMesh(std::vector<float> vertices, std::vector<GLuint> indices);
+        void destroyMesh(MeshHandle mesh);
+        MaterialHandle createMaterial(const glm::vec4 &color);
+        TextureHandle createTexture(std::shared_ptr<const textures::TextureData> texture);
+        void destroyTexture(TextureHandle texture);
+        // The file stays mapped until the render thread stops.
+        PackedMeshHandle createPackedMesh(std::shared_ptr<const meshes::MeshFile> mesh);
+
+        // Simulation thread: the snapshot to fill, then publish it. The slot
+        // is recycled, so clear its vectors rather than assume they're empty.
+        SceneSnapshot &beginSnapshot() { return snapshots.getBack(); }
+        void publishSnapshot();
+
+        // Valid after stop().
+        RenderThreadStats getStats() const;
+
+    private:
+        struct Backend;
+
+        void run();
+        void renderLoop(Backend &backend);
+        bool executeCommands(Backend &backend);
+        void draw(Backend &backend, const SceneSnapshot &snapshot);
+        void push(RenderCommand &command);
+        void wake();
+        void sleep(timing::Nanoseconds timeout);
+
+        RenderDevice &device;
+        GlDispatch &gl;
+        timing::Clock &clock;
+        timing::SchedulerConfig config;
+
+        threading::TripleBuffer<SceneSnapshot> snapshots;
+        threading::SpscQueue<RenderCommand> commands;
+
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopping{false};
+        std::string error;
+
+        // Lets an idle render thread sleep; the data itself never takes the lock.
+        std::atomic<bool> sleeping{false};
+        std::mutex wakeMutex;
+        std::condition_variable wakeUp;
+        bool wakePending = false;
+
+        // Simulation thread.
+        uint32_t nextMesh = 0;
+        uint32_t nextMaterial = 0;
+        uint32_t nextTexture = 0;
+        uint32_t nextPackedMesh = 0;
+        uint64_t nextSequence = 1;
+        size_t published = 0;
+        size_t dropped = 0;
+        size_t commandStalls = 0;
+        timing::Nanoseconds startedAt{0};
+        timing::Nanoseconds stoppedAt{0};
+
+        // Render thread.
+        size_t frames = 0;
+        size_t rendered = 0;
+        size_t executed = 0;
+        std::vector<double> latencies;   // ring of LatencyWindow, ms
+    };
+}
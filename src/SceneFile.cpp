@@ -0,0 +1,79 @@
+#include <stdexcept>
+#include "Profiler.h"
+#include "SceneFile.h"
+
+namespace {
+    bool sectionFits(uint64_t offset, uint64_t size, size_t fileSize) {
+        return offset % scene::SceneAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+scene::SceneFile::SceneFile(const std::string &path) : file(path) {
+    PROFILE_SCOPE("SceneFile::open");
+
+    if (!file.isOpen()) {
+        throw std::runtime_error("Can't open scene '" + path + "'");
+    }
+    size = file.size();
+    open(file.data(), path);
+}
+
+scene::SceneFile::SceneFile(std::vector<char> image, const std::string &name) : image(std::move(image)) {
+    size = this->image.size();
+    open(this->image.data(), name);
+}
+
+void scene::SceneFile::open(const char *data, const std::string &name) {
+    // Both mmap and operator new return memory aligned well past SceneAlignment,
+    // so the sections can be read in place.
+    if (size < sizeof(SceneHeader)) {
+        throw std::runtime_error("Scene '" + name + "' is truncated");
+    }
+
+    header = reinterpret_cast<const SceneHeader *>(data);
+    if (header->magic != SceneMagic) {
+        throw std::runtime_error("'" + name + "' is not a compiled scene");
+    }
+    if (header->version != SceneVersion) {
+        throw std::runtime_error("Scene '" + name + "' has version " + std::to_string(header->version) +
+                                 ", expected " + std::to_string(SceneVersion) + "; compile it again");
+    }
+
+    if (!sectionFits(header->rootOffset, uint64_t(header->rootCount) * sizeof(SceneRoot), size) ||
+        !sectionFits(header->meshOffset, uint64_t(header->meshCount) * sizeof(SceneMesh), size) ||
+        !sectionFits(header->materialOffset, uint64_t(header->materialCount) * sizeof(SceneMaterial), size) ||
+        !sectionFits(header->nodeOffset, uint64_t(header->nodeCount) * sizeof(SceneNode), size) ||
+        !sectionFits(header->vertexOffset, uint64_t(header->vertexCount) * 2 * sizeof(float), size) ||
+        !sectionFits(header->indexOffset, uint64_t(header->indexCount) * sizeof(uint32_t), size)) {
+        throw std::runtime_error("Scene '" + name + "' is corrupt");
+    }
+
+    roots = reinterpret_cast<const SceneRoot *>(data + header->rootOffset);
+    meshes = reinterpret_cast<const SceneMesh *>(data + header->meshOffset);
+    materials = reinterpret_cast<const SceneMaterial *>(data + header->materialOffset);
+    nodes = reinterpret_cast<const SceneNode *>(data + header->nodeOffset);
+    vertices = reinterpret_cast<const float *>(data + header->vertexOffset);
+    indices = reinterpret_cast<const uint32_t *>(data + header->indexOffset);
+
+    for (size_t i = 0; i < header->rootCount; ++i) {
+        if (roots[i].node >= header->nodeCount) {
+            throw std::runtime_error("Scene '" + name + "' is corrupt");
+        }
+    }
+
+    // Meshes are few and shared, so their indices are checked here once rather
+    // than by everything that draws them.
+    for (size_t i = 0; i < header->meshCount; ++i) {
+        const SceneMesh &mesh = meshes[i];
+        if (uint64_t(mesh.firstVertex) + mesh.vertexCount > header->vertexCount ||
+            uint64_t(mesh.firstIndex) + mesh.indexCount > header->indexCount) {
+            throw std::runtime_error("Scene '" + name + "' is corrupt");
+        }
+        const uint32_t *meshIndices = indices + mesh.firstIndex;
+        for (uint32_t index = 0; index < mesh.indexCount; ++index) {
+            if (meshIndices[index] >= mesh.vertexCount) {
+                throw std::runtime_error("Scene '" + name + "' is corrupt");
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "SceneFormat.h"
+
+namespace scene {
+    // A compiled scene used in place. Opening checks the header, that every
+    // section lies inside the file, the root and mesh tables and every mesh's
+    // indices; nodes are left alone until SceneInstancer reaches them, so the
+    // cost of opening doesn't grow with the node count. Throws
+    // std::runtime_error on a missing, truncated, foreign or corrupt scene.
+    class SceneFile {
+    public:
+        // Maps a file written by scene_compiler.
+        explicit SceneFile(const std::string &path);
+        // Takes over an image from compileScene(); name is for error messages.
+        SceneFile(std::vector<char> image, const std::string &name);
+
+        SceneFile(const SceneFile &) = delete;
+        SceneFile &operator=(const SceneFile &) = delete;
+
+        const SceneHeader &getHeader() const { return *header; }
+        const SceneRoot *getRoots() const { return roots; }
+        size_t getRootCount() const { return header->rootCount; }
+        const SceneMesh *getMeshes() const { return meshes; }
+        size_t getMeshCount() const { return header->meshCount; }
+        const SceneMaterial *getMaterials() const { return materials; }
+        size_t getMaterialCount() const { return header->materialCount; }
+        const SceneNode *getNodes() const { return nodes; }
+        size_t getNodeCount() const { return header->nodeCount; }
+
+        // A mesh's vertices (2 floats each) and its indices, relative to them.
+        const float *getVertices(const SceneMesh &mesh) const { return vertices + size_t(mesh.firstVertex) * 2; }
+        const uint32_t *getIndices(const SceneMesh &mesh) const { return indices + mesh.firstIndex; }
+
+        size_t getSize() const { return size; }
+
+    private:
+        void open(const char *data, const std::string &name);
+
+        io::MappedFile file;
+        std::vector<char> image;
+        size_t size = 0;
+
+        const SceneHeader *header = nullptr;
+        const SceneRoot *roots = nullptr;
+        const SceneMesh *meshes = nullptr;
+        const SceneMaterial *materials = nullptr;
+        const SceneNode *nodes = nullptr;
+        const float *vertices = nullptr;
+        const uint32_t *indices = nullptr;
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk layout written by the scene_compiler tool and mapped by SceneFile.
+// Sections start at SceneAlignment boundaries and refer to each other only by
+// index, never by pointer, so the file is used in place wherever it's mapped.
+namespace scene {
+    const uint32_t SceneMagic = 0x454e4353; // "SCNE"
+    const uint32_t SceneVersion = 1;
+    const uint64_t SceneAlignment = 16;
+    const uint32_t NoIndex = ~uint32_t(0);
+
+    enum class MaterialShader : uint32_t {
+        Flat,
+        Circle    // the circle inscribed in the mesh's bounds, drawn as a shape
+    };
+
+    struct SceneHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t meshCount;
+        uint32_t materialCount;
+        uint32_t nodeCount;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t rootCount;
+        uint64_t rootOffset;
+        uint64_t meshOffset;
+        uint64_t materialOffset;
+        uint64_t nodeOffset;
+        uint64_t vertexOffset;   // 2 floats per vertex, the layout of the flat meshes
+        uint64_t indexOffset;    // uint32_t, GL_TRIANGLES
+    };
+
+    // The top-level nodes with a copy of their subtree bounds, so deciding
+    // which subtrees are in view reads this table instead of the node pages.
+    struct SceneRoot {
+        float subtreeBounds[4];
+        uint32_t node;
+        uint32_t padding[3];
+    };
+
+    // Indices are relative to firstVertex, so a mesh uploads as it is.
+    struct SceneMesh {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float boundsMin[2];
+        float boundsMax[2];
+    };
+
+    struct SceneMaterial {
+        float color[4];
+        uint32_t shader;         // MaterialShader
+        uint32_t padding[3];
+    };
+
+    // Nodes are stored depth first, so the subtree of node i is the range
+    // [i, subtreeEnd): its first child is i + 1 when subtreeEnd > i + 1 and
+    // each next sibling starts at the previous one's subtreeEnd.
+    struct SceneNode {
+        float position[3];
+        float rotation[4];       // quaternion x, y, z, w
+        float scale[3];
+        // World-space sphere around the meshes of the whole subtree as
+        // authored; a negative radius when there are none.
+        float subtreeBounds[4];
+        uint32_t parent;         // NoIndex for roots
+        uint32_t subtreeEnd;
+        uint32_t mesh;           // NoIndex for nodes that only group others
+        uint32_t material;       // NoIndex without a mesh
+        uint32_t padding[2];
+    };
+
+    static_assert(sizeof(SceneRoot) == 32, "SceneRoot is part of the file format");
+    static_assert(sizeof(SceneMesh) == 32, "SceneMesh is part of the file format");
+    static_assert(sizeof(SceneMaterial) == 32, "SceneMaterial is part of the file format");
+    static_assert(sizeof(SceneNode) == 80, "SceneNode is part of the file format");
+}
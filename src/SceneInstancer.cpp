@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "Profiler.h"
+#include "SceneInstancer.h"
+
+scene::SceneInstancer::SceneInstancer(const SceneFile &scene, TransformSystem &transforms)
+        : scene(scene), transforms(transforms), objects(scene.getNodeCount(), NoParent) {
+    for (size_t i = 0; i < scene.getRootCount(); ++i) {
+        const SceneRoot &root = scene.getRoots()[i];
+        pending.push_back({glm::vec4(root.subtreeBounds[0], root.subtreeBounds[1], root.subtreeBounds[2],
+                                     root.subtreeBounds[3]), root.node});
+    }
+}
+
+const std::vector<uint32_t> &scene::SceneInstancer::instantiate(const Frustum &frustum) {
+    PROFILE_SCOPE("SceneInstancer::instantiate");
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    const SceneNode *nodes = scene.getNodes();
+    created.clear();
+    stillPending.clear();
+    work.clear();
+
+    for (const Pending &subtree : pending) {
+        if (subtree.bounds.w < 0.f) {
+            continue;
+        }
+        if (!frustum.isVisible(glm::vec3(subtree.bounds), subtree.bounds.w)) {
+            stillPending.push_back(subtree);
+            continue;
+        }
+
+        // Depth first, so parents are created before their children.
+        work.push_back(subtree.node);
+        while (!work.empty()) {
+            uint32_t index = work.back();
+            work.pop_back();
+            if (!isNodeValid(index)) {
+                // Part of the frontier may already be instantiated, so there's
+                // no state to resume from.
+                error = "Scene node " + std::to_string(index) + " is corrupt";
+                throw std::runtime_error(error);
+            }
+
+            const SceneNode &node = nodes[index];
+            ObjectId object = transforms.create(node.parent == NoIndex ? NoParent : objects[node.parent]);
+            transforms.setPosition(object, {node.position[0], node.position[1], node.position[2]});
+            transforms.setRotation(object, glm::quat(node.rotation[3], node.rotation[0], node.rotation[1],
+                                                     node.rotation[2]));
+            transforms.setScale(object, {node.scale[0], node.scale[1], node.scale[2]});
+
+            // Grouping nodes get a negative radius, which never passes cull().
+            if (node.mesh != NoIndex) {
+                const SceneMesh &mesh = scene.getMeshes()[node.mesh];
+                glm::vec2 low(mesh.boundsMin[0], mesh.boundsMin[1]);
+                glm::vec2 high(mesh.boundsMax[0], mesh.boundsMax[1]);
+                transforms.setLocalBounds(object, glm::vec3((low + high) * 0.5f, 0.f),
+                                          glm::length(high - low) * 0.5f);
+            } else {
+                transforms.setLocalBounds(object, glm::vec3(0.f), -1.f);
+            }
+
+            objects[index] = object;
+            created.push_back(index);
+            ++instantiated;
+
+            size_t firstChild = work.size();
+            for (uint32_t child = index + 1; child < node.subtreeEnd; child = nodes[child].subtreeEnd) {
+                const SceneNode &childNode = nodes[child];
+                glm::vec4 bounds(childNode.subtreeBounds[0], childNode.subtreeBounds[1],
+                                 childNode.subtreeBounds[2], childNode.subtreeBounds[3]);
+                if (bounds.w < 0.f) {
+                    continue;
+                }
+                if (frustum.isVisible(glm::vec3(bounds), bounds.w)) {
+                    work.push_back(child);
+                } else {
+                    stillPending.push_back({bounds, child});
+                }
+                // Bounds the loop when the node is corrupt; isNodeValid() catches it later.
+                if (childNode.subtreeEnd <= child) {
+                    break;
+                }
+            }
+            std::reverse(work.begin() + firstChild, work.end());
+        }
+    }
+
+    pending.swap(stillPending);
+    return created;
+}
+
+bool scene::SceneInstancer::isNodeValid(uint32_t index) const {
+    const SceneNode &node = scene.getNodes()[index];
+    bool parentReady = node.parent == NoIndex || (node.parent < index && objects[node.parent] != NoParent);
+    return parentReady && objects[index] == NoParent && node.subtreeEnd > index &&
+           node.subtreeEnd <= scene.getNodeCount() &&
+           (node.mesh == NoIndex || (node.mesh < scene.getMeshCount() && node.material < scene.getMaterialCount()));
+}
+
+scene::SceneCircle scene::getInscribedCircle(const SceneMesh &mesh, const glm::mat4 &world) {
+    glm::vec2 low(mesh.boundsMin[0], mesh.boundsMin[1]);
+    glm::vec2 high(mesh.boundsMax[0], mesh.boundsMax[1]);
+    return {glm::vec2(world * glm::vec4((low + high) * 0.5f, 0.f, 1.f)),
+            (high.x - low.x) * 0.5f * glm::length(glm::vec3(world[0]))};
+}
+
+void scene::bakeSceneNodes(const SceneFile &sceneFile, const SceneInstancer &instancer,
+                           const TransformSystem &transforms, const std::vector<uint32_t> &nodes,
+                           std::vector<BakedNode> &baked) {
+    for (uint32_t index : nodes) {
+        const SceneNode &node = sceneFile.getNodes()[index];
+        if (node.mesh == NoIndex) {
+            continue;
+        }
+
+        const SceneMesh &mesh = sceneFile.getMeshes()[node.mesh];
+        const glm::mat4 &world = transforms.getWorldMatrix(instancer.getObject(index));
+        BakedNode bakedNode;
+        bakedNode.material = node.material;
+        bakedNode.circle = sceneFile.getMaterials()[node.material].shader ==
+                           static_cast<uint32_t>(MaterialShader::Circle);
+        bakedNode.indices = sceneFile.getIndices(mesh);
+        bakedNode.indexCount = mesh.indexCount;
+
+        const float *vertices = sceneFile.getVertices(mesh);
+        for (size_t vertex = 0; vertex < mesh.vertexCount; ++vertex) {
+            glm::vec4 position = world * glm::vec4(vertices[vertex * 2], vertices[vertex * 2 + 1], 0.f, 1.f);
+            bakedNode.vertices.push_back(position.x);
+            bakedNode.vertices.push_back(position.y);
+        }
+
+        SceneCircle circle = getInscribedCircle(mesh, world);
+        bakedNode.center = circle.center;
+        bakedNode.radius = circle.radius;
+        baked.push_back(std::move(bakedNode));
+    }
+}
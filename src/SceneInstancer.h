@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SceneFile.h"
+#include "TransformSystem.h"
+
+namespace scene {
+    // Creates TransformSystem objects for the nodes of a SceneFile as their
+    // subtrees come into view, so a large scene costs only what has been
+    // seen so far. It keeps a frontier of subtrees not yet instantiated whose
+    // parents are, starting from the root table with copies of their bounds;
+    // each call tests those and descends into the ones that pass, so the node
+    // pages of subtrees out of view are never read. Subtrees without meshes
+    // are never instantiated. The transforms of instantiated objects are the caller's
+    // to change; the bounds of what is still pending stay as authored.
+    class SceneInstancer {
+    public:
+        SceneInstancer(const SceneFile &scene, TransformSystem &transforms);
+
+        SceneInstancer(const SceneInstancer &) = delete;
+        SceneInstancer &operator=(const SceneInstancer &) = delete;
+
+        // Instantiates the pending subtrees that pass the frustum and returns
+        // the nodes created, parents before children. Throws
+        // std::runtime_error on a node whose references are out of range;
+        // the objects created so far stay, and every later call throws the
+        // same error.
+        const std::vector<uint32_t> &instantiate(const Frustum &frustum);
+
+        // NoParent until the node has been instantiated.
+        ObjectId getObject(uint32_t node) const { return objects[node]; }
+        size_t getInstantiatedCount() const { return instantiated; }
+        size_t getPendingCount() const { return pending.size(); }
+
+    private:
+        struct Pending {
+            glm::vec4 bounds;
+            uint32_t node;
+        };
+
+        bool isNodeValid(uint32_t index) const;
+
+        const SceneFile &scene;
+        TransformSystem &transforms;
+        std::vector<ObjectId> objects;
+        std::vector<Pending> pending;
+        std::vector<Pending> stillPending;
+        std::vector<uint32_t> work;
+        std::vector<uint32_t> created;
+        size_t instantiated = 0;
+        std::string error;   // set once a corrupt node is found
+    };
+
+    struct SceneCircle {
+        glm::vec2 center;
+        float radius;
+    };
+
+    // What a MaterialShader::Circle node draws: the circle inscribed in its
+    // mesh's bounds, placed by the node's world matrix. The radius follows
+    // the x scale.
+    SceneCircle getInscribedCircle(const SceneMesh &mesh, const glm::mat4 &world);
+
+    // A scene node in the form the renderers draw it. ver.glsl applies no
+    // transform, so the world matrix is baked into the vertices; circle
+    // materials also get the circle inscribed in the mesh's bounds.
+    struct BakedNode {
+        uint32_t material;
+        bool circle;
+        std::vector<float> vertices;   // 2 floats per vertex, NDC
+        const uint32_t *indices;       // in place in the scene
+        size_t indexCount;
+        glm::vec2 center;
+        float radius;
+    };
+
+    // Appends the nodes with a mesh to baked. Needs transforms.update() after
+    // the nodes were instantiated.
+    void bakeSceneNodes(const SceneFile &sceneFile, const SceneInstancer &instancer,
+                        const TransformSystem &transforms, const std::vector<uint32_t> &nodes,
+                        std::vector<BakedNode> &baked);
+}
@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Profiler.h"
+#include "SceneText.h"
+
+namespace {
+    // Splits off tokens up to a '#' comment. The views point into line.
+    void split(const std::string &line, std::vector<std::string_view> &tokens) {
+        tokens.clear();
+        size_t end = std::min(line.find('#'), line.size());
+        auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+
+        size_t i = 0;
+        while (true) {
+            while (i < end && isSpace(line[i])) {
+                ++i;
+            }
+            if (i == end) {
+                break;
+            }
+            size_t start = i;
+            while (i < end && !isSpace(line[i])) {
+                ++i;
+            }
+            tokens.emplace_back(line.data() + start, i - start);
+        }
+    }
+
+    glm::vec4 mergeSpheres(const glm::vec4 &a, const glm::vec4 &b) {
+        if (a.w < 0.f) {
+            return b;
+        }
+        if (b.w < 0.f) {
+            return a;
+        }
+
+        float distance = glm::length(glm::vec3(b) - glm::vec3(a));
+        if (distance + b.w <= a.w) {
+            return a;
+        }
+        if (distance + a.w <= b.w) {
+            return b;
+        }
+
+        float radius = (distance + a.w + b.w) * 0.5f;
+        glm::vec3 center = glm::vec3(a) + (glm::vec3(b) - glm::vec3(a)) * ((radius - a.w) / distance);
+        return glm::vec4(center, radius);
+    }
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + scene::SceneAlignment - 1) & ~(scene::SceneAlignment - 1);
+    }
+}
+
+scene::SceneDescription scene::parseSceneText(std::istream &input, const std::string &sourceName) {
+    PROFILE_SCOPE("parseSceneText");
+    SceneDescription scene;
+    std::unordered_map<std::string, uint32_t> meshNames;
+    std::unordered_map<std::string, uint32_t> materialNames;
+    std::unordered_map<std::string, uint32_t> nodeNames;
+
+    std::string line;
+    std::vector<std::string_view> tokens;
+    size_t lineNumber = 0;
+    bool inMesh = false;
+
+    auto fail = [&](const std::string &message) {
+        return std::runtime_error(sourceName + ":" + std::to_string(lineNumber) + ": " + message);
+    };
+    // Tokens end at whitespace or the end of the line, where strtof stops too.
+    auto number = [&](std::string_view token) {
+        char *end;
+        float value = std::strtof(token.data(), &end);
+        if (end != token.data() + token.size()) {
+            throw fail("'" + std::string(token) + "' is not a number");
+        }
+        return value;
+    };
+    auto index = [&](std::string_view token) {
+        char *end;
+        unsigned long value = std::strtoul(token.data(), &end, 10);
+        if (token[0] < '0' || token[0] > '9' || end != token.data() + token.size() || value >= NoIndex) {
+            throw fail("'" + std::string(token) + "' is not an index");
+        }
+        return static_cast<uint32_t>(value);
+    };
+    auto declare = [&](std::unordered_map<std::string, uint32_t> &names, std::string_view name, size_t index,
+                       const char *kind) {
+        if (!names.emplace(std::string(name), static_cast<uint32_t>(index)).second) {
+            throw fail(std::string(kind) + " '" + std::string(name) + "' is declared twice");
+        }
+    };
+    auto lookup = [&](const std::unordered_map<std::string, uint32_t> &names, std::string_view name,
+                      const char *kind) {
+        auto found = names.find(std::string(name));
+        if (found == names.end()) {
+            throw fail(std::string(kind) + " '" + std::string(name) + "' isn't declared above");
+        }
+        return found->second;
+    };
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        split(line, tokens);
+        if (tokens.empty()) {
+            continue;
+        }
+
+        std::string_view keyword = tokens[0];
+        if (inMesh) {
+            auto &mesh = scene.meshes.back();
+            if (keyword == "vertex" && tokens.size() == 3) {
+                mesh.vertices.push_back(number(tokens[1]));
+                mesh.vertices.push_back(number(tokens[2]));
+            } else if (keyword == "triangle" && tokens.size() == 4) {
+                for (size_t i = 1; i < 4; ++i) {
+                    mesh.indices.push_back(index(tokens[i]));
+                }
+            } else if (keyword == "end" && tokens.size() == 1) {
+                for (uint32_t vertex : mesh.indices) {
+                    if (vertex >= mesh.vertices.size() / 2) {
+                        throw fail("mesh '" + mesh.name + "' uses vertex " + std::to_string(vertex) + " of " +
+                                   std::to_string(mesh.vertices.size() / 2));
+                    }
+                }
+                inMesh = false;
+            } else {
+                throw fail("expected vertex, triangle or end in mesh '" + mesh.name + "'");
+            }
+        } else if (keyword == "mesh" && tokens.size() == 2) {
+            declare(meshNames, tokens[1], scene.meshes.size(), "Mesh");
+            scene.meshes.emplace_back();
+            scene.meshes.back().name = std::string(tokens[1]);
+            inMesh = true;
+        } else if (keyword == "material" && (tokens.size() == 6 || (tokens.size() == 7 && tokens[6] == "circle"))) {
+            declare(materialNames, tokens[1], scene.materials.size(), "Material");
+            MaterialDescription material;
+            material.name = std::string(tokens[1]);
+            material.color = {number(tokens[2]), number(tokens[3]), number(tokens[4]), number(tokens[5])};
+            material.shader = tokens.size() == 7 ? MaterialShader::Circle : MaterialShader::Flat;
+            scene.materials.push_back(std::move(material));
+        } else if (keyword == "node" && tokens.size() >= 2) {
+            NodeDescription node;
+            node.name = std::string(tokens[1]);
+
+            for (size_t i = 2; i < tokens.size();) {
+                std::string_view option = tokens[i];
+                auto values = [&](size_t count) {
+                    if (i + count >= tokens.size()) {
+                        throw fail(std::string(option) + " needs " + std::to_string(count) + " values");
+                    }
+                };
+
+                if (option == "parent") {
+                    values(1);
+                    node.parent = lookup(nodeNames, tokens[i + 1], "Node");
+                    i += 2;
+                } else if (option == "mesh") {
+                    values(1);
+                    node.mesh = lookup(meshNames, tokens[i + 1], "Mesh");
+                    i += 2;
+                } else if (option == "material") {
+                    values(1);
+                    node.material = lookup(materialNames, tokens[i + 1], "Material");
+                    i += 2;
+                } else if (option == "position") {
+                    values(3);
+                    node.position = {number(tokens[i + 1]), number(tokens[i + 2]), number(tokens[i + 3])};
+                    i += 4;
+                } else if (option == "rotation") {
+                    values(4);
+                    float degrees = number(tokens[i + 1]);
+                    glm::vec3 axis = {number(tokens[i + 2]), number(tokens[i + 3]), number(tokens[i + 4])};
+                    if (glm::length(axis) == 0.f) {
+                        throw fail("rotation axis of node '" + node.name + "' has zero length");
+                    }
+                    node.rotation = glm::angleAxis(glm::radians(degrees), glm::normalize(axis));
+                    i += 5;
+                } else if (option == "scale") {
+                    values(3);
+                    node.scale = {number(tokens[i + 1]), number(tokens[i + 2]), number(tokens[i + 3])};
+                    i += 4;
+                } else {
+                    throw fail("unknown node option '" + std::string(option) + "'");
+                }
+            }
+
+            if (node.mesh != NoIndex && node.material == NoIndex) {
+                throw fail("node '" + node.name + "' has a mesh but no material");
+            }
+            declare(nodeNames, tokens[1], scene.nodes.size(), "Node");
+            scene.nodes.push_back(std::move(node));
+        } else {
+            throw fail("unknown statement '" + std::string(keyword) + "'");
+        }
+    }
+
+    if (inMesh) {
+        throw fail("mesh '" + scene.meshes.back().name + "' has no end");
+    }
+    return scene;
+}
+
+void scene::writeSceneText(const SceneDescription &scene, std::ostream &output) {
+    auto precision = output.precision(std::numeric_limits<float>::max_digits10);
+
+    for (const auto &mesh : scene.meshes) {
+        output << "mesh " << mesh.name << '\n';
+        for (size_t i = 0; i + 1 < mesh.vertices.size(); i += 2) {
+            output << "    vertex " << mesh.vertices[i] << ' ' << mesh.vertices[i + 1] << '\n';
+        }
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            output << "    triangle " << mesh.indices[i] << ' ' << mesh.indices[i + 1] << ' ' << mesh.indices[i + 2]
+                   << '\n';
+        }
+        output << "end\n\n";
+    }
+
+    for (const auto &material : scene.materials) {
+        output << "material " << material.name << ' ' << material.color.r << ' ' << material.color.g << ' '
+               << material.color.b << ' ' << material.color.a
+               << (material.shader == MaterialShader::Circle ? " circle\n" : "\n");
+    }
+    if (!scene.materials.empty()) {
+        output << '\n';
+    }
+
+    for (const auto &node : scene.nodes) {
+        output << "node " << node.name;
+        if (node.parent != NoIndex) {
+            output << " parent " << scene.nodes[node.parent].name;
+        }
+        if (node.mesh != NoIndex) {
+            output << " mesh " << scene.meshes[node.mesh].name;
+        }
+        if (node.material != NoIndex) {
+            output << " material " << scene.materials[node.material].name;
+        }
+        if (node.position != glm::vec3(0.f)) {
+            output << " position " << node.position.x << ' ' << node.position.y << ' ' << node.position.z;
+        }
+        if (node.rotation != glm::quat(1.f, 0.f, 0.f, 0.f)) {
+            glm::vec3 axis = glm::axis(node.rotation);
+            output << " rotation " << glm::degrees(glm::angle(node.rotation)) << ' ' << axis.x << ' ' << axis.y << ' '
+                   << axis.z;
+        }
+        if (node.scale != glm::vec3(1.f)) {
+            output << " scale " << node.scale.x << ' ' << node.scale.y << ' ' << node.scale.z;
+        }
+        output << '\n';
+    }
+
+    output.precision(precision);
+}
+
+std::vector<char> scene::compileScene(const SceneDescription &scene) {
+    PROFILE_SCOPE("compileScene");
+    size_t nodeCount = scene.nodes.size();
+
+    for (const auto &mesh : scene.meshes) {
+        if (mesh.vertices.size() % 2 != 0 || mesh.indices.size() % 3 != 0) {
+            throw std::runtime_error("Mesh '" + mesh.name + "' has a partial vertex or triangle");
+        }
+        for (uint32_t vertex : mesh.indices) {
+            if (vertex >= mesh.vertices.size() / 2) {
+                throw std::runtime_error("Mesh '" + mesh.name + "' has an index out of range");
+            }
+        }
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        const auto &node = scene.nodes[i];
+        if ((node.parent != NoIndex && node.parent >= i) ||
+            (node.mesh != NoIndex && node.mesh >= scene.meshes.size()) ||
+            (node.material != NoIndex && node.material >= scene.materials.size())) {
+            throw std::runtime_error("Node '" + node.name + "' refers to something not declared before it");
+        }
+        if (node.mesh != NoIndex && node.material == NoIndex) {
+            throw std::runtime_error("Node '" + node.name + "' has a mesh but no material");
+        }
+    }
+
+    // Depth-first order, children in declaration order.
+    std::vector<uint32_t> childStart(nodeCount + 1, 0);
+    for (const auto &node : scene.nodes) {
+        if (node.parent != NoIndex) {
+            ++childStart[node.parent + 1];
+        }
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        childStart[i + 1] += childStart[i];
+    }
+    std::vector<uint32_t> children(childStart[nodeCount]);
+    std::vector<uint32_t> filled(childStart.begin(), childStart.end() - 1);
+    std::vector<uint32_t> stack;
+    for (size_t i = nodeCount; i-- > 0;) {
+        if (scene.nodes[i].parent == NoIndex) {
+            stack.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (scene.nodes[i].parent != NoIndex) {
+            children[filled[scene.nodes[i].parent]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> placed(nodeCount);
+    order.reserve(nodeCount);
+    while (!stack.empty()) {
+        uint32_t node = stack.back();
+        stack.pop_back();
+        placed[node] = static_cast<uint32_t>(order.size());
+        order.push_back(node);
+        for (uint32_t child = childStart[node + 1]; child-- > childStart[node];) {
+            stack.push_back(children[child]);
+        }
+    }
+
+    // World matrices as authored, then subtree bounds from the leaves up;
+    // in depth-first order every descendant comes after its ancestors.
+    std::vector<glm::mat4> world(nodeCount);
+    std::vector<glm::vec4> bounds(nodeCount);
+    std::vector<uint32_t> parents(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        const auto &node = scene.nodes[order[i]];
+        parents[i] = node.parent == NoIndex ? NoIndex : placed[node.parent];
+
+        glm::mat4 local = glm::translate(glm::mat4(1.f), node.position) * glm::mat4_cast(node.rotation) *
+                          glm::scale(glm::mat4(1.f), node.scale);
+        world[i] = parents[i] == NoIndex ? local : world[parents[i]] * local;
+
+        bounds[i] = glm::vec4(0.f, 0.f, 0.f, -1.f);
+        const MeshDescription *mesh = node.mesh == NoIndex ? nullptr : &scene.meshes[node.mesh];
+        if (mesh != nullptr && !mesh->vertices.empty()) {
+            glm::vec2 low(INFINITY);
+            glm::vec2 high(-INFINITY);
+            for (size_t vertex = 0; vertex < mesh->vertices.size(); vertex += 2) {
+                glm::vec2 position(mesh->vertices[vertex], mesh->vertices[vertex + 1]);
+                low = glm::min(low, position);
+                high = glm::max(high, position);
+            }
+
+            float scale = std::max({glm::length(glm::vec3(world[i][0])), glm::length(glm::vec3(world[i][1])),
+                                    glm::length(glm::vec3(world[i][2]))});
+            glm::vec4 center = world[i] * glm::vec4((low + high) * 0.5f, 0.f, 1.f);
+            bounds[i] = glm::vec4(glm::vec3(center), glm::length(high - low) * 0.5f * scale);
+        }
+    }
+
+    std::vector<uint32_t> subtreeSize(nodeCount, 1);
+    for (size_t i = nodeCount; i-- > 0;) {
+        if (parents[i] != NoIndex) {
+            subtreeSize[parents[i]] += subtreeSize[i];
+            bounds[parents[i]] = mergeSpheres(bounds[parents[i]], bounds[i]);
+        }
+    }
+
+    SceneHeader header = {};
+    header.magic = SceneMagic;
+    header.version = SceneVersion;
+    header.meshCount = static_cast<uint32_t>(scene.meshes.size());
+    header.materialCount = static_cast<uint32_t>(scene.materials.size());
+    header.nodeCount = static_cast<uint32_t>(nodeCount);
+
+    std::vector<SceneRoot> roots;
+    for (uint32_t root = 0; root < nodeCount; root += subtreeSize[root]) {
+        SceneRoot entry = {};
+        for (int component = 0; component < 4; ++component) {
+            entry.subtreeBounds[component] = bounds[root][component];
+        }
+        entry.node = root;
+        roots.push_back(entry);
+    }
+    header.rootCount = static_cast<uint32_t>(roots.size());
+
+    std::vector<SceneMesh> meshes;
+    for (const auto &source : scene.meshes) {
+        SceneMesh mesh = {};
+        mesh.firstVertex = header.vertexCount;
+        mesh.vertexCount = static_cast<uint32_t>(source.vertices.size() / 2);
+        mesh.firstIndex = header.indexCount;
+        mesh.indexCount = static_cast<uint32_t>(source.indices.size());
+        for (int axis = 0; axis < 2; ++axis) {
+            mesh.boundsMin[axis] = mesh.vertexCount == 0 ? 0.f : INFINITY;
+            mesh.boundsMax[axis] = mesh.vertexCount == 0 ? 0.f : -INFINITY;
+        }
+        for (size_t vertex = 0; vertex < source.vertices.size(); ++vertex) {
+            mesh.boundsMin[vertex % 2] = std::min(mesh.boundsMin[vertex % 2], source.vertices[vertex]);
+            mesh.boundsMax[vertex % 2] = std::max(mesh.boundsMax[vertex % 2], source.vertices[vertex]);
+        }
+        header.vertexCount += mesh.vertexCount;
+        header.indexCount += mesh.indexCount;
+        meshes.push_back(mesh);
+    }
+
+    header.rootOffset = alignUp(sizeof(SceneHeader));
+    header.meshOffset = alignUp(header.rootOffset + roots.size() * sizeof(SceneRoot));
+    header.materialOffset = alignUp(header.meshOffset + meshes.size() * sizeof(SceneMesh));
+    header.nodeOffset = alignUp(header.materialOffset + scene.materials.size() * sizeof(SceneMaterial));
+    header.vertexOffset = alignUp(header.nodeOffset + nodeCount * sizeof(SceneNode));
+    header.indexOffset = alignUp(header.vertexOffset + uint64_t(header.vertexCount) * 2 * sizeof(float));
+    std::vector<char> image(alignUp(header.indexOffset + uint64_t(header.indexCount) * sizeof(uint32_t)), 0);
+
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!roots.empty()) {
+        std::memcpy(image.data() + header.rootOffset, roots.data(), roots.size() * sizeof(SceneRoot));
+    }
+    if (!meshes.empty()) {
+        std::memcpy(image.data() + header.meshOffset, meshes.data(), meshes.size() * sizeof(SceneMesh));
+    }
+
+    auto *materials = reinterpret_cast<SceneMaterial *>(image.data() + header.materialOffset);
+    for (size_t i = 0; i < scene.materials.size(); ++i) {
+        const auto &source = scene.materials[i];
+        for (int channel = 0; channel < 4; ++channel) {
+            materials[i].color[channel] = source.color[channel];
+        }
+        materials[i].shader = static_cast<uint32_t>(source.shader);
+    }
+
+    auto *nodes = reinterpret_cast<SceneNode *>(image.data() + header.nodeOffset);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        const auto &source = scene.nodes[order[i]];
+        SceneNode &node = nodes[i];
+        for (int axis = 0; axis < 3; ++axis) {
+            node.position[axis] = source.position[axis];
+            node.scale[axis] = source.scale[axis];
+        }
+        node.rotation[0] = source.rotation.x;
+        node.rotation[1] = source.rotation.y;
+        node.rotation[2] = source.rotation.z;
+        node.rotation[3] = source.rotation.w;
+        for (int component = 0; component < 4; ++component) {
+            node.subtreeBounds[component] = bounds[i][component];
+        }
+        node.parent = parents[i];
+        node.subtreeEnd = static_cast<uint32_t>(i + subtreeSize[i]);
+        node.mesh = source.mesh;
+        node.material = source.material;
+    }
+
+    char *vertices = image.data() + header.vertexOffset;
+    char *indices = image.data() + header.indexOffset;
+    for (const auto &mesh : scene.meshes) {
+        size_t vertexBytes = mesh.vertices.size() * sizeof(float);
+        size_t indexBytes = mesh.indices.size() * sizeof(uint32_t);
+        if (vertexBytes != 0) {
+            std::memcpy(vertices, mesh.vertices.data(), vertexBytes);
+        }
+        if (indexBytes != 0) {
+            std::memcpy(indices, mesh.indices.data(), indexBytes);
+        }
+        vertices += vertexBytes;
+        indices += indexBytes;
+    }
+    return image;
+}
+
+std::unique_ptr<scene::SceneFile> scene::loadScene(const std::string &path) {
+    try {
+        return std::make_unique<SceneFile>(path);
+    } catch (const std::runtime_error &error) {
+        std::ifstream text(path + ".txt");
+        if (!text.is_open()) {
+            throw;
+        }
+        std::cerr << error.what() << "; compiling " << path << ".txt instead.\n";
+        return std::make_unique<SceneFile>(compileScene(parseSceneText(text, path + ".txt")), path + ".txt");
+    }
+}
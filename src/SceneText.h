@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "SceneFile.h"
+#include "SceneFormat.h"
+
+// The authoring form of a scene, one statement per line; '#' starts a
+// comment:
+//
+//   mesh <name>                  followed by vertex and triangle lines, then end
+//       vertex <x> <y>
+//       triangle <a> <b> <c>     indices into the mesh's own vertices
+//   end
+//   material <name> <r> <g> <b> <a> [circle]
+//   node <name> [parent <node>] [mesh <mesh>] [material <material>]
+//        [position <x> <y> <z>] [rotation <degrees> <axis x> <axis y> <axis z>]
+//        [scale <x> <y> <z>]
+//
+// Names are unique per kind and must be declared before they're referred to,
+// so a parent always comes before its children.
+namespace scene {
+    struct MeshDescription {
+        std::string name;
+        std::vector<float> vertices;     // 2 floats per vertex
+        std::vector<uint32_t> indices;
+    };
+
+    struct MaterialDescription {
+        std::string name;
+        glm::vec4 color = {1.f, 1.f, 1.f, 1.f};
+        MaterialShader shader = MaterialShader::Flat;
+    };
+
+    struct NodeDescription {
+        std::string name;
+        uint32_t parent = NoIndex;
+        uint32_t mesh = NoIndex;
+        uint32_t material = NoIndex;
+        glm::vec3 position = {0.f, 0.f, 0.f};
+        glm::quat rotation = {1.f, 0.f, 0.f, 0.f};
+        glm::vec3 scale = {1.f, 1.f, 1.f};
+    };
+
+    struct SceneDescription {
+        std::vector<MeshDescription> meshes;
+        std::vector<MaterialDescription> materials;
+        std::vector<NodeDescription> nodes;   // parents before children
+    };
+
+    // Throws std::runtime_error naming the source and line of the first error.
+    SceneDescription parseSceneText(std::istream &input, const std::string &sourceName);
+
+    // Writes a description parseSceneText reads back unchanged, up to float
+    // printing precision.
+    void writeSceneText(const SceneDescription &scene, std::ostream &output);
+
+    // Lays the description out in the SceneFormat.h binary form: nodes in
+    // depth-first order with their subtree bounds worked out from the
+    // authored transforms. Throws std::runtime_error on a mesh whose indices
+    // are out of range or on a node with a mesh but no material.
+    std::vector<char> compileScene(const SceneDescription &scene);
+
+    // The compiled scene at path, or the text form next to it (path + ".txt")
+    // when that hasn't been built, e.g. when running from the source tree.
+    // Throws std::runtime_error when neither loads.
+    std::unique_ptr<SceneFile> loadScene(const std::string &path);
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include "ShaderHotReload.h"
+
+shaders::ShaderHotReload::ShaderHotReload(ShaderLibrary &library)
+        : library(library),
+          watcher([this](const std::vector<std::string> &paths) { onFilesChanged(paths); }) {
+}
+
+shaders::ShaderHotReload::~ShaderHotReload() = default;
+
+shaders::ShaderHotReload::ProgramId shaders::ShaderHotReload::addProgram(const ProgramDesc &desc) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto vertex = preprocessor.preprocess(desc.vertexPath, desc.defines);
+    auto fragment = preprocessor.preprocess(desc.fragmentPath, desc.defines);
+
+    GLuint program = library.buildProgram(*vertex, *fragment, desc);
+
+    watchSources(*vertex);
+    watchSources(*fragment);
+
+    programs.push_back({desc, vertex->files.front(), fragment->files.front(), program, {}});
+    return programs.size() - 1;
+}
+
+GLint shaders::ShaderHotReload::getUniform(ProgramId id, const std::string &name) {
+    auto &uniforms = programs[id].uniforms;
+
+    auto cached = uniforms.find(name);
+    if (cached != uniforms.end()) {
+        return cached->second;
+    }
+
+    GLint location = library.getDispatch().getUniformLocation(programs[id].program, name.c_str());
+    uniforms[name] = location;
+    return location;
+}
+
+size_t shaders::ShaderHotReload::update() {
+    std::vector<Pending> ready;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        ready.swap(pending);
+    }
+
+    size_t swapped = 0;
+    for (const auto &build : ready) {
+        Program &entry = programs[build.id];
+
+        GLuint program;
+        try {
+            program = library.buildProgram(*build.vertex, *build.fragment, entry.desc);
+        } catch (std::runtime_error &exception) {
+            std::cerr << "Shader reload failed, keeping the previous program.\n" << exception.what() << '\n';
+            continue;
+        }
+
+        // Saved without a real change: the library handed back the same
+        // program, counting this build as another user.
+        if (program == entry.program) {
+            library.releaseProgram(program);
+            continue;
+        }
+
+        GLuint previous = entry.program;
+        entry.program = program;
+        for (auto &uniform : entry.uniforms) {
+            uniform.second = library.getDispatch().getUniformLocation(program, uniform.first.c_str());
+        }
+
+        if (reloadCallback) {
+            reloadCallback(build.id, program);
+        }
+        library.releaseProgram(previous);
+        ++swapped;
+    }
+
+    return swapped;
+}
+
+void shaders::ShaderHotReload::watchSources(const PreprocessedSource &source) {
+    for (const auto &file : source.files) {
+        auto directory = std::filesystem::path(file).parent_path().generic_string();
+        if (directory.empty()) {
+            directory = ".";
+        }
+
+        if (watchedDirectories.insert(directory).second) {
+            watcher.watchDirectory(directory);
+        }
+    }
+}
+
+void shaders::ShaderHotReload::onFilesChanged(const std::vector<std::string> &paths) {
+    std::vector<Pending> builds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::vector<std::string> roots;
+        for (const auto &path : paths) {
+            for (auto &root : preprocessor.invalidate(path)) {
+                roots.push_back(std::move(root));
+            }
+        }
+        if (roots.empty()) {
+            return;
+        }
+
+        for (ProgramId id = 0; id < programs.size(); ++id) {
+            const Program &program = programs[id];
+            bool affected = std::find(roots.begin(), roots.end(), program.vertexPath) != roots.end() ||
+                            std::find(roots.begin(), roots.end(), program.fragmentPath) != roots.end();
+            if (!affected) {
+                continue;
+            }
+
+            // An editor may still be writing, or an include may be missing for a
+            // moment; the next change event retries.
+            try {
+                auto vertex = preprocessor.preprocess(program.desc.vertexPath, program.desc.defines);
+                auto fragment = preprocessor.preprocess(program.desc.fragmentPath, program.desc.defines);
+                watchSources(*vertex);
+                watchSources(*fragment);
+                builds.push_back({id, vertex, fragment});
+            } catch (std::runtime_error &exception) {
+                std::cerr << "Shader reload skipped: " << exception.what() << '\n';
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (auto &build : builds) {
+        auto existing = std::find_if(pending.begin(), pending.end(),
+                                     [&build](const Pending &other) { return other.id == build.id; });
+        if (existing != pending.end()) {
+            *existing = std::move(build);
+        } else {
+            pending.push_back(std::move(build));
+        }
+    }
+}
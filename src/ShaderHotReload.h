@@ -0,0 +1,82 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileWatcher.h"
+#include "ShaderLibrary.h"
+
+namespace shaders {
+    // Rebuilds programs when any file they include changes on disk. The watcher
+    // thread maps the changed file to the programs depending on it and
+    // preprocesses their new sources; update(), called on the GL thread between
+    // frames, compiles and links them through the library and swaps them in.
+    // Only stages whose source changed are recompiled, since the library shares
+    // shader objects by source hash. A failed build keeps the old program.
+    class ShaderHotReload {
+    public:
+        using ProgramId = size_t;
+        using ReloadCallback = std::function<void(ProgramId id, GLuint program)>;
+
+        explicit ShaderHotReload(ShaderLibrary &library);
+        ~ShaderHotReload();
+
+        ShaderHotReload(const ShaderHotReload &) = delete;
+        ShaderHotReload &operator=(const ShaderHotReload &) = delete;
+
+        // Builds the program immediately; throws like ShaderLibrary::loadProgram.
+        ProgramId addProgram(const ProgramDesc &desc);
+
+        GLuint getProgram(ProgramId id) const { return programs[id].program; }
+
+        // Location in the current program. Every name asked for is re-queried
+        // whenever the program is swapped.
+        GLint getUniform(ProgramId id, const std::string &name);
+
+        // Called from update() after a program was swapped, before the old one is
+        // released.
+        void setReloadCallback(ReloadCallback callback) { reloadCallback = std::move(callback); }
+
+        // Returns the number of programs swapped.
+        size_t update();
+
+    private:
+        struct Program {
+            ProgramDesc desc;
+            std::string vertexPath;   // normalized
+            std::string fragmentPath; // normalized
+            GLuint program;
+            std::unordered_map<std::string, GLint> uniforms;
+        };
+
+        struct Pending {
+            ProgramId id;
+            std::shared_ptr<const PreprocessedSource> vertex;
+            std::shared_ptr<const PreprocessedSource> fragment;
+        };
+
+        void watchSources(const PreprocessedSource &source);
+        void onFilesChanged(const std::vector<std::string> &paths);
+
+        ShaderLibrary &library;
+        ReloadCallback reloadCallback;
+
+        // Guards the preprocessor, the program list and the watched directories,
+        // which are shared with the watcher thread.
+        std::mutex mutex;
+        ShaderPreprocessor preprocessor;
+        std::vector<Program> programs;
+        std::set<std::string> watchedDirectories;
+
+        std::mutex pendingMutex;
+        std::vector<Pending> pending;
+
+        // Last member: destroyed first, so the watcher thread is stopped before
+        // anything it uses goes away.
+        io::FileWatcher watcher;
+    };
+}
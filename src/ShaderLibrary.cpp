@@ -0,0 +1,277 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "ShaderLibrary.h"
+
+namespace {
+    const uint32_t BinaryMagic = 0x42504c47; // "GLPB"
+    const uint32_t BinaryVersion = 1;
+
+    struct BinaryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t driverHash;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    uint64_t hashString(const GLubyte *value, uint64_t seed) {
+        auto text = reinterpret_cast<const char *>(value);
+        return text == nullptr ? seed : hashing::fnv1a(text, std::strlen(text), seed);
+    }
+}
+
+shaders::ShaderLibrary::ShaderLibrary(render::GlDispatch &gl, std::string binaryCacheDirectory)
+        : gl(gl), cacheDirectory(std::move(binaryCacheDirectory)) {
+}
+
+shaders::ShaderLibrary::~ShaderLibrary() {
+    for (const auto &program : programs) {
+        gl.deleteProgram(program.second.program);
+    }
+    for (const auto &shader : shaderObjects) {
+        gl.deleteShader(shader.second.shader);
+    }
+}
+
+GLuint shaders::ShaderLibrary::loadProgram(const ProgramDesc &desc) {
+    auto vertex = preprocessor.preprocess(desc.vertexPath, desc.defines);
+    auto fragment = preprocessor.preprocess(desc.fragmentPath, desc.defines);
+
+    return buildProgram(*vertex, *fragment, desc);
+}
+
+GLuint shaders::ShaderLibrary::buildProgram(const PreprocessedSource &vertex, const PreprocessedSource &fragment,
+                                            const ProgramDesc &desc) {
+    PROFILE_SCOPE("ShaderLibrary::buildProgram");
+    initializeDriverInfo();
+
+    uint64_t key = hashing::fnv1a(&vertex.hash, sizeof(vertex.hash));
+    key = hashing::fnv1a(&fragment.hash, sizeof(fragment.hash), key);
+
+    auto existing = programs.find(key);
+    if (existing != programs.end()) {
+        ++existing->second.users;
+        return existing->second.program;
+    }
+
+    ProgramEntry entry = {loadBinary(key), 0, 0, 1};
+    if (entry.program != 0) {
+        ++stats.binaryHits;
+    } else {
+        ++stats.binaryMisses;
+        try {
+            entry.vertexKey = compileShader(GL_VERTEX_SHADER, vertex);
+            entry.fragmentKey = compileShader(GL_FRAGMENT_SHADER, fragment);
+            entry.program = linkProgram(shaderObjects[entry.vertexKey].shader,
+                                        shaderObjects[entry.fragmentKey].shader, desc);
+        } catch (const std::runtime_error &) {
+            // A stage compiled for this attempt alone would never be released.
+            deleteUnusedShaders();
+            throw;
+        }
+        ++shaderObjects[entry.vertexKey].users;
+        ++shaderObjects[entry.fragmentKey].users;
+        storeBinary(key, entry.program);
+    }
+
+    programs[key] = entry;
+    return entry.program;
+}
+
+void shaders::ShaderLibrary::releaseProgram(GLuint program) {
+    for (auto entry = programs.begin(); entry != programs.end(); ++entry) {
+        if (entry->second.program != program) {
+            continue;
+        }
+        if (--entry->second.users != 0) {
+            return;
+        }
+
+        for (uint64_t stageKey : {entry->second.vertexKey, entry->second.fragmentKey}) {
+            auto shader = shaderObjects.find(stageKey);
+            if (shader != shaderObjects.end() && --shader->second.users == 0) {
+                gl.deleteShader(shader->second.shader);
+                shaderObjects.erase(shader);
+            }
+        }
+
+        gl.deleteProgram(program);
+        programs.erase(entry);
+        return;
+    }
+}
+
+void shaders::ShaderLibrary::deleteUnusedShaders() {
+    for (auto shader = shaderObjects.begin(); shader != shaderObjects.end();) {
+        if (shader->second.users == 0) {
+            gl.deleteShader(shader->second.shader);
+            shader = shaderObjects.erase(shader);
+        } else {
+            ++shader;
+        }
+    }
+}
+
+void shaders::ShaderLibrary::initializeDriverInfo() {
+    if (driverInfoReady) {
+        return;
+    }
+    driverInfoReady = true;
+
+    driverHash = hashString(gl.getString(GL_VENDOR), hashing::Fnv1aBasis);
+    driverHash = hashString(gl.getString(GL_RENDERER), driverHash);
+    driverHash = hashString(gl.getString(GL_VERSION), driverHash);
+
+    GLint formats = 0;
+    gl.getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binariesSupported = formats > 0;
+}
+
+uint64_t shaders::ShaderLibrary::compileShader(GLenum stage, const PreprocessedSource &source) {
+    uint64_t key = hashing::fnv1a(&stage, sizeof(stage), source.hash);
+
+    auto existing = shaderObjects.find(key);
+    if (existing != shaderObjects.end()) {
+        ++stats.shaderReuses;
+        return key;
+    }
+
+    const char *native = source.source.c_str();
+    GLuint shader = gl.createShader(stage);
+    gl.shaderSource(shader, 1, &native, nullptr);
+    gl.compileShader(shader);
+    ++stats.shaderCompiles;
+
+    GLint success;
+    gl.getShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        GLchar info[512];
+        gl.getShaderInfoLog(shader, sizeof(info), nullptr, info);
+        gl.deleteShader(shader);
+
+        std::string message = "ERROR::SHADER COMPILE_FAILED '" + source.files.front() + "'\n" + info;
+        for (size_t i = 1; i < source.files.size(); ++i) {
+            message += "  source " + std::to_string(i) + ": " + source.files[i] + "\n";
+        }
+        throw std::runtime_error(message);
+    }
+
+    shaderObjects[key] = {shader, 0};
+    return key;
+}
+
+GLuint shaders::ShaderLibrary::linkProgram(GLuint vertexShader, GLuint fragmentShader, const ProgramDesc &desc) {
+    GLuint program = gl.createProgram();
+    gl.attachShader(program, vertexShader);
+    gl.attachShader(program, fragmentShader);
+    if (binariesSupported) {
+        gl.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    gl.linkProgram(program);
+    ++stats.programLinks;
+
+    GLint success;
+    gl.getProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLchar info[512];
+        gl.getProgramInfoLog(program, sizeof(info), nullptr, info);
+        gl.deleteProgram(program);
+
+        throw std::runtime_error("ERROR::SHADER LINK_FAILED '" + desc.vertexPath + "' + '" + desc.fragmentPath +
+                                 "'\n" + info);
+    }
+
+    // Shader objects stay alive in the cache for other programs; detaching lets
+    // the driver drop them once the cache releases them.
+    gl.detachShader(program, vertexShader);
+    gl.detachShader(program, fragmentShader);
+
+    return program;
+}
+
+GLuint shaders::ShaderLibrary::loadBinary(uint64_t key) {
+    if (!binariesSupported) {
+        return 0;
+    }
+
+    io::MappedFile file(binaryPath(key));
+    if (!file.isOpen() || file.size() < sizeof(BinaryHeader)) {
+        return 0;
+    }
+
+    BinaryHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != BinaryMagic || header.version != BinaryVersion || header.key != key ||
+        header.driverHash != driverHash || file.size() - sizeof(header) < header.length) {
+        return 0;
+    }
+
+    GLuint program = gl.createProgram();
+    gl.programBinary(program, header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.length));
+
+    // Drivers reject binaries after updates; that is a cache miss, not an error.
+    GLint success;
+    gl.getProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        gl.deleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void shaders::ShaderLibrary::storeBinary(uint64_t key, GLuint program) {
+    if (!binariesSupported) {
+        return;
+    }
+
+    GLint length = 0;
+    gl.getProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    gl.getProgramBinary(program, length, &length, &format, binary.data());
+
+    BinaryHeader header = {BinaryMagic, BinaryVersion, key, driverHash, format, static_cast<uint32_t>(length)};
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    // Written to a temporary name first so a concurrent or interrupted run never
+    // sees a half-written binary.
+    std::string path = binaryPath(key);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream stream(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            std::cerr << "Can't write program binary '" << temporaryPath << "'.\n";
+            return;
+        }
+
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(binary.data(), length);
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+std::string shaders::ShaderLibrary::binaryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+
+    return (std::filesystem::path(cacheDirectory) / name).string();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GlDispatch.h"
+#include "ShaderPreprocessor.h"
+
+namespace shaders {
+    struct ProgramDesc {
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::vector<std::string> defines;
+    };
+
+    // Builds programs from preprocessed sources. Shader objects are shared between
+    // programs by source hash, and linked programs are stored on disk with
+    // glGetProgramBinary, keyed by the hashes of both stages and the driver
+    // strings; a later run with unchanged sources only reads and hashes the files
+    // and loads the binary. Drivers without binary support, or binaries the driver
+    // rejects, fall back to a normal compile and link.
+    class ShaderLibrary {
+    public:
+        struct Stats {
+            size_t binaryHits = 0;
+            size_t binaryMisses = 0;
+            size_t shaderCompiles = 0;
+            size_t shaderReuses = 0;
+            size_t programLinks = 0;
+        };
+
+        explicit ShaderLibrary(render::GlDispatch &gl, std::string binaryCacheDirectory = "shader_cache");
+        ~ShaderLibrary();
+
+        ShaderLibrary(const ShaderLibrary &) = delete;
+        ShaderLibrary &operator=(const ShaderLibrary &) = delete;
+
+        // Needs a current context. Throws std::runtime_error with the info log when
+        // a stage fails to compile or the program fails to link.
+        GLuint loadProgram(const ProgramDesc &desc);
+        GLuint buildProgram(const PreprocessedSource &vertex, const PreprocessedSource &fragment,
+                            const ProgramDesc &desc);
+
+        // Programs are counted per call of loadProgram/buildProgram, which hand
+        // the same program back for the same sources; each needs a release.
+        // The last one deletes the program and any shader object no other
+        // cached program was built from.
+        void releaseProgram(GLuint program);
+
+        ShaderPreprocessor &getPreprocessor() { return preprocessor; }
+        render::GlDispatch &getDispatch() { return gl; }
+        const Stats &getStats() const { return stats; }
+
+    private:
+        void initializeDriverInfo();
+        struct ShaderEntry {
+            GLuint shader;
+            size_t users;
+        };
+
+        struct ProgramEntry {
+            GLuint program;
+            uint64_t vertexKey;   // 0 when the program came from a binary
+            uint64_t fragmentKey;
+            size_t users;
+        };
+
+        uint64_t compileShader(GLenum stage, const PreprocessedSource &source);
+        GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader, const ProgramDesc &desc);
+        void deleteUnusedShaders();
+        GLuint loadBinary(uint64_t key);
+        void storeBinary(uint64_t key, GLuint program);
+        std::string binaryPath(uint64_t key) const;
+
+        render::GlDispatch &gl;
+        ShaderPreprocessor preprocessor;
+        std::string cacheDirectory;
+
+        bool driverInfoReady = false;
+        bool binariesSupported = false;
+        uint64_t driverHash = 0;
+
+        std::unordered_map<uint64_t, ShaderEntry> shaderObjects;
+        std::unordered_map<uint64_t, ProgramEntry> programs;
+        Stats stats;
+    };
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_set>
+#include "Hash.h"
+#include "MappedFile.h"
+#include "ShaderPreprocessor.h"
+
+namespace {
+    bool readMappedFile(const std::string &path, std::string &contents) {
+        io::MappedFile file(path);
+        if (!file.isOpen()) {
+            return false;
+        }
+
+        contents.assign(file.data(), file.size());
+        return true;
+    }
+
+    // Returns the directive name of a preprocessor line ("include", "version", ...)
+    // and leaves `rest` pointing after it, or an empty string for other lines.
+    std::string directive(const std::string &line, size_t &rest) {
+        size_t position = line.find_first_not_of(" \t");
+        if (position == std::string::npos || line[position] != '#') {
+            return "";
+        }
+
+        position = line.find_first_not_of(" \t", position + 1);
+        if (position == std::string::npos) {
+            return "";
+        }
+
+        size_t end = position;
+        while (end < line.size() && std::isalpha(static_cast<unsigned char>(line[end]))) {
+            ++end;
+        }
+
+        rest = end;
+        return line.substr(position, end - position);
+    }
+
+    std::string defineLine(const std::string &define) {
+        std::string line = "#define " + define;
+        auto separator = line.find('=');
+        if (separator != std::string::npos) {
+            line[separator] = ' ';
+        }
+
+        return line + "\n";
+    }
+}
+
+struct shaders::ShaderPreprocessor::Expansion {
+    const std::vector<std::string> &defines;
+    std::string out;
+    std::vector<std::string> files;
+    std::vector<std::string> stack;
+    std::unordered_set<std::string> included;
+};
+
+shaders::ShaderPreprocessor::ShaderPreprocessor() : reader(readMappedFile) {
+}
+
+shaders::ShaderPreprocessor::ShaderPreprocessor(FileReader reader) : reader(std::move(reader)) {
+}
+
+void shaders::ShaderPreprocessor::addIncludeDirectory(const std::string &directory) {
+    includeDirectories.push_back(normalizePath(directory));
+    resolvedIncludes.clear();
+}
+
+std::string shaders::ShaderPreprocessor::normalizePath(const std::string &path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::shared_ptr<const shaders::PreprocessedSource>
+shaders::ShaderPreprocessor::preprocess(const std::string &path, const std::vector<std::string> &defines) {
+    std::string root = normalizePath(path);
+
+    std::string key = root;
+    for (const auto &define : defines) {
+        key += '\n';
+        key += define;
+    }
+
+    auto cached = results.find(key);
+    if (cached != results.end()) {
+        ++stats.resultHits;
+        return cached->second;
+    }
+    ++stats.resultMisses;
+
+    if (tryLoadFile(root) == nullptr) {
+        throw std::runtime_error("Can't read shader source '" + root + "'");
+    }
+
+    Expansion expansion{defines, {}, {}, {}, {}};
+    expand(root, expansion);
+
+    auto result = std::make_shared<PreprocessedSource>();
+    result->hash = hashing::fnv1a(expansion.out.data(), expansion.out.size());
+    result->source = std::move(expansion.out);
+    result->files = std::move(expansion.files);
+
+    results[key] = result;
+    return result;
+}
+
+std::vector<std::string> shaders::ShaderPreprocessor::invalidate(const std::string &path) {
+    std::string file = normalizePath(path);
+    files.erase(file);
+    resolvedIncludes.clear();
+
+    std::vector<std::string> roots;
+    for (auto result = results.begin(); result != results.end();) {
+        const auto &dependencies = result->second->files;
+        if (std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end()) {
+            ++result;
+            continue;
+        }
+
+        if (std::find(roots.begin(), roots.end(), dependencies.front()) == roots.end()) {
+            roots.push_back(dependencies.front());
+        }
+        result = results.erase(result);
+    }
+
+    return roots;
+}
+
+const shaders::ShaderPreprocessor::File *shaders::ShaderPreprocessor::tryLoadFile(const std::string &path) {
+    auto cached = files.find(path);
+    if (cached != files.end()) {
+        return &cached->second;
+    }
+
+    std::string contents;
+    if (!reader(path, contents)) {
+        return nullptr;
+    }
+    ++stats.fileReads;
+
+    File file;
+    size_t start = 0;
+    while (start <= contents.size()) {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos) {
+            end = contents.size();
+        }
+
+        Line line;
+        line.text = contents.substr(start, end - start);
+        if (!line.text.empty() && line.text.back() == '\r') {
+            line.text.pop_back();
+        }
+
+        size_t rest = 0;
+        std::string name = directive(line.text, rest);
+        if (name == "include") {
+            size_t open = line.text.find_first_of("\"<", rest);
+            size_t close = open == std::string::npos ? open : line.text.find_first_of("\">", open + 1);
+            if (close == std::string::npos) {
+                throw std::runtime_error("Malformed #include in '" + path + "': " + line.text);
+            }
+            line.include = line.text.substr(open + 1, close - open - 1);
+        } else if (name == "pragma" && line.text.find("once", rest) != std::string::npos) {
+            file.pragmaOnce = true;
+            line.text.clear();
+        } else if (name == "version" && file.versionLine < 0) {
+            file.versionLine = static_cast<int>(file.lines.size());
+        }
+
+        file.lines.push_back(std::move(line));
+        if (end == contents.size()) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    return &files.emplace(path, std::move(file)).first->second;
+}
+
+std::string shaders::ShaderPreprocessor::resolveInclude(const std::string &from, const std::string &name) {
+    std::string key = from + '\n' + name;
+    auto cached = resolvedIncludes.find(key);
+    if (cached != resolvedIncludes.end()) {
+        return cached->second;
+    }
+
+    std::vector<std::string> candidates = {
+            normalizePath((std::filesystem::path(from).parent_path() / name).generic_string())
+    };
+    for (const auto &directory : includeDirectories) {
+        candidates.push_back(normalizePath((std::filesystem::path(directory) / name).generic_string()));
+    }
+
+    for (const auto &candidate : candidates) {
+        if (tryLoadFile(candidate) != nullptr) {
+            resolvedIncludes[key] = candidate;
+            return candidate;
+        }
+    }
+
+    throw std::runtime_error("Can't resolve #include \"" + name + "\" in '" + from + "'");
+}
+
+void shaders::ShaderPreprocessor::expand(const std::string &path, Expansion &expansion) {
+    if (std::find(expansion.stack.begin(), expansion.stack.end(), path) != expansion.stack.end()) {
+        std::string cycle;
+        for (const auto &file : expansion.stack) {
+            cycle += file + " -> ";
+        }
+        throw std::runtime_error("Shader include cycle: " + cycle + path);
+    }
+
+    const File &file = *tryLoadFile(path);
+    bool root = expansion.stack.empty();
+
+    if (file.pragmaOnce && !expansion.included.insert(path).second) {
+        return;
+    }
+
+    auto found = std::find(expansion.files.begin(), expansion.files.end(), path);
+    auto index = std::to_string(found - expansion.files.begin());
+    if (found == expansion.files.end()) {
+        expansion.files.push_back(path);
+    }
+
+    expansion.stack.push_back(path);
+
+    if (root && file.versionLine < 0) {
+        for (const auto &define : expansion.defines) {
+            expansion.out += defineLine(define);
+        }
+        expansion.out += "#line 1 0\n";
+    } else if (!root) {
+        expansion.out += "#line 1 " + index + "\n";
+    }
+
+    for (size_t i = 0; i < file.lines.size(); ++i) {
+        const Line &line = file.lines[i];
+        auto nextLine = std::to_string(i + 2);
+
+        if (!line.include.empty()) {
+            expand(resolveInclude(path, line.include), expansion);
+            expansion.out += "#line " + nextLine + " " + index + "\n";
+        } else if (static_cast<int>(i) == file.versionLine) {
+            if (!root) {
+                // Only the root file may declare the version.
+                expansion.out += "\n";
+                continue;
+            }
+
+            expansion.out += line.text + "\n";
+            for (const auto &define : expansion.defines) {
+                expansion.out += defineLine(define);
+            }
+            expansion.out += "#line " + nextLine + " 0\n";
+        } else {
+            expansion.out += line.text + "\n";
+        }
+    }
+
+    expansion.stack.pop_back();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace shaders {
+    // Output of preprocessing one root file with one set of defines.
+    struct PreprocessedSource {
+        std::string source;
+        uint64_t hash;                   // FNV-1a of source
+        std::vector<std::string> files;  // root first, then every file it includes
+    };
+
+    // Expands `#include "file"` / `#include <file>` and injects `#define`s right
+    // after the `#version` line. Files are resolved relative to the including file
+    // and then against the include directories; `#pragma once` is honoured and
+    // include cycles are reported. `#line` directives keep compiler messages
+    // pointing at the original file: the source-string number is the index into
+    // PreprocessedSource::files.
+    //
+    // Parsed files and expanded results are cached until invalidate() is called
+    // for a file they depend on. No GL is involved, and the file reader can be
+    // swapped out for tests.
+    class ShaderPreprocessor {
+    public:
+        using FileReader = std::function<bool(const std::string &path, std::string &contents)>;
+
+        ShaderPreprocessor();
+        explicit ShaderPreprocessor(FileReader reader);
+
+        void addIncludeDirectory(const std::string &directory);
+
+        // Throws std::runtime_error for missing files and include cycles.
+        std::shared_ptr<const PreprocessedSource> preprocess(const std::string &path,
+                                                             const std::vector<std::string> &defines = {});
+
+        // Drops the cached file and every result that includes it. Returns the
+        // root paths of the dropped results.
+        std::vector<std::string> invalidate(const std::string &path);
+
+        static std::string normalizePath(const std::string &path);
+
+        struct Stats {
+            size_t fileReads = 0;
+            size_t resultHits = 0;
+            size_t resultMisses = 0;
+        };
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        struct Line {
+            std::string text;
+            std::string include; // name between the quotes when the line is an #include
+        };
+
+        struct File {
+            std::vector<Line> lines;
+            bool pragmaOnce = false;
+            int versionLine = -1;
+        };
+
+        struct Expansion;
+
+        const File *tryLoadFile(const std::string &path);
+        std::string resolveInclude(const std::string &from, const std::string &name);
+        void expand(const std::string &path, Expansion &expansion);
+
+        FileReader reader;
+        std::vector<std::string> includeDirectories;
+        std::unordered_map<std::string, File> files;
+        std::unordered_map<std::string, std::shared_ptr<const PreprocessedSource>> results;
+        std::unordered_map<std::string, std::string> resolvedIncludes;
+        Stats stats;
+    };
+}
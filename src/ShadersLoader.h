@@ -1,5 +0,0 @@
-#pragma once
-
-namespace shaders {
-    std::string loadShaderSourceFromFile(const char *path);
-}
\ No newline at end of file
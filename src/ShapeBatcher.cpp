@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "Profiler.h"
+#include "ShapeBatcher.h"
+
+namespace {
+    uint8_t toUnorm8(float value) {
+        return static_cast<uint8_t>(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+    }
+
+    render::ShapeInstance makeShape(render::ShapeType type, glm::vec2 center, glm::vec2 halfSize, float parameter,
+                                    const glm::vec4 &color) {
+        render::ShapeInstance shape;
+        shape.center[0] = center.x;
+        shape.center[1] = center.y;
+        shape.halfSize[0] = halfSize.x;
+        shape.halfSize[1] = halfSize.y;
+        shape.parameter = parameter;
+        shape.color[0] = toUnorm8(color.r);
+        shape.color[1] = toUnorm8(color.g);
+        shape.color[2] = toUnorm8(color.b);
+        shape.color[3] = toUnorm8(color.a);
+        shape.type = type;
+        shape.padding[0] = shape.padding[1] = shape.padding[2] = 0;
+        return shape;
+    }
+
+    float roundedBoxDistance(glm::vec2 point, glm::vec2 halfSize, float cornerRadius) {
+        float qx = std::abs(point.x) - halfSize.x + cornerRadius;
+        float qy = std::abs(point.y) - halfSize.y + cornerRadius;
+        float outside = std::sqrt(std::max(qx, 0.f) * std::max(qx, 0.f) + std::max(qy, 0.f) * std::max(qy, 0.f));
+        return outside + std::min(std::max(qx, qy), 0.f) - cornerRadius;
+    }
+}
+
+render::ShapeInstance render::makeCircle(glm::vec2 center, float radius, const glm::vec4 &color) {
+    return makeShape(ShapeType::Circle, center, {radius, radius}, 0.f, color);
+}
+
+render::ShapeInstance render::makeNdcCircle(glm::vec2 center, float radius, glm::vec2 viewport,
+                                           const glm::vec4 &color) {
+    // Pixels count down from the top.
+    return makeCircle({(center.x + 1.f) * 0.5f * viewport.x, (1.f - center.y) * 0.5f * viewport.y},
+                      radius * 0.5f * viewport.y, color);
+}
+
+render::ShapeInstance render::makeRing(glm::vec2 center, float radius, float thickness, const glm::vec4 &color) {
+    if (thickness >= radius) {
+        return makeCircle(center, radius, color);
+    }
+    return makeShape(ShapeType::Ring, center, {radius, radius}, std::max(thickness, 0.f), color);
+}
+
+render::ShapeInstance render::makeRoundedRect(glm::vec2 center, glm::vec2 halfSize, float cornerRadius,
+                                              const glm::vec4 &color) {
+    float corner = std::min(std::max(cornerRadius, 0.f), std::min(halfSize.x, halfSize.y));
+    return makeShape(ShapeType::RoundedRect, center, halfSize, corner, color);
+}
+
+float render::shapeDistance(const ShapeInstance &shape, glm::vec2 point) {
+    glm::vec2 local(point.x - shape.center[0], point.y - shape.center[1]);
+    float radius = shape.halfSize[0];
+
+    switch (shape.type) {
+        case ShapeType::Circle:
+            return std::sqrt(local.x * local.x + local.y * local.y) - radius;
+        case ShapeType::Ring: {
+            float halfBand = shape.parameter * 0.5f;
+            return std::abs(std::sqrt(local.x * local.x + local.y * local.y) - (radius - halfBand)) - halfBand;
+        }
+        case ShapeType::RoundedRect:
+            return roundedBoxDistance(local, {shape.halfSize[0], shape.halfSize[1]}, shape.parameter);
+    }
+    return 0.f;
+}
+
+float render::shapeCoverage(const ShapeInstance &shape, glm::vec2 point) {
+    // Distances are in pixels, so a one pixel ramp centred on the outline
+    // approximates the pixel's covered area.
+    return std::min(std::max(0.5f - shapeDistance(shape, point), 0.f), 1.f);
+}
+
+render::ShapeBatcher::ShapeBatcher(GlDispatch &gl, size_t initialCapacity) : gl(gl) {
+    gl.genVertexArrays(1, &vao);
+    gl.genBuffers(1, &buffer);
+    gl.bindVertexArray(vao);
+    allocate(std::max<size_t>(initialCapacity, 1));
+
+    // The quad corners come from gl_VertexID; every attribute is per instance.
+    const GLsizei stride = sizeof(ShapeInstance);
+    gl.vertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride,
+                           reinterpret_cast<const GLvoid *>(offsetof(ShapeInstance, center)));
+    gl.vertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride,
+                           reinterpret_cast<const GLvoid *>(offsetof(ShapeInstance, parameter)));
+    gl.vertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                           reinterpret_cast<const GLvoid *>(offsetof(ShapeInstance, color)));
+    gl.vertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride,
+                           reinterpret_cast<const GLvoid *>(offsetof(ShapeInstance, type)));
+    for (GLuint index = 0; index < 4; ++index) {
+        gl.enableVertexAttribArray(index);
+        gl.vertexAttribDivisor(index, 1);
+    }
+
+    gl.bindVertexArray(0);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+render::ShapeBatcher::~ShapeBatcher() {
+    gl.deleteVertexArrays(1, &vao);
+    gl.deleteBuffers(1, &buffer);
+}
+
+void render::ShapeBatcher::setProgram(GLuint program, GLint viewportLocation) {
+    this->program = program;
+    this->viewportLocation = viewportLocation;
+    // A new program starts with default uniform values.
+    viewportSet = false;
+    bindingsValid = false;
+}
+
+void render::ShapeBatcher::invalidateBindings() {
+    bindingsValid = false;
+}
+
+void render::ShapeBatcher::flush(glm::vec2 viewportSize) {
+    PROFILE_SCOPE("ShapeBatcher::flush");
+    stats.instances = 0;
+    stats.bytesUploaded = 0;
+    if (instances.empty() || program == 0) {
+        instances.clear();
+        return;
+    }
+
+    if (instances.size() > stats.capacity) {
+        allocate(std::max(instances.size(), stats.capacity * 2));
+    } else {
+        // Orphan last frame's storage instead of waiting for the GPU to finish
+        // reading it.
+        gl.bindBuffer(GL_ARRAY_BUFFER, buffer);
+        gl.bufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(stats.capacity * sizeof(ShapeInstance)), nullptr,
+                      GL_STREAM_DRAW);
+    }
+
+    size_t bytes = instances.size() * sizeof(ShapeInstance);
+    gl.bufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), instances.data());
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!bindingsValid) {
+        gl.useProgram(program);
+        gl.bindVertexArray(vao);
+        bindingsValid = true;
+    }
+    // Only the batcher sets this program's uniform and the blend function.
+    if (!viewportSet || viewportSize != lastViewport) {
+        gl.uniform2f(viewportLocation, viewportSize.x, viewportSize.y);
+        lastViewport = viewportSize;
+        viewportSet = true;
+    }
+    gl.enable(GL_BLEND);
+    if (!blendFuncSet) {
+        gl.blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        blendFuncSet = true;
+    }
+    gl.drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+    gl.disable(GL_BLEND);
+
+    stats.instances = instances.size();
+    stats.bytesUploaded = bytes;
+    instances.clear();
+}
+
+// Leaves the instance buffer bound to GL_ARRAY_BUFFER.
+void render::ShapeBatcher::allocate(size_t capacity) {
+    gl.bindBuffer(GL_ARRAY_BUFFER, buffer);
+    gl.bufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(ShapeInstance)), nullptr,
+                  GL_STREAM_DRAW);
+    stats.capacity = capacity;
+}
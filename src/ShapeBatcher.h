@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include "GlDispatch.h"
+
+namespace render {
+    enum class ShapeType : uint8_t {
+        Circle,
+        Ring,
+        RoundedRect
+    };
+
+    // One shape as it sits in the instance buffer. Positions and sizes are in
+    // framebuffer pixels, origin at the top left, y down.
+    struct ShapeInstance {
+        float center[2];
+        float halfSize[2];   // circles and rings: the radius twice
+        float parameter;     // ring: band width inside the radius; rounded rect: corner radius
+        uint8_t color[4];    // RGBA8, straight alpha
+        ShapeType type;
+        uint8_t padding[3];
+    };
+
+    static_assert(sizeof(ShapeInstance) == 28, "ShapeInstance is read by shape_vertex.glsl with a fixed layout");
+
+    ShapeInstance makeCircle(glm::vec2 center, float radius, const glm::vec4 &color);
+    // A circle in NDC, as the scene places them, on a viewport of the given
+    // size in pixels. The radius is in units of half the viewport height, so
+    // the circle stays round whatever the aspect.
+    ShapeInstance makeNdcCircle(glm::vec2 center, float radius, glm::vec2 viewport, const glm::vec4 &color);
+    // The band lies inside the radius; a thickness at or above the radius
+    // makes a filled circle.
+    ShapeInstance makeRing(glm::vec2 center, float radius, float thickness, const glm::vec4 &color);
+    // Corner radii above the shorter half side are clamped to it.
+    ShapeInstance makeRoundedRect(glm::vec2 center, glm::vec2 halfSize, float cornerRadius, const glm::vec4 &color);
+
+    // Signed distance in pixels from the shape's outline, negative inside.
+    // Mirrors shape_fragment.glsl; point is in the same space as the center.
+    float shapeDistance(const ShapeInstance &shape, glm::vec2 point);
+
+    // Fraction of the pixel centred on point that the shape covers, with the
+    // same analytic anti-aliasing as shape_fragment.glsl.
+    float shapeCoverage(const ShapeInstance &shape, glm::vec2 point);
+
+    // Batches 2D primitives into a per-frame instance buffer and draws all of
+    // them with one instanced draw of a 4-vertex strip. Each instance expands to
+    // a quad one pixel larger than the shape and the fragment shader evaluates
+    // the shape's distance function in the quad's local pixel space, so edges
+    // are anti-aliased without discard and without a per-shape uniform. Shapes
+    // draw in submission order with premultiplied alpha blending.
+    //
+    // flush() binds its own program and vertex array and leaves blending off;
+    // anything caching bound state (e.g. RenderQueue) must be invalidated after.
+    // The batcher keeps them bound across flushes in turn, so GL code that
+    // changes the program or vertex array binding in between must call
+    // invalidateBindings(). The blend function and the viewport uniform are
+    // only set when they change, so nothing else may set them.
+    class ShapeBatcher {
+    public:
+        struct Stats {
+            size_t instances = 0;        // drawn by the last flush
+            size_t bytesUploaded = 0;    // by the last flush
+            size_t capacity = 0;         // instances the GL buffer holds
+        };
+
+        explicit ShapeBatcher(GlDispatch &gl, size_t initialCapacity = 1 << 10);
+        ~ShapeBatcher();
+
+        ShapeBatcher(const ShapeBatcher &) = delete;
+        ShapeBatcher &operator=(const ShapeBatcher &) = delete;
+
+        // The program built from shape_vertex.glsl and shape_fragment.glsl and
+        // the location of its viewportSize uniform; call again after a reload.
+        void setProgram(GLuint program, GLint viewportLocation);
+        void invalidateBindings();
+
+        void addCircle(glm::vec2 center, float radius, const glm::vec4 &color) {
+            instances.push_back(makeCircle(center, radius, color));
+        }
+        void addRing(glm::vec2 center, float radius, float thickness, const glm::vec4 &color) {
+            instances.push_back(makeRing(center, radius, thickness, color));
+        }
+        void addRoundedRect(glm::vec2 center, glm::vec2 halfSize, float cornerRadius, const glm::vec4 &color) {
+            instances.push_back(makeRoundedRect(center, halfSize, cornerRadius, color));
+        }
+        void addInstances(const ShapeInstance *shapes, size_t count) {
+            instances.insert(instances.end(), shapes, shapes + count);
+        }
+
+        const std::vector<ShapeInstance> &getInstances() const { return instances; }
+        void clear() { instances.clear(); }
+
+        // Uploads the batch, draws it and clears it for the next frame.
+        void flush(glm::vec2 viewportSize);
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        void allocate(size_t capacity);
+
+        GlDispatch &gl;
+        GLuint vao = 0;
+        GLuint buffer = 0;
+        GLuint program = 0;
+        GLint viewportLocation = -1;
+
+        bool bindingsValid = false;
+        bool viewportSet = false;
+        glm::vec2 lastViewport = {0.f, 0.f};
+        bool blendFuncSet = false;
+
+        std::vector<ShapeInstance> instances;
+        Stats stats;
+    };
+}
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "Profiler.h"
+#include "SoftwareRasterizer.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RASTER_SSE2 1
+#endif
+
+namespace {
+    uint32_t packColor(const glm::vec4 &color) {
+        auto channel = [](float value) {
+            return static_cast<uint32_t>(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+        };
+
+        return channel(color.r) | channel(color.g) << 8 | channel(color.b) << 16 | channel(color.a) << 24;
+    }
+}
+
+raster::SoftwareRasterizer::SoftwareRasterizer(int width, int height, threading::ThreadPool &pool, int tileSize)
+        : width(width),
+          height(height),
+          tileSize(tileSize),
+          tilesX((width + tileSize - 1) / tileSize),
+          tilesY((height + tileSize - 1) / tileSize),
+          pool(pool),
+          pixels(static_cast<size_t>(width) * height, 0),
+          bins(static_cast<size_t>(tilesX) * tilesY) {
+}
+
+void raster::SoftwareRasterizer::clear(const glm::vec4 &color) {
+    // Deferred to flush() so every tile clears its own pixels on its worker.
+    clearValue = packColor(color);
+    clearPending = true;
+}
+
+void raster::SoftwareRasterizer::draw(const DrawCall &call) {
+    PROFILE_SCOPE("SoftwareRasterizer::draw");
+    auto drawIndex = static_cast<uint32_t>(draws.size());
+    draws.push_back(call);
+
+    for (size_t i = 0; i + 2 < call.indexCount; i += 3) {
+        glm::vec2 v[3];
+        for (int k = 0; k < 3; ++k) {
+            const float *p = call.positions + call.indices[i + k] * 2;
+            v[k] = {(p[0] + 1.f) * 0.5f * width, (p[1] + 1.f) * 0.5f * height};
+        }
+
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+        if (area == 0.f) {
+            continue;
+        }
+        if (area < 0.f) {
+            std::swap(v[1], v[2]);
+        }
+
+        Triangle triangle;
+        for (int k = 0; k < 3; ++k) {
+            const glm::vec2 &from = v[k];
+            const glm::vec2 &to = v[(k + 1) % 3];
+            float dx = to.x - from.x;
+            float dy = to.y - from.y;
+
+            // The constant term is taken from the lexicographically smaller end so a
+            // shared edge evaluates to exactly the negated value in the neighbour.
+            const glm::vec2 &base = (from.x < to.x || (from.x == to.x && from.y < to.y)) ? from : to;
+            triangle.a[k] = -dy;
+            triangle.b[k] = dx;
+            triangle.c[k] = dy * base.x - dx * base.y;
+            triangle.topLeft[k] = dy < 0.f || (dy == 0.f && dx < 0.f);
+        }
+
+        triangle.minX = std::max(0, static_cast<int>(std::floor(std::min({v[0].x, v[1].x, v[2].x}))));
+        triangle.minY = std::max(0, static_cast<int>(std::floor(std::min({v[0].y, v[1].y, v[2].y}))));
+        triangle.maxX = std::min(width - 1, static_cast<int>(std::ceil(std::max({v[0].x, v[1].x, v[2].x}))));
+        triangle.maxY = std::min(height - 1, static_cast<int>(std::ceil(std::max({v[0].y, v[1].y, v[2].y}))));
+        triangle.draw = drawIndex;
+
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            continue;
+        }
+
+        auto triangleIndex = static_cast<uint32_t>(triangles.size());
+        triangles.push_back(triangle);
+
+        for (int ty = triangle.minY / tileSize; ty <= triangle.maxY / tileSize; ++ty) {
+            for (int tx = triangle.minX / tileSize; tx <= triangle.maxX / tileSize; ++tx) {
+                bins[ty * tilesX + tx].push_back(triangleIndex);
+            }
+        }
+    }
+}
+
+void raster::SoftwareRasterizer::flush() {
+    PROFILE_SCOPE("SoftwareRasterizer::flush");
+    pool.parallelFor(bins.size(), [this](size_t tile) { shadeTile(tile); });
+
+    for (auto &bin : bins) {
+        bin.clear();
+    }
+    triangles.clear();
+    draws.clear();
+    clearPending = false;
+}
+
+void raster::SoftwareRasterizer::shadeTile(size_t tile) {
+    PROFILE_SCOPE("SoftwareRasterizer::shadeTile");
+    int tileX0 = static_cast<int>(tile % tilesX) * tileSize;
+    int tileY0 = static_cast<int>(tile / tilesX) * tileSize;
+    int tileX1 = std::min(width, tileX0 + tileSize) - 1;
+    int tileY1 = std::min(height, tileY0 + tileSize) - 1;
+
+    if (clearPending) {
+        for (int y = tileY0; y <= tileY1; ++y) {
+            uint32_t *row = pixels.data() + static_cast<size_t>(y) * width;
+            std::fill(row + tileX0, row + tileX1 + 1, clearValue);
+        }
+    }
+
+    float halfWidth = width * 0.5f;
+    float halfHeight = height * 0.5f;
+
+    for (uint32_t triangleIndex : bins[tile]) {
+        const Triangle &t = triangles[triangleIndex];
+        const DrawCall &call = draws[t.draw];
+        uint32_t color = packColor(call.color);
+        bool circle = call.shader == Shader::Circle;
+        glm::vec2 circleCenter((call.center.x + 1.f) * halfWidth, (call.center.y + 1.f) * halfHeight);
+        float circleRadius = call.radius * halfHeight;
+        float radiusSquared = circleRadius * circleRadius;
+
+        int x0 = std::max(tileX0, t.minX);
+        int x1 = std::min(tileX1, t.maxX);
+        int y0 = std::max(tileY0, t.minY);
+        int y1 = std::min(tileY1, t.maxY);
+
+        for (int y = y0; y <= y1; ++y) {
+            uint32_t *row = pixels.data() + static_cast<size_t>(y) * width;
+            float py = y + 0.5f;
+            float dyCenter = circleCenter.y - py;
+
+#ifdef RASTER_SSE2
+            __m128 rowEdge[3];
+            for (int k = 0; k < 3; ++k) {
+                rowEdge[k] = _mm_set1_ps(t.b[k] * py + t.c[k]);
+            }
+            __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 limit = _mm_set1_ps(static_cast<float>(x1 + 1));
+            __m128 zero = _mm_setzero_ps();
+            __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+
+            for (int x = x0; x <= x1; x += 4) {
+                __m128 xs = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+                __m128 mask = _mm_cmplt_ps(xs, limit);
+
+                for (int k = 0; k < 3; ++k) {
+                    __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[k]), xs), rowEdge[k]);
+                    mask = _mm_and_ps(mask, t.topLeft[k] ? _mm_cmpge_ps(edge, zero) : _mm_cmpgt_ps(edge, zero));
+                }
+
+                if (circle) {
+                    __m128 dx = _mm_sub_ps(_mm_set1_ps(circleCenter.x), xs);
+                    __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_set1_ps(dyCenter * dyCenter));
+                    mask = _mm_and_ps(mask, _mm_cmple_ps(distance, _mm_set1_ps(radiusSquared)));
+                }
+
+                int bits = _mm_movemask_ps(mask);
+                if (bits == 0xF) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), colors);
+                } else {
+                    for (int lane = 0; bits != 0; ++lane, bits >>= 1) {
+                        if (bits & 1) {
+                            row[x + lane] = color;
+                        }
+                    }
+                }
+            }
+#else
+            for (int x = x0; x <= x1; ++x) {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int k = 0; k < 3 && inside; ++k) {
+                    float edge = t.a[k] * px + (t.b[k] * py + t.c[k]);
+                    inside = t.topLeft[k] ? edge >= 0.f : edge > 0.f;
+                }
+
+                if (inside && circle) {
+                    float dx = circleCenter.x - px;
+                    inside = dx * dx + dyCenter * dyCenter <= radiusSquared;
+                }
+
+                if (inside) {
+                    row[x] = color;
+                }
+            }
+#endif
+        }
+    }
+}
+
+bool raster::SoftwareRasterizer::writePpm(const char *path) const {
+    FILE *file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        std::cerr << "Can't open '" << path << "' for writing.\n";
+        return false;
+    }
+
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint32_t *source = pixels.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = static_cast<unsigned char>(source[x]);
+            row[x * 3 + 1] = static_cast<unsigned char>(source[x] >> 8);
+            row[x * 3 + 2] = static_cast<unsigned char>(source[x] >> 16);
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+
+    return std::fclose(file) == 0;
+}
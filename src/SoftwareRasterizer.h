@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include "ThreadPool.h"
+
+namespace raster {
+    // CPU counterparts of the GL programs: Flat mirrors frag.glsl (outColor),
+    // Circle the circles the window path hands to ShapeBatcher: round in
+    // pixels whatever the aspect, center in NDC and radius in units of half
+    // the framebuffer height.
+    enum class Shader {
+        Flat,
+        Circle
+    };
+
+    struct DrawCall {
+        const float *positions = nullptr; // 2 floats per vertex, NDC, same layout as the VBOs
+        const uint32_t *indices = nullptr; // GL_TRIANGLES, same layout as the EBO
+        size_t indexCount = 0;
+        Shader shader = Shader::Flat;
+        glm::vec4 color = {1.f, 1.f, 1.f, 1.f};
+        glm::vec2 center = {0.f, 0.f};
+        float radius = 0.f;
+    };
+
+    // Tiled rasterizer. Triangles are binned into fixed-size screen tiles and the
+    // tiles are shaded in parallel; each tile keeps the submission order of its
+    // triangles, so the result matches the GL path without blending.
+    class SoftwareRasterizer {
+    public:
+        SoftwareRasterizer(int width, int height, threading::ThreadPool &pool, int tileSize = 64);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        void clear(const glm::vec4 &color);
+        void draw(const DrawCall &call);
+        void flush();
+
+        // RGBA8, bottom row first like glReadPixels.
+        const std::vector<uint32_t> &getPixels() const { return pixels; }
+        bool writePpm(const char *path) const;
+
+    private:
+        struct Triangle {
+            float a[3], b[3], c[3]; // edge functions: e = a * x + b * y + c
+            bool topLeft[3];
+            int minX, minY, maxX, maxY;
+            uint32_t draw;
+        };
+
+        void shadeTile(size_t tile);
+
+        int width;
+        int height;
+        int tileSize;
+        int tilesX;
+        int tilesY;
+        threading::ThreadPool &pool;
+
+        std::vector<uint32_t> pixels;
+        uint32_t clearValue = 0;
+        bool clearPending = false;
+
+        std::vector<DrawCall> draws;
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t>> bins;
+    };
+}
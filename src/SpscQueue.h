@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace threading {
+    // Bounded lock-free queue for exactly one producer and one consumer
+    // thread. Each side caches the other's index and only reloads it when the
+    // queue looks full or empty, so steady traffic touches no shared cache
+    // line but the slots. Popped slots are left moved-from, so T must be
+    // default constructible and move assignable.
+    template<typename T>
+    class SpscQueue {
+    public:
+        // Rounded up to a power of two.
+        explicit SpscQueue(size_t capacity) {
+            size_t rounded = 1;
+            while (rounded < capacity) {
+                rounded <<= 1;
+            }
+            slots.resize(rounded);
+            mask = rounded - 1;
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        size_t capacity() const { return slots.size(); }
+
+        // Producer. Leaves value untouched and returns false when full.
+        bool tryPush(T &value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            if (position - cachedHead == slots.size()) {
+                cachedHead = head.load(std::memory_order_acquire);
+                if (position - cachedHead == slots.size()) {
+                    return false;
+                }
+            }
+
+            slots[position & mask] = std::move(value);
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer. Returns false when empty.
+        bool tryPop(T &value) {
+            size_t position = head.load(std::memory_order_relaxed);
+            if (position == cachedTail) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (position == cachedTail) {
+                    return false;
+                }
+            }
+
+            value = std::move(slots[position & mask]);
+            head.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Either side; a snapshot that may be stale by the time it returns.
+        size_t sizeApprox() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::vector<T> slots;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> head{0};
+        size_t cachedTail = 0;   // consumer's view of tail
+        alignas(64) std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;   // producer's view of head
+    };
+}
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include "TextureCache.h"
+#include "TextureCompression.h"
+
+namespace {
+    const uint32_t CacheMagic = 0x31435854; // "TXC1"
+    const uint32_t CacheVersion = 1;
+    const size_t LevelAlignment = 16;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t filter;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t compress;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+    };
+
+    struct CacheLevel {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    size_t alignUp(size_t value) {
+        return (value + LevelAlignment - 1) & ~(LevelAlignment - 1);
+    }
+
+    // Beyond any GL texture size; keeps the size arithmetic below in range.
+    const uint32_t MaxLevelSize = 1 << 16;
+
+    uint64_t levelSize(textures::PixelFormat format, uint32_t width, uint32_t height) {
+        if (format == textures::PixelFormat::Bc1) {
+            return textures::bc1Size(static_cast<int>(width), static_cast<int>(height));
+        }
+        return uint64_t(width) * height * 4;
+    }
+
+    // Levels from width x height down to 1x1.
+    uint32_t chainLength(uint32_t width, uint32_t height) {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+            ++levels;
+        }
+        return levels;
+    }
+}
+
+std::shared_ptr<textures::TextureData> textures::readTextureCache(const std::string &path, const CacheStamp &stamp) {
+    io::MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(CacheHeader)) {
+        return nullptr;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != CacheMagic || header.version != CacheVersion ||
+        header.format > static_cast<uint32_t>(PixelFormat::Bc1) ||
+        header.filter != static_cast<uint32_t>(stamp.filter) || header.compress != (stamp.compress ? 1u : 0u) ||
+        header.sourceSize != stamp.sourceSize || header.sourceTime != stamp.sourceTime ||
+        header.width == 0 || header.height == 0 || header.width > MaxLevelSize || header.height > MaxLevelSize ||
+        header.levelCount != chainLength(header.width, header.height) ||
+        (file.size() - sizeof(header)) / sizeof(CacheLevel) < header.levelCount) {
+        return nullptr;
+    }
+
+    auto texture = std::make_shared<TextureData>();
+    texture->format = static_cast<PixelFormat>(header.format);
+    texture->width = static_cast<int>(header.width);
+    texture->height = static_cast<int>(header.height);
+
+    // The uploader reads each level's width x height texels from its data and
+    // passes the sizes to GL, so every level must be exactly half the one
+    // above and hold exactly the bytes its size needs.
+    auto base = reinterpret_cast<const uint8_t *>(file.data());
+    uint32_t expectedWidth = header.width;
+    uint32_t expectedHeight = header.height;
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        CacheLevel level;
+        std::memcpy(&level, base + sizeof(header) + i * sizeof(CacheLevel), sizeof(level));
+        if (level.width != expectedWidth || level.height != expectedHeight ||
+            level.size != levelSize(texture->format, level.width, level.height) ||
+            level.offset > file.size() || level.size > file.size() - level.offset) {
+            return nullptr;
+        }
+
+        texture->levels.push_back({static_cast<int>(level.width), static_cast<int>(level.height),
+                                   base + level.offset, static_cast<size_t>(level.size)});
+        expectedWidth = std::max(expectedWidth / 2, 1u);
+        expectedHeight = std::max(expectedHeight / 2, 1u);
+    }
+
+    // Moving the mapping keeps the view address, so the level pointers stay valid.
+    texture->mapping = std::move(file);
+    return texture;
+}
+
+bool textures::writeTextureCache(const std::string &path, const CacheStamp &stamp, const TextureData &texture) {
+    CacheHeader header = {CacheMagic, CacheVersion, static_cast<uint32_t>(texture.format),
+                          static_cast<uint32_t>(stamp.filter), static_cast<uint32_t>(texture.width),
+                          static_cast<uint32_t>(texture.height), static_cast<uint32_t>(texture.levels.size()),
+                          stamp.compress ? 1u : 0u, stamp.sourceSize, stamp.sourceTime};
+
+    std::vector<CacheLevel> table;
+    size_t offset = alignUp(sizeof(header) + texture.levels.size() * sizeof(CacheLevel));
+    for (const auto &level : texture.levels) {
+        table.push_back({static_cast<uint32_t>(level.width), static_cast<uint32_t>(level.height), offset, level.size});
+        offset = alignUp(offset + level.size);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    // Unique per writer: two loads of the same source must not share a temporary file.
+    static std::atomic<uint64_t> writes{0};
+    std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+                                "." + std::to_string(writes++) + ".tmp";
+    {
+        std::ofstream stream(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(CacheLevel));
+
+        const char padding[LevelAlignment] = {};
+        size_t written = sizeof(header) + table.size() * sizeof(CacheLevel);
+        for (size_t i = 0; i < texture.levels.size(); ++i) {
+            stream.write(padding, table[i].offset - written);
+            stream.write(reinterpret_cast<const char *>(texture.levels[i].data), texture.levels[i].size);
+            written = table[i].offset + texture.levels[i].size;
+        }
+
+        if (!stream) {
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MipGenerator.h"
+
+namespace textures {
+    enum class PixelFormat : uint32_t {
+        Rgba8,
+        Bc1
+    };
+
+    struct TextureLevel {
+        int width;
+        int height;
+        const uint8_t *data;
+        size_t size;
+    };
+
+    // A mipped texture ready for upload, finest level first. Level data points
+    // either into the mapped cache file or into storage owned by the texture.
+    struct TextureData {
+        PixelFormat format = PixelFormat::Rgba8;
+        int width = 0;
+        int height = 0;
+        std::vector<TextureLevel> levels;
+
+        io::MappedFile mapping;
+        std::vector<uint8_t> storage;
+    };
+
+    // What a cache entry was built from; any difference makes it stale. The
+    // stored format is not part of it: a compression request may still produce
+    // RGBA8 for images with alpha.
+    struct CacheStamp {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        MipFilter filter;
+        bool compress;
+    };
+
+    // Cache files are a fixed header, a level table and the level data, each
+    // level 16-byte aligned, so a hit is one mmap and some pointer arithmetic:
+    // nothing is decoded or copied before the upload reads straight from the
+    // mapping. Returns null on a miss, including stale or truncated files.
+    std::shared_ptr<TextureData> readTextureCache(const std::string &path, const CacheStamp &stamp);
+
+    // Written to a temporary name and renamed, so readers never see a partial
+    // file. Returns false if the cache directory isn't writable.
+    bool writeTextureCache(const std::string &path, const CacheStamp &stamp, const TextureData &texture);
+}
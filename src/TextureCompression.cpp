@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstring>
+#include "TextureCompression.h"
+
+namespace {
+    uint16_t packRgb565(const int color[3]) {
+        return static_cast<uint16_t>((color[0] * 31 + 127) / 255 << 11 | (color[1] * 63 + 127) / 255 << 5 |
+                                     (color[2] * 31 + 127) / 255);
+    }
+
+    void unpackRgb565(uint16_t packed, int color[3]) {
+        int r = packed >> 11 & 31;
+        int g = packed >> 5 & 63;
+        int b = packed & 31;
+        color[0] = r << 3 | r >> 2;
+        color[1] = g << 2 | g >> 4;
+        color[2] = b << 3 | b >> 2;
+    }
+
+    void compressBlock(const uint8_t block[16][4], uint8_t *output) {
+        int low[3] = {255, 255, 255};
+        int high[3] = {0, 0, 0};
+        for (int i = 0; i < 16; ++i) {
+            for (int channel = 0; channel < 3; ++channel) {
+                low[channel] = std::min<int>(low[channel], block[i][channel]);
+                high[channel] = std::max<int>(high[channel], block[i][channel]);
+            }
+        }
+
+        // Pull the endpoints in by 1/16 of the range: the extremes are usually
+        // outliers and the palette then covers the bulk of the block better.
+        for (int channel = 0; channel < 3; ++channel) {
+            int inset = (high[channel] - low[channel]) >> 4;
+            low[channel] += inset;
+            high[channel] -= inset;
+        }
+
+        uint16_t color0 = packRgb565(high);
+        uint16_t color1 = packRgb565(low);
+        uint32_t indices = 0;
+
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        // Equal endpoints select the three-colour mode, where every index 0 is
+        // still the right answer.
+        if (color0 != color1) {
+            int palette[4][3];
+            unpackRgb565(color0, palette[0]);
+            unpackRgb565(color1, palette[1]);
+            for (int channel = 0; channel < 3; ++channel) {
+                palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+                palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                int best = 0;
+                int bestDistance = 1 << 30;
+                for (int entry = 0; entry < 4; ++entry) {
+                    int distance = 0;
+                    for (int channel = 0; channel < 3; ++channel) {
+                        int difference = block[i][channel] - palette[entry][channel];
+                        distance += difference * difference;
+                    }
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = entry;
+                    }
+                }
+                indices |= static_cast<uint32_t>(best) << (2 * i);
+            }
+        }
+
+        output[0] = static_cast<uint8_t>(color0);
+        output[1] = static_cast<uint8_t>(color0 >> 8);
+        output[2] = static_cast<uint8_t>(color1);
+        output[3] = static_cast<uint8_t>(color1 >> 8);
+        for (int i = 0; i < 4; ++i) {
+            output[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+        }
+    }
+}
+
+size_t textures::bc1Size(int width, int height) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+void textures::compressBc1(const uint8_t *rgba, int width, int height, uint8_t *destination) {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+
+    for (int blockY = 0; blockY < blocksY; ++blockY) {
+        for (int blockX = 0; blockX < blocksX; ++blockX) {
+            uint8_t block[16][4];
+            for (int y = 0; y < 4; ++y) {
+                int sourceY = std::min(blockY * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int sourceX = std::min(blockX * 4 + x, width - 1);
+                    std::memcpy(block[y * 4 + x], rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+                }
+            }
+
+            compressBlock(block, destination + (static_cast<size_t>(blockY) * blocksX + blockX) * 8);
+        }
+    }
+}
+
+bool textures::hasTransparency(const uint8_t *rgba, size_t pixelCount) {
+    for (size_t i = 0; i < pixelCount; ++i) {
+        if (rgba[i * 4 + 3] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace textures {
+    size_t bc1Size(int width, int height);
+
+    // Encodes RGBA8 into BC1 (DXT1) blocks, alpha dropped. Endpoints come from
+    // the inset bounding box of each 4x4 block: fast, and good enough for
+    // albedo-style content. Partial edge blocks repeat their last row/column.
+    void compressBc1(const uint8_t *rgba, int width, int height, uint8_t *destination);
+
+    bool hasTransparency(const uint8_t *rgba, size_t pixelCount);
+}
@@ -0,0 +1,195 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stb_image.h>
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "TextureCompression.h"
+#include "TextureLoader.h"
+
+namespace {
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+textures::TextureLoader::TextureLoader(threading::ThreadPool &pool, std::string cacheDirectory,
+                                       TextureOptions options)
+        : pool(pool), cacheDirectory(std::move(cacheDirectory)), options(options) {
+}
+
+textures::TextureLoader::~TextureLoader() {
+    wait();
+}
+
+textures::TextureLoader::TextureId textures::TextureLoader::load(const std::string &path) {
+    TextureId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        ++pending;
+    }
+
+    pool.submit([this, id, path]() { run(id, path); });
+    return id;
+}
+
+std::vector<textures::TextureLoader::Completed> textures::TextureLoader::takeCompleted() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Completed> ready;
+    ready.swap(completed);
+    return ready;
+}
+
+size_t textures::TextureLoader::getPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+void textures::TextureLoader::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return pending == 0; });
+}
+
+textures::TextureLoader::Stats textures::TextureLoader::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::string textures::TextureLoader::cachePath(const std::string &path) const {
+    std::error_code error;
+    std::string absolute = std::filesystem::absolute(path, error).lexically_normal().generic_string();
+    uint64_t key = hashing::fnv1a(absolute.data(), absolute.size());
+    // Different options get separate entries instead of evicting each other.
+    key = hashing::fnv1a(&options.filter, sizeof(options.filter), key);
+    key = hashing::fnv1a(&options.compress, sizeof(options.compress), key);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(cacheDirectory) / name).generic_string();
+}
+
+void textures::TextureLoader::run(TextureId id, const std::string &path) {
+    PROFILE_SCOPE("TextureLoader::run");
+    Stats local;
+    std::shared_ptr<TextureData> texture;
+    std::string failure = "can't read the file";
+
+    // The stamp needs only a stat, so a warm start never reads the source.
+    std::error_code error;
+    auto sourceSize = std::filesystem::file_size(path, error);
+    auto sourceTime = std::filesystem::last_write_time(path, error);
+    CacheStamp stamp = {static_cast<uint64_t>(sourceSize),
+                        static_cast<int64_t>(sourceTime.time_since_epoch().count()), options.filter,
+                        options.compress};
+    std::string cacheFile = cachePath(path);
+
+    if (!error) {
+        auto start = std::chrono::steady_clock::now();
+        texture = readTextureCache(cacheFile, stamp);
+        local.readMs += millisecondsSince(start);
+    }
+
+    if (texture) {
+        local.cacheHits = 1;
+    } else if (!error) {
+        local.cacheMisses = 1;
+
+        auto start = std::chrono::steady_clock::now();
+        io::MappedFile source(path);
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_uc *pixels = nullptr;
+        if (source.isOpen()) {
+            local.readMs += millisecondsSince(start);
+
+            PROFILE_SCOPE("stbi_load_from_memory");
+            start = std::chrono::steady_clock::now();
+            pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(source.data()),
+                                           static_cast<int>(source.size()), &width, &height, &channels, 4);
+            local.decodeMs += millisecondsSince(start);
+
+            // Not stbi_failure_reason(): it is one global shared by every job.
+            if (pixels == nullptr) {
+                failure = "stb_image can't decode it";
+            }
+        }
+
+        if (pixels != nullptr) {
+            local.bytesDecoded = static_cast<size_t>(width) * height * 4;
+
+            start = std::chrono::steady_clock::now();
+            MipChain chain = generateMipChain(pixels, width, height, options.filter);
+            stbi_image_free(pixels);
+            local.mipMs += millisecondsSince(start);
+
+            texture = std::make_shared<TextureData>();
+            texture->width = width;
+            texture->height = height;
+
+            if (options.compress && !hasTransparency(chain.pixels.data(), local.bytesDecoded / 4)) {
+                PROFILE_SCOPE("compressBc1");
+                start = std::chrono::steady_clock::now();
+
+                size_t total = 0;
+                for (const auto &level : chain.levels) {
+                    total += bc1Size(level.width, level.height);
+                }
+                texture->format = PixelFormat::Bc1;
+                texture->storage.resize(total);
+
+                size_t offset = 0;
+                for (const auto &level : chain.levels) {
+                    size_t size = bc1Size(level.width, level.height);
+                    compressBc1(chain.pixels.data() + level.offset, level.width, level.height,
+                                texture->storage.data() + offset);
+                    texture->levels.push_back({level.width, level.height, nullptr, size});
+                    offset += size;
+                }
+                local.compressMs += millisecondsSince(start);
+            } else {
+                texture->storage = std::move(chain.pixels);
+                for (const auto &level : chain.levels) {
+                    texture->levels.push_back({level.width, level.height, nullptr, level.size});
+                }
+            }
+
+            // Pointers are fixed up only now that storage won't move again.
+            size_t offset = 0;
+            for (auto &level : texture->levels) {
+                level.data = texture->storage.data() + offset;
+                offset += level.size;
+            }
+
+            start = std::chrono::steady_clock::now();
+            if (!writeTextureCache(cacheFile, stamp, *texture)) {
+                std::cerr << "Can't write texture cache '" << cacheFile << "'.\n";
+            }
+            local.cacheWriteMs += millisecondsSince(start);
+        }
+    }
+
+    if (!texture) {
+        local.failures = 1;
+        std::cerr << "Can't load texture '" << path << "': " << failure << ".\n";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.cacheHits += local.cacheHits;
+    stats.cacheMisses += local.cacheMisses;
+    stats.failures += local.failures;
+    stats.bytesDecoded += local.bytesDecoded;
+    stats.readMs += local.readMs;
+    stats.decodeMs += local.decodeMs;
+    stats.mipMs += local.mipMs;
+    stats.compressMs += local.compressMs;
+    stats.cacheWriteMs += local.cacheWriteMs;
+
+    completed.emplace_back(id, std::move(texture));
+    if (--pending == 0) {
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MipGenerator.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+
+namespace textures {
+    struct TextureOptions {
+        MipFilter filter = MipFilter::Kaiser;
+        // BC1 for opaque images; anything with alpha stays RGBA8. Needs
+        // GL_EXT_texture_compression_s3tc at upload time.
+        bool compress = false;
+    };
+
+    // Loads textures on the thread pool. A job first tries the cache entry for
+    // its path; on a hit the texture is the mapped cache file. On a miss the
+    // source is mapped, decoded with stbi_load_from_memory, mipped, optionally
+    // compressed and written back to the cache. Nothing here touches GL; finished
+    // textures are handed to a TextureUploader on the GL thread.
+    class TextureLoader {
+    public:
+        using TextureId = size_t;
+        using Completed = std::pair<TextureId, std::shared_ptr<const TextureData>>;
+
+        struct Stats {
+            size_t cacheHits = 0;
+            size_t cacheMisses = 0;
+            size_t failures = 0;
+            size_t bytesDecoded = 0;   // RGBA8 level 0 bytes produced by stb_image
+            double readMs = 0.0;       // summed over jobs, so can exceed wall time
+            double decodeMs = 0.0;
+            double mipMs = 0.0;
+            double compressMs = 0.0;
+            double cacheWriteMs = 0.0;
+        };
+
+        TextureLoader(threading::ThreadPool &pool, std::string cacheDirectory = "texture_cache",
+                      TextureOptions options = TextureOptions());
+        // Waits for jobs still running, they reference the loader.
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader &) = delete;
+        TextureLoader &operator=(const TextureLoader &) = delete;
+
+        TextureId load(const std::string &path);
+
+        // Textures finished since the last call, in completion order. A failed
+        // load is reported once with a null texture.
+        std::vector<Completed> takeCompleted();
+
+        size_t getPendingCount();
+        void wait();
+
+        Stats getStats();
+
+    private:
+        void run(TextureId id, const std::string &path);
+        std::string cachePath(const std::string &path) const;
+
+        threading::ThreadPool &pool;
+        std::string cacheDirectory;
+        TextureOptions options;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        TextureId nextId = 0;
+        size_t pending = 0;
+        std::vector<Completed> completed;
+        Stats stats;
+    };
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstring>
+#include "TextureUploader.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace {
+    // Rows that have to travel together: one for RGBA8, one block row for BC1.
+    int bandHeight(textures::PixelFormat format) {
+        return format == textures::PixelFormat::Bc1 ? 4 : 1;
+    }
+
+    size_t bandBytes(textures::PixelFormat format, int width) {
+        return format == textures::PixelFormat::Bc1 ? static_cast<size_t>((width + 3) / 4) * 8
+                                                    : static_cast<size_t>(width) * 4;
+    }
+}
+
+textures::TextureUploader::TextureUploader(render::GlDispatch &gl, size_t bytesPerFrame)
+        : gl(gl), bytesPerFrame(bytesPerFrame) {
+}
+
+bool textures::TextureUploader::supportsBc1(render::GlDispatch &gl) {
+    GLint count = 0;
+    gl.getIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        auto name = reinterpret_cast<const char *>(gl.getStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (name != nullptr && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+GLuint textures::TextureUploader::enqueue(std::shared_ptr<const TextureData> texture) {
+    GLuint name;
+    gl.genTextures(1, &name);
+    gl.bindTexture(GL_TEXTURE_2D, name);
+
+    int levels = static_cast<int>(texture->levels.size());
+    for (int level = 0; level < levels; ++level) {
+        const TextureLevel &data = texture->levels[level];
+        if (texture->format == PixelFormat::Bc1) {
+            gl.compressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, data.width, data.height, 0,
+                                    static_cast<GLsizei>(data.size), nullptr);
+        } else {
+            gl.texImage2D(GL_TEXTURE_2D, level, GL_RGBA8, data.width, data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                          nullptr);
+        }
+    }
+
+    // Base above max keeps the texture incomplete until its coarsest level lands.
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levels);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl.bindTexture(GL_TEXTURE_2D, 0);
+
+    queue.push_back({name, std::move(texture), levels - 1, 0});
+    return name;
+}
+
+size_t textures::TextureUploader::update() {
+    size_t sent = 0;
+    GLuint bound = 0;
+
+    while (!queue.empty() && (sent == 0 || sent < bytesPerFrame)) {
+        Upload &upload = queue.front();
+        const TextureData &texture = *upload.data;
+        const TextureLevel &level = texture.levels[upload.level];
+
+        if (bound != upload.texture) {
+            gl.bindTexture(GL_TEXTURE_2D, upload.texture);
+            bound = upload.texture;
+        }
+
+        int band = bandHeight(texture.format);
+        size_t rowBytes = bandBytes(texture.format, level.width);
+        size_t budget = sent < bytesPerFrame ? bytesPerFrame - sent : 0;
+        int bands = std::max<int>(1, static_cast<int>(budget / rowBytes));
+        int rows = std::min(level.height - upload.row, bands * band);
+
+        const uint8_t *source = level.data + static_cast<size_t>(upload.row / band) * rowBytes;
+        size_t bytes = static_cast<size_t>((rows + band - 1) / band) * rowBytes;
+
+        if (texture.format == PixelFormat::Bc1) {
+            gl.compressedTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, upload.row, level.width, rows,
+                                       GL_COMPRESSED_RGB_S3TC_DXT1_EXT, static_cast<GLsizei>(bytes), source);
+        } else {
+            // RGBA8 rows are whole multiples of GL's default unpack alignment of 4.
+            gl.texSubImage2D(GL_TEXTURE_2D, upload.level, 0, upload.row, level.width, rows, GL_RGBA,
+                             GL_UNSIGNED_BYTE, source);
+        }
+
+        sent += bytes;
+        upload.row += rows;
+
+        if (upload.row >= level.height) {
+            gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload.level);
+            upload.row = 0;
+            if (--upload.level < 0) {
+                queue.pop_front();
+            }
+        }
+    }
+
+    if (bound != 0) {
+        gl.bindTexture(GL_TEXTURE_2D, 0);
+    }
+    return sent;
+}
+
+void textures::TextureUploader::cancel(GLuint texture) {
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+                               [texture](const Upload &upload) { return upload.texture == texture; }),
+                queue.end());
+}
+
+size_t textures::TextureUploader::getPendingBytes() const {
+    size_t pending = 0;
+    for (const auto &upload : queue) {
+        const auto &levels = upload.data->levels;
+        for (int level = 0; level <= upload.level; ++level) {
+            pending += levels[level].size;
+        }
+        pending -= static_cast<size_t>(upload.row / bandHeight(upload.data->format)) *
+                   bandBytes(upload.data->format, levels[upload.level].width);
+    }
+    return pending;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include "GlDispatch.h"
+#include "TextureCache.h"
+
+namespace textures {
+    // Streams textures into GL a bounded number of bytes per frame, so loading
+    // a large asset spreads over several frames instead of stalling one.
+    // Levels go coarsest first, in bands of rows, and GL_TEXTURE_BASE_LEVEL
+    // follows the finest finished level: a texture can be sampled, blurry,
+    // after its first few hundred bytes and sharpens as the rest arrives.
+    // The caller owns the returned texture names.
+    class TextureUploader {
+    public:
+        explicit TextureUploader(render::GlDispatch &gl, size_t bytesPerFrame = 1 << 20);
+
+        TextureUploader(const TextureUploader &) = delete;
+        TextureUploader &operator=(const TextureUploader &) = delete;
+
+        // Needs a current context. BC1 textures need GL_EXT_texture_compression_s3tc.
+        static bool supportsBc1(render::GlDispatch &gl);
+
+        // Creates the texture and allocates every level; no pixel data is sent
+        // until update(). The texture keeps the data alive until it's done.
+        GLuint enqueue(std::shared_ptr<const TextureData> texture);
+
+        // Sends up to the per-frame budget (at least one band) and returns the
+        // bytes sent. Leaves GL_TEXTURE_2D on the active unit unbound.
+        size_t update();
+
+        // Drops what's left to send of a texture about to be deleted.
+        void cancel(GLuint texture);
+
+        bool isIdle() const { return queue.empty(); }
+        size_t getPendingBytes() const;
+
+    private:
+        struct Upload {
+            GLuint texture;
+            std::shared_ptr<const TextureData> data;
+            int level;      // counts down to 0
+            int row;        // next pixel row within the level
+        };
+
+        render::GlDispatch &gl;
+        size_t bytesPerFrame;
+        std::deque<Upload> queue;
+    };
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "ThreadPool.h"
+
+threading::ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    for (unsigned i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+threading::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void threading::ThreadPool::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+void threading::ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &job) {
+    if (count == 0) {
+        return;
+    }
+
+    struct Batch {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    auto drain = [batch, count, &job]() {
+        size_t completed = 0;
+        for (size_t i = batch->next++; i < count; i = batch->next++) {
+            job(i);
+            ++completed;
+        }
+
+        if (completed != 0 && batch->done.fetch_add(completed) + completed == count) {
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            batch->finished.notify_all();
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        submit(drain);
+    }
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch, count]() { return batch->done.load() == count; });
+}
+
+void threading::ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty()) {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+    }
+}
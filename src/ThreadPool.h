@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threading {
+    // Fixed-size worker pool. The calling thread takes part in parallelFor, so a
+    // pool of N threads spawns N - 1 workers. Jobs must not call parallelFor on
+    // the same pool recursively.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+        void submit(std::function<void()> task);
+        void parallelFor(size_t count, const std::function<void(size_t)> &job);
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        bool stopping = false;
+    };
+}
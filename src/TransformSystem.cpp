@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Profiler.h"
+#include "TransformSystem.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSFORM_AVX 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_SSE2 1
+#endif
+
+namespace {
+    const size_t UpdateChunk = 1 << 13;
+    const size_t CullChunk = 1 << 14;
+
+    size_t chunkCount(size_t count, size_t chunk) {
+        return (count + chunk - 1) / chunk;
+    }
+}
+
+scene::Frustum scene::Frustum::fromMatrix(const glm::mat4 &viewProjection, float pixelScale, float minScreenRadius) {
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row) {
+        rows[row] = {viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]};
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];  // left
+    frustum.planes[1] = rows[3] - rows[0];  // right
+    frustum.planes[2] = rows[3] + rows[1];  // bottom
+    frustum.planes[3] = rows[3] - rows[1];  // top
+    frustum.planes[4] = rows[3] + rows[2];  // near
+    frustum.planes[5] = rows[3] - rows[2];  // far
+    for (auto &plane : frustum.planes) {
+        plane /= std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    }
+
+    frustum.clipW = rows[3];
+    frustum.pixelScale = pixelScale;
+    frustum.minScreenRadius = minScreenRadius;
+    return frustum;
+}
+
+bool scene::Frustum::isVisible(const glm::vec3 &center, float radius) const {
+    // The sign bit rather than radius < 0, so a negative radius scaled to -0
+    // stays rejected, as in the SIMD kernels.
+    if (std::signbit(radius)) {
+        return false;
+    }
+
+    for (const auto &plane : planes) {
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) {
+            return false;
+        }
+    }
+
+    // radius * pixelScale / w >= minScreenRadius without the divide, which
+    // also keeps spheres around the eye (w <= 0) visible.
+    float w = clipW.x * center.x + clipW.y * center.y + clipW.z * center.z + clipW.w;
+    return radius * pixelScale >= minScreenRadius * w;
+}
+
+scene::TransformSystem::TransformSystem(threading::ThreadPool &pool) : pool(pool) {
+}
+
+void scene::TransformSystem::reserve(size_t count) {
+    for (auto *array : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX,
+                        &scaleY, &scaleZ, &boundsX, &boundsY, &boundsZ, &boundsRadius, &worldX, &worldY, &worldZ,
+                        &worldRadius}) {
+        array->reserve(count);
+    }
+    parents.reserve(count);
+    dirty.reserve(count);
+    changed.reserve(count);
+    depths.reserve(count);
+    worldMatrices.reserve(count);
+}
+
+scene::ObjectId scene::TransformSystem::create(ObjectId parent) {
+    if (parent != NoParent && parent >= parents.size()) {
+        throw std::invalid_argument("Parent of a transform has to be created first");
+    }
+
+    ObjectId object = static_cast<ObjectId>(parents.size());
+    for (auto *array : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &boundsX, &boundsY,
+                        &boundsZ, &worldX, &worldY, &worldZ}) {
+        array->push_back(0.f);
+    }
+    for (auto *array : {&rotationW, &scaleX, &scaleY, &scaleZ, &boundsRadius, &worldRadius}) {
+        array->push_back(1.f);
+    }
+
+    uint32_t depth = parent == NoParent ? 0 : depths[parent] + 1;
+    if (depth == levels.size()) {
+        levels.emplace_back();
+    }
+    levels[depth].push_back(object);
+
+    parents.push_back(parent);
+    depths.push_back(depth);
+    dirty.push_back(1);
+    changed.push_back(0);
+    worldMatrices.emplace_back(1.f);
+    return object;
+}
+
+void scene::TransformSystem::setPosition(ObjectId object, const glm::vec3 &position) {
+    positionX[object] = position.x;
+    positionY[object] = position.y;
+    positionZ[object] = position.z;
+    dirty[object] = 1;
+}
+
+void scene::TransformSystem::setRotation(ObjectId object, const glm::quat &rotation) {
+    glm::quat normalized = glm::normalize(rotation);
+    rotationX[object] = normalized.x;
+    rotationY[object] = normalized.y;
+    rotationZ[object] = normalized.z;
+    rotationW[object] = normalized.w;
+    dirty[object] = 1;
+}
+
+void scene::TransformSystem::setScale(ObjectId object, const glm::vec3 &scale) {
+    scaleX[object] = scale.x;
+    scaleY[object] = scale.y;
+    scaleZ[object] = scale.z;
+    dirty[object] = 1;
+}
+
+void scene::TransformSystem::setLocalBounds(ObjectId object, const glm::vec3 &center, float radius) {
+    boundsX[object] = center.x;
+    boundsY[object] = center.y;
+    boundsZ[object] = center.z;
+    boundsRadius[object] = radius;
+    dirty[object] = 1;
+}
+
+glm::vec4 scene::TransformSystem::getWorldBounds(ObjectId object) const {
+    return {worldX[object], worldY[object], worldZ[object], worldRadius[object]};
+}
+
+void scene::TransformSystem::update() {
+    PROFILE_SCOPE("TransformSystem::update");
+    stats.updated = 0;
+
+    // Parents are one level up, so they're final by the time a level starts.
+    for (const auto &level : levels) {
+        size_t chunks = chunkCount(level.size(), UpdateChunk);
+        chunkUpdated.assign(chunks, 0);
+
+        pool.parallelFor(chunks, [this, &level](size_t chunk) {
+            size_t end = std::min(level.size(), (chunk + 1) * UpdateChunk);
+            size_t updated = 0;
+
+            for (size_t i = chunk * UpdateChunk; i < end; ++i) {
+                ObjectId object = level[i];
+                ObjectId parent = parents[object];
+                uint8_t stale = dirty[object] | (parent != NoParent ? changed[parent] : 0);
+                changed[object] = stale;
+                if (stale) {
+                    updateObject(object);
+                    dirty[object] = 0;
+                    ++updated;
+                }
+            }
+            chunkUpdated[chunk] = updated;
+        });
+
+        for (size_t updated : chunkUpdated) {
+            stats.updated += updated;
+        }
+    }
+}
+
+void scene::TransformSystem::updateObject(ObjectId object) {
+    float x = rotationX[object];
+    float y = rotationY[object];
+    float z = rotationZ[object];
+    float w = rotationW[object];
+    float sx = scaleX[object];
+    float sy = scaleY[object];
+    float sz = scaleZ[object];
+
+    // Columns of translate * mat4_cast(rotation) * scale.
+    float local[4][3] = {
+            {(1.f - 2.f * (y * y + z * z)) * sx, 2.f * (x * y + w * z) * sx, 2.f * (x * z - w * y) * sx},
+            {2.f * (x * y - w * z) * sy, (1.f - 2.f * (x * x + z * z)) * sy, 2.f * (y * z + w * x) * sy},
+            {2.f * (x * z + w * y) * sz, 2.f * (y * z - w * x) * sz, (1.f - 2.f * (x * x + y * y)) * sz},
+            {positionX[object], positionY[object], positionZ[object]}
+    };
+
+    glm::mat4 &world = worldMatrices[object];
+    ObjectId parent = parents[object];
+    if (parent == NoParent) {
+        for (int column = 0; column < 4; ++column) {
+            world[column] = glm::vec4(local[column][0], local[column][1], local[column][2], column == 3 ? 1.f : 0.f);
+        }
+    } else {
+        const glm::mat4 &parentWorld = worldMatrices[parent];
+#ifdef TRANSFORM_SSE2
+        __m128 p0 = _mm_loadu_ps(&parentWorld[0][0]);
+        __m128 p1 = _mm_loadu_ps(&parentWorld[1][0]);
+        __m128 p2 = _mm_loadu_ps(&parentWorld[2][0]);
+        __m128 p3 = _mm_loadu_ps(&parentWorld[3][0]);
+        for (int column = 0; column < 4; ++column) {
+            __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(local[column][0])),
+                                                  _mm_mul_ps(p1, _mm_set1_ps(local[column][1]))),
+                                       _mm_mul_ps(p2, _mm_set1_ps(local[column][2])));
+            if (column == 3) {
+                result = _mm_add_ps(result, p3);
+            }
+            _mm_storeu_ps(&world[column][0], result);
+        }
+#else
+        for (int column = 0; column < 4; ++column) {
+            world[column] = parentWorld[0] * local[column][0] + parentWorld[1] * local[column][1] +
+                            parentWorld[2] * local[column][2] + (column == 3 ? parentWorld[3] : glm::vec4(0.f));
+        }
+#endif
+    }
+
+    glm::vec4 center = world[0] * boundsX[object] + world[1] * boundsY[object] + world[2] * boundsZ[object] + world[3];
+    float scale = std::max({world[0].x * world[0].x + world[0].y * world[0].y + world[0].z * world[0].z,
+                            world[1].x * world[1].x + world[1].y * world[1].y + world[1].z * world[1].z,
+                            world[2].x * world[2].x + world[2].y * world[2].y + world[2].z * world[2].z});
+    worldX[object] = center.x;
+    worldY[object] = center.y;
+    worldZ[object] = center.z;
+    worldRadius[object] = boundsRadius[object] * std::sqrt(scale);
+}
+
+void scene::TransformSystem::cull(const Frustum &frustum, std::vector<ObjectId> &visible) {
+    PROFILE_SCOPE("TransformSystem::cull");
+    size_t chunks = chunkCount(size(), CullChunk);
+    chunkVisible.resize(chunks);
+
+    pool.parallelFor(chunks, [this, &frustum](size_t chunk) {
+        chunkVisible[chunk].clear();
+        cullRange(frustum, chunk * CullChunk, std::min(size(), (chunk + 1) * CullChunk), chunkVisible[chunk]);
+    });
+
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        total += chunkVisible[chunk].size();
+    }
+    visible.clear();
+    visible.reserve(total);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        visible.insert(visible.end(), chunkVisible[chunk].begin(), chunkVisible[chunk].end());
+    }
+
+    stats.tested = size();
+    stats.visible = total;
+}
+
+void scene::TransformSystem::cullRange(const Frustum &frustum, size_t begin, size_t end,
+                                       std::vector<ObjectId> &visible) const {
+    size_t i = begin;
+
+#if defined(TRANSFORM_AVX)
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int plane = 0; plane < 6; ++plane) {
+        planeX[plane] = _mm256_set1_ps(frustum.planes[plane].x);
+        planeY[plane] = _mm256_set1_ps(frustum.planes[plane].y);
+        planeZ[plane] = _mm256_set1_ps(frustum.planes[plane].z);
+        planeW[plane] = _mm256_set1_ps(frustum.planes[plane].w);
+    }
+    __m256 clipX = _mm256_set1_ps(frustum.clipW.x);
+    __m256 clipY = _mm256_set1_ps(frustum.clipW.y);
+    __m256 clipZ = _mm256_set1_ps(frustum.clipW.z);
+    __m256 clipW = _mm256_set1_ps(frustum.clipW.w);
+    __m256 pixelScale = _mm256_set1_ps(frustum.pixelScale);
+    __m256 minRadius = _mm256_set1_ps(frustum.minScreenRadius);
+    __m256 zero = _mm256_setzero_ps();
+
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(&worldX[i]);
+        __m256 y = _mm256_loadu_ps(&worldY[i]);
+        __m256 z = _mm256_loadu_ps(&worldZ[i]);
+        __m256 radius = _mm256_loadu_ps(&worldRadius[i]);
+        __m256 negativeRadius = _mm256_sub_ps(zero, radius);
+
+        __m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(clipX, x), _mm256_mul_ps(clipY, y)),
+                                 _mm256_add_ps(_mm256_mul_ps(clipZ, z), clipW));
+        __m256 inside = _mm256_cmp_ps(_mm256_mul_ps(radius, pixelScale), _mm256_mul_ps(minRadius, w), _CMP_GE_OQ);
+        for (int plane = 0; plane < 6; ++plane) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[plane], x),
+                                                          _mm256_mul_ps(planeY[plane], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(planeZ[plane], z), planeW[plane]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        // Negative radii mark objects without bounds.
+        int mask = _mm256_movemask_ps(inside) & ~_mm256_movemask_ps(radius);
+        for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                visible.push_back(static_cast<ObjectId>(i + lane));
+            }
+        }
+    }
+#elif defined(TRANSFORM_SSE2)
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int plane = 0; plane < 6; ++plane) {
+        planeX[plane] = _mm_set1_ps(frustum.planes[plane].x);
+        planeY[plane] = _mm_set1_ps(frustum.planes[plane].y);
+        planeZ[plane] = _mm_set1_ps(frustum.planes[plane].z);
+        planeW[plane] = _mm_set1_ps(frustum.planes[plane].w);
+    }
+    __m128 clipX = _mm_set1_ps(frustum.clipW.x);
+    __m128 clipY = _mm_set1_ps(frustum.clipW.y);
+    __m128 clipZ = _mm_set1_ps(frustum.clipW.z);
+    __m128 clipW = _mm_set1_ps(frustum.clipW.w);
+    __m128 pixelScale = _mm_set1_ps(frustum.pixelScale);
+    __m128 minRadius = _mm_set1_ps(frustum.minScreenRadius);
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&worldX[i]);
+        __m128 y = _mm_loadu_ps(&worldY[i]);
+        __m128 z = _mm_loadu_ps(&worldZ[i]);
+        __m128 radius = _mm_loadu_ps(&worldRadius[i]);
+        __m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+        __m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(clipX, x), _mm_mul_ps(clipY, y)),
+                              _mm_add_ps(_mm_mul_ps(clipZ, z), clipW));
+        __m128 inside = _mm_cmpge_ps(_mm_mul_ps(radius, pixelScale), _mm_mul_ps(minRadius, w));
+        for (int plane = 0; plane < 6; ++plane) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[plane], x), _mm_mul_ps(planeY[plane], y)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[plane], z), planeW[plane]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        // Negative radii mark objects without bounds.
+        int mask = _mm_movemask_ps(inside) & ~_mm_movemask_ps(radius);
+        for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                visible.push_back(static_cast<ObjectId>(i + lane));
+            }
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        if (frustum.isVisible({worldX[i], worldY[i], worldZ[i]}, worldRadius[i])) {
+            visible.push_back(static_cast<ObjectId>(i));
+        }
+    }
+}
+
+void scene::TransformSystem::gatherMatrices(const std::vector<ObjectId> &visible, glm::mat4 *matrices) const {
+    PROFILE_SCOPE("TransformSystem::gatherMatrices");
+    pool.parallelFor(chunkCount(visible.size(), CullChunk), [this, &visible, matrices](size_t chunk) {
+        size_t end = std::min(visible.size(), (chunk + 1) * CullChunk);
+        for (size_t i = chunk * CullChunk; i < end; ++i) {
+            matrices[i] = worldMatrices[visible[i]];
+        }
+    });
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "ThreadPool.h"
+
+namespace scene {
+    using ObjectId = uint32_t;
+
+    const ObjectId NoParent = ~ObjectId(0);
+
+    // Culling volume taken from a view-projection matrix. A bounding sphere is
+    // visible when it reaches inside all six planes and its projected radius is
+    // at least minScreenRadius pixels; one with a negative radius never is.
+    struct Frustum {
+        glm::vec4 planes[6];   // normalized; inside when dot(xyz, p) + w >= 0
+        glm::vec4 clipW;       // fourth row of the matrix: a point's clip-space w
+        float pixelScale;      // projected pixels per unit of radius at w = 1
+        float minScreenRadius;
+
+        // For perspective and orthographic projections alike; pixelScale is
+        // projection[1][1] * viewportHeight / 2.
+        static Frustum fromMatrix(const glm::mat4 &viewProjection, float pixelScale, float minScreenRadius);
+
+        // The scalar form of TransformSystem::cull's test for one sphere.
+        bool isVisible(const glm::vec3 &center, float radius) const;
+    };
+
+    // Local position/rotation/scale and bounding spheres of many objects,
+    // kept as structure of arrays so the update and culling loops stream
+    // through memory and the culling tests run on 4 (SSE) or 8 (AVX) objects at
+    // a time. Objects form a hierarchy; a parent must exist before its
+    // children, and objects are grouped by depth so every depth level is
+    // updated in parallel once the one above it is done. Only objects whose
+    // local transform changed, and their descendants, get new world matrices.
+    class TransformSystem {
+    public:
+        struct Stats {
+            size_t updated = 0;    // world matrices recomputed by the last update()
+            size_t tested = 0;     // spheres tested by the last cull()
+            size_t visible = 0;
+        };
+
+        explicit TransformSystem(threading::ThreadPool &pool);
+
+        TransformSystem(const TransformSystem &) = delete;
+        TransformSystem &operator=(const TransformSystem &) = delete;
+
+        void reserve(size_t count);
+        // Identity transform and a unit bounding sphere at the origin.
+        ObjectId create(ObjectId parent = NoParent);
+        size_t size() const { return parents.size(); }
+
+        void setPosition(ObjectId object, const glm::vec3 &position);
+        void setRotation(ObjectId object, const glm::quat &rotation);
+        void setScale(ObjectId object, const glm::vec3 &scale);
+        // In local space; the world sphere grows with the largest axis scale. A
+        // negative radius marks an object with nothing to draw, which cull()
+        // never returns.
+        void setLocalBounds(ObjectId object, const glm::vec3 &center, float radius);
+
+        ObjectId getParent(ObjectId object) const { return parents[object]; }
+        const glm::mat4 &getWorldMatrix(ObjectId object) const { return worldMatrices[object]; }
+        glm::vec4 getWorldBounds(ObjectId object) const;
+
+        // Recomputes the world matrices and bounds of changed objects and all
+        // their descendants.
+        void update();
+
+        // Replaces visible with the objects that pass the frustum and screen
+        // size tests, in ascending id order. Needs an up-to-date update().
+        void cull(const Frustum &frustum, std::vector<ObjectId> &visible);
+
+        // Copies the world matrices of visible objects back to back into
+        // matrices, which must hold visible.size() of them; the layout a
+        // per-instance mat4 attribute reads.
+        void gatherMatrices(const std::vector<ObjectId> &visible, glm::mat4 *matrices) const;
+
+        const Stats &getStats() const { return stats; }
+
+    private:
+        void updateObject(ObjectId object);
+        void cullRange(const Frustum &frustum, size_t begin, size_t end, std::vector<ObjectId> &visible) const;
+
+        threading::ThreadPool &pool;
+
+        // Local transform.
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+        std::vector<float> boundsX, boundsY, boundsZ, boundsRadius;
+
+        // Hierarchy. changed is set during update() for objects that got a new
+        // world matrix, so their children know to follow.
+        std::vector<ObjectId> parents;
+        std::vector<uint8_t> dirty;
+        std::vector<uint8_t> changed;
+        std::vector<std::vector<ObjectId>> levels;
+        std::vector<uint32_t> depths;
+
+        // World state.
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<float> worldX, worldY, worldZ, worldRadius;
+
+        std::vector<std::vector<ObjectId>> chunkVisible;
+        std::vector<size_t> chunkUpdated;
+        Stats stats;
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace threading {
+    // Hands the latest value from one writer thread to one reader thread
+    // without locks or waiting. Each side owns one slot outright and the third
+    // is exchanged atomically: the writer fills its slot and swaps it in as the
+    // newest, the reader swaps the newest out when there is one. The writer
+    // never blocks on a slow reader; values the reader didn't get to in time
+    // are overwritten. Slots are reused, so T can keep its allocations.
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() = default;
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        // Writer: the slot to fill. It holds whatever was published two or
+        // more publishes ago, so overwrite it completely.
+        T &getBack() { return slots[back]; }
+
+        // Writer: makes the back slot the newest value. Returns false if that
+        // replaced a value the reader never saw.
+        bool publish() {
+            uint8_t previous = middle.exchange(static_cast<uint8_t>(back | Fresh), std::memory_order_acq_rel);
+            back = previous & IndexMask;
+            return (previous & Fresh) == 0;
+        }
+
+        // Reader: takes the newest value if one was published since the last
+        // call. Returns whether getFront() changed.
+        bool update() {
+            if ((middle.load(std::memory_order_relaxed) & Fresh) == 0) {
+                return false;
+            }
+            uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & IndexMask;
+            return true;
+        }
+
+        // Reader: whether update() would take a new value.
+        bool hasUpdate() const { return (middle.load(std::memory_order_relaxed) & Fresh) != 0; }
+
+        // Reader: stays valid and unchanged until the next update().
+        const T &getFront() const { return slots[front]; }
+
+    private:
+        static constexpr uint8_t IndexMask = 3;
+        static constexpr uint8_t Fresh = 4;
+
+        T slots[3];
+        alignas(64) std::atomic<uint8_t> middle{1};
+        alignas(64) uint8_t back = 2;
+        alignas(64) uint8_t front = 0;
+    };
+}
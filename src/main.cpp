@@ -1,13 +1,137 @@
 #include <glwrapper.h>
 #include "glfw3.h"
 #include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <glm/vec2.hpp>
-#include "ShadersLoader.h"
+#include "FrameScheduler.h"
+#include "GpuTimer.h"
+#include "Profiler.h"
+#include "RenderThread.h"
+#include "SceneInstancer.h"
+#include "SceneText.h"
+#include "ShaderHotReload.h"
+#include "ShapeBatcher.h"
+#include "TextureLoader.h"
+#include "TextureUploader.h"
+#include "TransformSystem.h"
+
+struct WindowOptions {
+    timing::SchedulerConfig scheduler;
+    std::string tracePath;
+    std::vector<std::string> textures;
+    std::vector<std::string> meshes;
+    size_t shapes = 0;
+};
+
+// The render thread's side of the window: its context, the shaders with hot
+// reload and the GPU timer, all created and destroyed on that thread.
+class WindowRenderDevice : public render::RenderDevice {
+public:
+    WindowRenderDevice(GLFWwindow *window, render::GlDispatch &gl, bool vsync)
+            : window(window), gl(gl), vsync(vsync) {}
+
+    void makeCurrent() override {
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(vsync ? 1 : 0);
+        gpuTimer = std::make_unique<profiling::GpuTimer>(gl);
+    }
+
+    Programs loadPrograms() override {
+        PROFILE_SCOPE("Shader setup");
+        shaderLibrary = std::make_unique<shaders::ShaderLibrary>(gl);
+        shaderReload = std::make_unique<shaders::ShaderHotReload>(*shaderLibrary);
+        flatShader = shaderReload->addProgram({"resources/shaders/ver.glsl", "resources/shaders/frag.glsl", {}});
+        shapeShader = shaderReload->addProgram(
+                {"resources/shaders/shape_vertex.glsl", "resources/shaders/shape_fragment.glsl", {}});
+        meshShader = shaderReload->addProgram(
+                {"resources/shaders/mesh_vertex.glsl", "resources/shaders/frag.glsl", {}});
+        return getPrograms();
+    }
+
+    bool reloadPrograms(Programs &programs) override {
+        if (shaderReload->update() == 0) {
+            return false;
+        }
+        programs = getPrograms();
+        return true;
+    }
+
+    void beginFrame() override {
+        PROFILE_GPU_BEGIN(*gpuTimer, "GPU scene");
+    }
+
+    void present() override {
+        PROFILE_GPU_END(*gpuTimer);
+        glfwSwapBuffers(window);
+        PROFILE_GPU_END_FRAME(*gpuTimer);
+    }
+
+    void release() override {
+        gpuTimer.reset();
+        shaderReload.reset();
+        shaderLibrary.reset();
+        glfwMakeContextCurrent(NULL);
+    }
 
-void initializeVao(GLuint &vao, GLuint &vbo, GLuint &ebo, GLuint* indx, GLfloat* coor) ;
+private:
+    Programs getPrograms() const {
+        Programs programs;
+        programs.flat = shaderReload->getProgram(flatShader);
+        programs.flatColor = shaderReload->getUniform(flatShader, "outColor");
+        programs.shape = shaderReload->getProgram(shapeShader);
+        programs.shapeViewport = shaderReload->getUniform(shapeShader, "viewportSize");
+        programs.mesh = shaderReload->getProgram(meshShader);
+        programs.meshColor = shaderReload->getUniform(meshShader, "outColor");
+        programs.meshOffset = shaderReload->getUniform(meshShader, "positionOffset");
+        programs.meshScale = shaderReload->getUniform(meshShader, "positionScale");
+        return programs;
+    }
+
+    GLFWwindow *window;
+    render::GlDispatch &gl;
+    bool vsync;
+    std::unique_ptr<profiling::GpuTimer> gpuTimer;
+    std::unique_ptr<shaders::ShaderLibrary> shaderLibrary;
+    std::unique_ptr<shaders::ShaderHotReload> shaderReload;
+    shaders::ShaderHotReload::ProgramId flatShader = 0;
+    shaders::ShaderHotReload::ProgramId shapeShader = 0;
+    shaders::ShaderHotReload::ProgramId meshShader = 0;
+};
+
+const char *const ScenePath = "resources/scenes/figure.scene";
+
+bool parseWindowOptions(int argc, char **argv, WindowOptions &options);
+void addDashboardShapes(std::vector<render::ShapeInstance> &shapes, size_t count, glm::vec2 viewport);
+void reportRenderThread(const render::RenderThreadStats &stats);
+void invalidateFrame(GLFWwindow *window);
+
+int main(int argc, char **argv) {
+
+    WindowOptions options;
+    if (!parseWindowOptions(argc - 1, argv + 1, options)) {
+        return -1;
+    }
+
+    std::unique_ptr<scene::SceneFile> figure;
+    std::vector<std::shared_ptr<const meshes::MeshFile>> packedMeshes;
+    try {
+        figure = scene::loadScene(ScenePath);
+        for (const auto &path : options.meshes) {
+            packedMeshes.push_back(std::make_shared<meshes::MeshFile>(path));
+        }
+    } catch (const std::runtime_error &error) {
+        std::cerr << error.what() << '\n';
+        return -1;
+    }
 
-int main() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -22,9 +146,6 @@ int main() {
         return -1;
     }
 
-    int width;
-    int height;
-    glfwGetFramebufferSize(window, &width, &height);
     glfwMakeContextCurrent(window);
 
 #ifndef __APPLE__
@@ -35,306 +156,221 @@ int main() {
     }
 #endif
 
-    auto vertexSource = shaders::loadShaderSourceFromFile("resources/shaders/ver.glsl");
-    const char * verShadNative = vertexSource.c_str();
-    auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &verShadNative, nullptr);
-    glCompileShader(vertexShader);
-
-    GLint vertexShaderSuccess;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &vertexShaderSuccess);
-    if (!vertexShaderSuccess) {
-        GLchar info[512];
-        glGetShaderInfoLog(vertexShader, sizeof(info), NULL, info);
-        std::cerr << "ERROR::SHADER LINK_FAILED\n" << info;
-        return 0;
+    // Queried while the context is current here; from now on it belongs to
+    // the render thread.
+    render::NativeGlDispatch glDispatch;
+    bool bc1 = textures::TextureUploader::supportsBc1(glDispatch);
+    glfwMakeContextCurrent(NULL);
+
+    {
+#ifdef PROFILER_ENABLED
+        if (!options.tracePath.empty()) {
+            profiling::Profiler::instance().startCapture();
+        }
+#endif
+        WindowRenderDevice device(window, glDispatch, options.scheduler.vsync);
+        timing::SteadyClock clock;
+        render::RenderThread renderThread(device, glDispatch, clock, options.scheduler);
+        renderThread.start();
+
+        // The render thread creates these before it draws a snapshot using them.
+        std::vector<render::MaterialHandle> materials;
+        for (size_t i = 0; i < figure->getMaterialCount(); ++i) {
+            const float *color = figure->getMaterials()[i].color;
+            materials.push_back(renderThread.createMaterial({color[0], color[1], color[2], color[3]}));
+        }
+        std::vector<render::SnapshotDraw> sceneDraws;
+        std::vector<scene::BakedNode> sceneCircles;
+
+        // Converted meshes are drawn in the middle of the view, their largest
+        // side half its height.
+        std::vector<render::SnapshotPackedDraw> packedDraws;
+        for (const auto &mesh : packedMeshes) {
+            glm::vec3 scale = mesh->getPositionScale();
+            float fit = 1.f / std::max({scale.x, scale.y, scale.z, 1e-6f});
+            packedDraws.push_back({renderThread.createPackedMesh(mesh), {0.2f, 0.2f, 0.2f, 1.f},
+                                   -scale * 0.5f * fit, scale * fit});
+        }
+
+        // The simulation ticks at the update rate; presentation is paced by
+        // the render thread.
+        timing::SchedulerConfig simulationConfig = options.scheduler;
+        simulationConfig.targetRate = simulationConfig.updateRate;
+        simulationConfig.vsync = false;
+        timing::FrameScheduler scheduler(clock, simulationConfig);
+
+        // Anything that can change what is on screen wakes a power-saving loop.
+        glfwSetWindowUserPointer(window, &scheduler);
+        glfwSetWindowRefreshCallback(window, [](GLFWwindow *window) { invalidateFrame(window); });
+        glfwSetFramebufferSizeCallback(window, [](GLFWwindow *window, int, int) { invalidateFrame(window); });
+        glfwSetKeyCallback(window, [](GLFWwindow *window, int, int, int, int) { invalidateFrame(window); });
+        glfwSetMouseButtonCallback(window, [](GLFWwindow *window, int, int, int) { invalidateFrame(window); });
+        glfwSetCursorPosCallback(window, [](GLFWwindow *window, double, double) { invalidateFrame(window); });
+
+        // Textures aren't drawn by the scene yet; they stream in to exercise the
+        // loading path.
+        threading::ThreadPool workerPool;
+        textures::TextureLoader textureLoader(workerPool, "texture_cache", {textures::MipFilter::Kaiser, bc1});
+        for (const auto &path : options.textures) {
+            textureLoader.load(path);
+        }
+
+        scene::TransformSystem transforms(workerPool);
+        scene::SceneInstancer instancer(*figure, transforms);
+
+        while (!glfwWindowShouldClose(window) && renderThread.isRunning()) {
+            {
+                PROFILE_SCOPE("Events");
+                glfwPollEvents();
+            }
+
+            for (auto &loaded : textureLoader.takeCompleted()) {
+                if (loaded.second) {
+                    renderThread.createTexture(std::move(loaded.second));
+                }
+            }
+
+            auto frame = scheduler.beginFrame();
+            // The scene is static, so the fixed steps have nothing to advance yet.
+            if (!frame.redraw) {
+                std::chrono::duration<double> timeout = simulationConfig.idleTimeout;
+                glfwWaitEventsTimeout(timeout.count());
+                continue;
+            }
+
+            {
+                PROFILE_SCOPE("Snapshot");
+                int width;
+                int height;
+                glfwGetFramebufferSize(window, &width, &height);
+                glm::vec2 viewport(width, height);
+
+                // Nodes are created as they come into view, which for the
+                // figure is all of it on the first frame.
+                const auto &created = instancer.instantiate(
+                        scene::Frustum::fromMatrix(glm::mat4(1.f), viewport.y * 0.5f, 0.5f));
+                if (!created.empty()) {
+                    transforms.update();
+                    std::vector<scene::BakedNode> baked;
+                    scene::bakeSceneNodes(*figure, instancer, transforms, created, baked);
+                    for (auto &node : baked) {
+                        if (node.circle) {
+                            sceneCircles.push_back(std::move(node));
+                        } else {
+                            auto mesh = renderThread.createMesh(std::move(node.vertices),
+                                                                {node.indices, node.indices + node.indexCount});
+                            sceneDraws.push_back({mesh, materials[node.material]});
+                        }
+                    }
+                }
+
+                auto &snapshot = renderThread.beginSnapshot();
+                snapshot.framebufferSize = {width, height};
+                snapshot.clearColor = {1.f, 0.5f, 0.f, 1.0f};
+                snapshot.draws = sceneDraws;
+                snapshot.packedDraws = packedDraws;
+
+                snapshot.shapes.clear();
+                for (const auto &circle : sceneCircles) {
+                    const float *color = figure->getMaterials()[circle.material].color;
+                    snapshot.shapes.push_back(render::makeNdcCircle(circle.center, circle.radius, viewport,
+                                                                    {color[0], color[1], color[2], color[3]}));
+                }
+                addDashboardShapes(snapshot.shapes, options.shapes, viewport);
+                renderThread.publishSnapshot();
+            }
+
+            {
+                PROFILE_SCOPE("Wait");
+                scheduler.endFrame();
+            }
+        }
+
+        renderThread.stop();
+        if (!renderThread.getError().empty()) {
+            std::cerr << renderThread.getError() << '\n';
+        }
+        reportRenderThread(renderThread.getStats());
+        profiling::reportProfile(options.tracePath);
     }
 
-    auto fragmentSource = shaders::loadShaderSourceFromFile("resources/shaders/frag.glsl");
-    const char * fragShadNative = fragmentSource.c_str();
-    auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragShadNative, nullptr);
-    glCompileShader(fragmentShader);
-
-    GLint fragmentShaderSuccess;
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &fragmentShaderSuccess);
-    if (!fragmentShaderSuccess) {
-        GLchar info[512];
-        glGetShaderInfoLog(fragmentShader, sizeof(info), NULL, info);
-        std::cerr << "ERROR::SHADER LINK_FAILED\n" << info;
-        return 0;
-    }
+    glfwTerminate();
+    return 0;
+}
 
-    auto circleFragmentSource = shaders::loadShaderSourceFromFile("resources/shaders/circle_fragment.glsl");
-    const char * circleFragmentNative = circleFragmentSource.c_str();
-    auto circleFragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(circleFragmentShader, 1, &circleFragmentNative, nullptr);
-    glCompileShader(circleFragmentShader);
-
-    GLint circleFragmentSuccess;
-    glGetShaderiv(circleFragmentShader, GL_COMPILE_STATUS, &circleFragmentSuccess);
-    if (!circleFragmentSuccess) {
-        GLchar info[512];
-        glGetShaderInfoLog(circleFragmentShader, sizeof(info), NULL, info);
-        std::cerr << "ERROR::SHADER LINK_FAILED\n" << info;
-        return 0;
+// Usage: opengl_template [--fps N] [--vsync] [--power-saving] [--trace file.json] [--texture file]...
+//                        [--mesh file.mesh]... [--shapes N]
+bool parseWindowOptions(int argc, char **argv, WindowOptions &options) {
+    for (int i = 0; i < argc; ++i) {
+        std::string option = argv[i];
+
+        if (option == "--fps" && i + 1 < argc) {
+            options.scheduler.targetRate = std::strtod(argv[++i], nullptr);
+        } else if (option == "--vsync") {
+            options.scheduler.vsync = true;
+        } else if (option == "--power-saving") {
+            options.scheduler.powerSaving = true;
+        } else if (option == "--trace" && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        } else if (option == "--texture" && i + 1 < argc) {
+            options.textures.push_back(argv[++i]);
+        } else if (option == "--mesh" && i + 1 < argc) {
+            options.meshes.push_back(argv[++i]);
+        } else if (option == "--shapes" && i + 1 < argc) {
+            options.shapes = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option '" << option << "'.\n";
+            return false;
+        }
     }
 
-    auto program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    auto circleProgram = glCreateProgram();
-    glAttachShader(circleProgram, vertexShader);
-    glAttachShader(circleProgram, circleFragmentShader);
-    glLinkProgram(circleProgram);
-
-    GLint programSuccess;
-    glGetProgramiv(program, GL_LINK_STATUS, &programSuccess);
-    if (!programSuccess) {
-        GLchar info[512];
-        glGetProgramInfoLog(program, sizeof(info), NULL, info);
-        std::cerr << vertexSource << std::endl;
-        std::cerr << fragmentSource << std::endl;
-
-        glDeleteProgram(program);
-        glfwTerminate();
-        return 0;
-    }
+    return true;
+}
 
-    GLint circleProgramSuccess;
-    glGetProgramiv(circleProgram, GL_LINK_STATUS, &circleProgramSuccess);
-    if (!circleProgramSuccess) {
-        GLchar info[512];
-        glGetProgramInfoLog(circleProgram, sizeof(info), NULL, info);
-        std::cerr << vertexSource << std::endl;
-        std::cerr << circleFragmentSource << std::endl;
+void invalidateFrame(GLFWwindow *window) {
+    static_cast<timing::FrameScheduler *>(glfwGetWindowUserPointer(window))->invalidate();
+}
 
-        glDeleteProgram(circleProgram);
-        glfwTerminate();
-        return 0;
+// Fills the viewport with a grid of count circles, rings and rounded rects,
+// standing in for a dashboard.
+void addDashboardShapes(std::vector<render::ShapeInstance> &shapes, size_t count, glm::vec2 viewport) {
+    if (count == 0) {
+        return;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(circleFragmentShader);
-    glDeleteShader(fragmentShader);
-
-    glViewport(0,0, width, height);
-
-    GLuint indx[] = { 0, 1, 2, 0, 2, 3};
-
-    GLfloat body[] = {
-            -0.3f, -0.3f,
-             0.3f, -0.3f,
-             0.3f, 0.5f,
-            -0.3f, 0.5f
-    };
-
-    GLfloat leftHand[] = {
-            -0.5f, -0.1f,
-            -0.35f, -0.1f,
-            -0.35f, 0.5f,
-            -0.5f, 0.5f
-    };
-
-    GLfloat rightHand[] = {
-            0.35f, -0.1f,
-            0.5f, -0.1f,
-            0.5f, 0.5f,
-            0.35f, 0.5f
-    };
-
-    GLfloat leftLeg[] = {
-            -0.3f, -0.9f,
-            -0.1f, -0.9f,
-            -0.1f, -0.3f,
-            -0.3f, -0.3f
-    };
-
-    GLfloat rightLeg[] = {
-            0.1f, -0.9f,
-            0.3f, -0.9f,
-            0.3f, -0.3f,
-            0.1f, -0.3f
-    };
-
-    glm::vec2 center = {0.f, 0.7f};
-    float radius = 0.2f;
-
-    GLfloat circle[] = {
-            center.x - radius, center.y - radius,
-            center.x + radius, center.y - radius,
-            center.x + radius, center.y + radius,
-            center.x - radius, center.y + radius
-    };
-
-    GLuint bodyVao;
-    GLuint leftHandVao;
-    GLuint rightHandVao;
-    GLuint leftLegVao;
-    GLuint rightLegVao;
-    GLuint circleVao;
-
-    GLuint ebo;
-    GLuint vbo[6];
-
-    glGenBuffers(6, vbo);
-    glGenBuffers(1, &ebo);
-
-    glGenVertexArrays(1, &bodyVao);
-    glBindVertexArray(bodyVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(body), body, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    glGenVertexArrays(1, &leftHandVao);
-    glBindVertexArray(leftHandVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(leftHand), leftHand, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    glGenVertexArrays(1, &rightHandVao);
-    glBindVertexArray(rightHandVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(rightHand), rightHand, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    glGenVertexArrays(1, &leftLegVao);
-    glBindVertexArray(leftLegVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(leftLeg), leftLeg, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    glGenVertexArrays(1, &rightLegVao);
-    glBindVertexArray(rightLegVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(rightLeg), rightLeg, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    //initializeVao(circleVao, vbo[5], ebo, indx, circle);
-
-    glGenVertexArrays(1, &circleVao);
-    glBindVertexArray(circleVao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo[5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(circle), circle, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    GLint radiusUniform = glGetUniformLocation(circleProgram, "radius");
-    GLint size = glGetUniformLocation(circleProgram, "windowSize");
-    GLint circleColor = glGetUniformLocation(circleProgram, "color");
-    GLint color = glGetUniformLocation(program, "outColor");
-    GLint circleCenter = glGetUniformLocation(circleProgram, "center");
-
-
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-
-        glClearColor(1.f, 0.5f, 0.f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(program);
-
-        glBindVertexArray(bodyVao);
-        glUniform4f(color, 0.0, 0.0, 0.0, 1.0);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glBindVertexArray(leftHandVao);
-        glUniform4f(color, 1.0, 1.0, 1.0, 1.0);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glBindVertexArray(rightHandVao);
-        glUniform4f(color, 1.0, 1.0, 1.0, 1.0);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glBindVertexArray(leftLegVao);
-        glUniform4f(color, 0.0, 0.0, 1.0, 1.0);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glBindVertexArray(rightLegVao);
-        glUniform4f(color, 0.0, 0.0, 1.0, 1.0);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glUseProgram(circleProgram);
-
-        glUniform2f(size, width, height);
-        glUniform1f(radiusUniform, 0.2f);
-        glUniform4f(circleColor, 0.0, 1.0, 0.0, 1.0);
-        glUniform2f(circleCenter, center.x, center.y);
-
-        glBindVertexArray(circleVao);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glfwSwapBuffers(window);
-        std::this_thread::sleep_for(std::chrono::nanoseconds(15000));
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(count * viewport.x / viewport.y)));
+    float cell = viewport.x / columns;
+    float half = cell * 0.4f;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec2 center((i % columns + 0.5f) * cell, (i / columns + 0.5f) * cell);
+        glm::vec4 color((i % 7) / 6.f, (i % 5) / 4.f, (i % 3) / 2.f, 0.8f);
+
+        switch (i % 3) {
+            case 0:
+                shapes.push_back(render::makeCircle(center, half, color));
+                break;
+            case 1:
+                shapes.push_back(render::makeRing(center, half, half * 0.3f, color));
+                break;
+            default:
+                shapes.push_back(render::makeRoundedRect(center, {half, half * 0.6f}, half * 0.25f, color));
+                break;
+        }
     }
-
-    glfwTerminate();
-    return 0;
 }
 
-void initializeVao(GLuint &vao, GLuint &vbo, GLuint &ebo, GLuint* indx, GLfloat* coor) {
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(coor), coor, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, 0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indx), indx, GL_STATIC_DRAW);
+void reportRenderThread(const render::RenderThreadStats &stats) {
+    if (stats.frames == 0 || stats.seconds <= 0.0) {
+        return;
+    }
 
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    std::cout << "Render thread: " << stats.frames << " frames, " << stats.seconds * 1000.0 / stats.frames
+              << " ms/frame; " << stats.snapshotsPublished / stats.seconds << " snapshots/s published, "
+              << stats.snapshotsRendered << " rendered, " << stats.snapshotsDropped << " dropped; "
+              << stats.commands << " commands, " << stats.commandStalls << " stalls\n";
+    if (stats.latencySamples != 0) {
+        std::cout << "Snapshot latency over " << stats.latencySamples << " snapshots: mean " << stats.latencyMean
+                  << " ms, p50 " << stats.latencyP50 << " ms, p99 " << stats.latencyP99 << " ms, max "
+                  << stats.latencyMax << " ms\n";
+    }
+}
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <vector>
+#include <gtest/gtest.h>
+#include "FrameScheduler.h"
+
+namespace {
+    using namespace std::chrono_literals;
+    using timing::Nanoseconds;
+
+    // Time only moves when the test or the scheduler moves it. Sleeps run
+    // over by oversleep, as an OS timer would; every relax() is a microsecond.
+    class FakeClock : public timing::Clock {
+    public:
+        Nanoseconds now() override { return time; }
+        void sleepFor(Nanoseconds duration) override {
+            sleeps.push_back(duration);
+            time += duration + oversleep;
+        }
+        void relax() override {
+            ++relaxes;
+            time += 1us;
+        }
+
+        Nanoseconds time = 1s;
+        Nanoseconds oversleep = 0ns;
+        std::vector<Nanoseconds> sleeps;
+        size_t relaxes = 0;
+    };
+
+    timing::SchedulerConfig makeConfig(double targetRate, double updateRate) {
+        timing::SchedulerConfig config;
+        config.targetRate = targetRate;
+        config.updateRate = updateRate;
+        return config;
+    }
+}
+
+TEST(FrameScheduler, AccumulatesFixedSteps) {
+    FakeClock clock;
+    timing::FrameScheduler scheduler(clock, makeConfig(0.0, 100.0));
+
+    clock.time += 25ms;
+    auto frame = scheduler.beginFrame();
+    EXPECT_EQ(frame.updates, 2);
+    EXPECT_NEAR(frame.alpha, 0.5, 1e-6);
+    EXPECT_NEAR(frame.deltaSeconds, 0.025, 1e-9);
+
+    // The half step left over counts toward the next frame.
+    clock.time += 5ms;
+    frame = scheduler.beginFrame();
+    EXPECT_EQ(frame.updates, 1);
+    EXPECT_NEAR(frame.alpha, 0.0, 1e-6);
+}
+
+TEST(FrameScheduler, DropsSimulationTimeAfterAStall) {
+    FakeClock clock;
+    timing::FrameScheduler scheduler(clock, makeConfig(0.0, 100.0));
+
+    // A quarter second at most is simulated, and at most maxUpdatesPerFrame steps of it.
+    clock.time += 3s;
+    auto frame = scheduler.beginFrame();
+    EXPECT_NEAR(frame.deltaSeconds, 0.25, 1e-9);
+    EXPECT_EQ(frame.updates, 8);
+    EXPECT_LT(frame.alpha, 1.0);
+
+    clock.time += 10ms;
+    EXPECT_LE(scheduler.beginFrame().updates, 2);
+}
+
+TEST(FrameScheduler, SleepsThenSpinsToTheDeadline) {
+    FakeClock clock;
+    clock.oversleep = 300us;
+    timing::FrameScheduler scheduler(clock, makeConfig(100.0, 100.0));
+    Nanoseconds start = clock.time;
+
+    for (int frame = 1; frame <= 20; ++frame) {
+        scheduler.beginFrame();
+        clock.time += 2ms;   // the frame's work
+        scheduler.endFrame();
+        // On time to the microsecond the spin steps in.
+        EXPECT_GE(clock.time, start + frame * 10ms);
+        EXPECT_LT(clock.time, start + frame * 10ms + 2us);
+    }
+
+    // Every frame slept, and the margin left for spinning settled near the oversleep.
+    EXPECT_EQ(clock.sleeps.size(), 20u);
+    EXPECT_GE(scheduler.getTimerSlack(), 300us);
+    EXPECT_LT(scheduler.getTimerSlack(), 1ms);
+}
+
+TEST(FrameScheduler, RestartsInsteadOfCatchingUp) {
+    FakeClock clock;
+    timing::FrameScheduler scheduler(clock, makeConfig(100.0, 100.0));
+
+    scheduler.beginFrame();
+    clock.time += 35ms;   // three deadlines missed
+    Nanoseconds late = clock.time;
+    scheduler.endFrame();
+    EXPECT_LT(clock.time, late + 2us);
+
+    // The next frame gets a whole period again.
+    scheduler.beginFrame();
+    scheduler.endFrame();
+    EXPECT_GE(clock.time, late + 10ms);
+}
+
+TEST(FrameScheduler, NeverWaitsWithVsyncOrNoCap) {
+    for (auto config : {makeConfig(60.0, 60.0), makeConfig(0.0, 60.0)}) {
+        config.vsync = config.targetRate != 0.0;
+        FakeClock clock;
+        timing::FrameScheduler scheduler(clock, config);
+        Nanoseconds start = clock.time;
+        scheduler.beginFrame();
+        scheduler.endFrame();
+        EXPECT_EQ(clock.time, start);
+    }
+}
+
+TEST(FrameScheduler, PowerSavingRedrawsOnlyWhenInvalidated) {
+    FakeClock clock;
+    auto config = makeConfig(0.0, 60.0);
+    config.powerSaving = true;
+    timing::FrameScheduler scheduler(clock, config);
+
+    EXPECT_TRUE(scheduler.beginFrame().redraw);
+    EXPECT_FALSE(scheduler.beginFrame().redraw);
+    scheduler.invalidate();
+    EXPECT_TRUE(scheduler.beginFrame().redraw);
+    EXPECT_FALSE(scheduler.beginFrame().redraw);
+}
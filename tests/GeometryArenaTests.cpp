@@ -0,0 +1,225 @@
+#include <cstring>
+#include <map>
+#include <vector>
+#include <gtest/gtest.h>
+#include "GeometryArena.h"
+#include "RecordingGlDispatch.h"
+
+namespace {
+    using render::RecordingGlDispatch;
+
+    // Records like its base and also keeps every buffer's bytes, so a test can
+    // read back what a mesh range points at after the arena moved it around.
+    class ContentDispatch : public RecordingGlDispatch {
+    public:
+        // The buffers the arena's VAO was last pointed at.
+        GLuint vertexBuffer = 0;
+        GLuint elementBuffer = 0;
+
+        void bindVertexArray(GLuint array) override {
+            vertexArrayBound = array != 0;
+            RecordingGlDispatch::bindVertexArray(array);
+        }
+
+        void bindBuffer(GLenum target, GLuint buffer) override {
+            bindings[target] = buffer;
+            if (vertexArrayBound && target == GL_ARRAY_BUFFER) {
+                vertexBuffer = buffer;
+            } else if (vertexArrayBound && target == GL_ELEMENT_ARRAY_BUFFER) {
+                elementBuffer = buffer;
+            }
+            RecordingGlDispatch::bindBuffer(target, buffer);
+        }
+
+        void bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) override {
+            auto &bytes = contents[bindings[target]];
+            bytes.assign(static_cast<size_t>(size), 0);
+            if (data != nullptr) {
+                std::memcpy(bytes.data(), data, bytes.size());
+            }
+            RecordingGlDispatch::bufferData(target, size, data, usage);
+        }
+
+        void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) override {
+            auto &bytes = contents[bindings[target]];
+            if (static_cast<size_t>(offset + size) <= bytes.size()) {
+                std::memcpy(bytes.data() + offset, data, static_cast<size_t>(size));
+            }
+            RecordingGlDispatch::bufferSubData(target, offset, size, data);
+        }
+
+        void copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+                               GLsizeiptr size) override {
+            auto &source = contents[bindings[readTarget]];
+            auto &destination = contents[bindings[writeTarget]];
+            if (static_cast<size_t>(readOffset + size) <= source.size() &&
+                static_cast<size_t>(writeOffset + size) <= destination.size()) {
+                std::memmove(destination.data() + writeOffset, source.data() + readOffset, static_cast<size_t>(size));
+            }
+            RecordingGlDispatch::copyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+        }
+
+        template <typename T>
+        std::vector<T> read(GLuint buffer, size_t first, size_t count) const {
+            const auto &bytes = contents.at(buffer);
+            std::vector<T> values(count);
+            if ((first + count) * sizeof(T) <= bytes.size()) {
+                std::memcpy(values.data(), bytes.data() + first * sizeof(T), count * sizeof(T));
+            }
+            return values;
+        }
+
+    private:
+        std::map<GLenum, GLuint> bindings;
+        std::map<GLuint, std::vector<uint8_t>> contents;
+        bool vertexArrayBound = false;
+    };
+
+    const std::vector<render::VertexAttribute> PositionLayout = {{0, 2, GL_FLOAT, GL_FALSE, 0}};
+
+    struct TestMesh {
+        std::vector<float> vertices;   // x, y pairs
+        std::vector<GLuint> indices;
+    };
+
+    // A distinct quad per seed; seeds of the same parity share an index list.
+    TestMesh makeQuad(int seed) {
+        float x = static_cast<float>(seed);
+        TestMesh mesh = {{x, 0.f, x + 1.f, 0.f, x + 1.f, 1.f, x, 1.f}, {0, 1, 2, 0, 2, 3}};
+        if (seed % 2 != 0) {
+            mesh.indices = {0, 1, 3, 1, 2, 3};
+        }
+        return mesh;
+    }
+
+    render::MeshId addMesh(render::GeometryArena &arena, const TestMesh &mesh) {
+        return arena.addMesh(mesh.vertices.data(), mesh.vertices.size() / 2, mesh.indices.data(), mesh.indices.size());
+    }
+
+    void expectMesh(const ContentDispatch &gl, const render::GeometryArena &arena, render::MeshId id,
+                    const TestMesh &mesh) {
+        render::MeshRange range = arena.getMesh(id);
+        ASSERT_EQ(static_cast<size_t>(range.indexCount), mesh.indices.size());
+        EXPECT_EQ(gl.read<GLuint>(gl.elementBuffer, static_cast<size_t>(range.firstIndex), mesh.indices.size()),
+                  mesh.indices) << "mesh " << id;
+        EXPECT_EQ(gl.read<float>(gl.vertexBuffer, static_cast<size_t>(range.baseVertex) * 2, mesh.vertices.size()),
+                  mesh.vertices) << "mesh " << id;
+    }
+}
+
+TEST(RangeAllocator, CoalescesFreedNeighbours) {
+    render::RangeAllocator allocator(40);
+    size_t a = allocator.allocate(10);
+    size_t b = allocator.allocate(10);
+    size_t c = allocator.allocate(10);
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 10u);
+    EXPECT_EQ(c, 20u);
+    EXPECT_EQ(allocator.allocate(11), render::RangeAllocator::InvalidOffset);
+
+    // A hole in the middle: 20 free in two blocks of 10.
+    allocator.free(b, 10);
+    EXPECT_EQ(allocator.getUsed(), 20u);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 2u);
+    EXPECT_FLOAT_EQ(allocator.getFragmentation(), 0.5f);
+
+    // Freeing its left neighbour joins the two, then the right one joins all.
+    allocator.free(a, 10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 2u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 20u);
+    allocator.free(c, 10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 1u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 40u);
+    EXPECT_FLOAT_EQ(allocator.getFragmentation(), 0.f);
+
+    // First fit reuses the front again.
+    EXPECT_EQ(allocator.allocate(5), 0u);
+    EXPECT_THROW(allocator.free(30, 20), std::logic_error);
+}
+
+TEST(GeometryArena, SharesIdenticalDataAndReleasesItByReference) {
+    ContentDispatch gl;
+    render::GeometryArena arena(gl, sizeof(float) * 2, PositionLayout);
+    TestMesh quad = makeQuad(0);
+    render::MeshId first = addMesh(arena, quad);
+    render::MeshId second = addMesh(arena, quad);
+    // Same index list, different vertices: only the index block is shared.
+    render::MeshId third = addMesh(arena, makeQuad(2));
+
+    auto stats = arena.getStats();
+    EXPECT_EQ(stats.meshes, 3u);
+    EXPECT_EQ(stats.dedupHits, 3u);
+    EXPECT_EQ(stats.vertexBytesUsed, 2 * 4 * sizeof(float) * 2);
+    EXPECT_EQ(stats.indexBytesUsed, 6 * sizeof(GLuint));
+    EXPECT_EQ(arena.getMesh(first).baseVertex, arena.getMesh(second).baseVertex);
+    EXPECT_EQ(arena.getMesh(first).firstIndex, arena.getMesh(third).firstIndex);
+
+    // The shared blocks stay until their last mesh goes.
+    arena.removeMesh(first);
+    EXPECT_EQ(arena.getStats().vertexBytesUsed, stats.vertexBytesUsed);
+    expectMesh(gl, arena, second, quad);
+    arena.removeMesh(second);
+    EXPECT_EQ(arena.getStats().vertexBytesUsed, 4 * sizeof(float) * 2);
+    EXPECT_EQ(arena.getStats().indexBytesUsed, stats.indexBytesUsed);
+    arena.removeMesh(third);
+    EXPECT_EQ(arena.getStats().meshes, 0u);
+    EXPECT_EQ(arena.getStats().vertexBytesUsed, 0u);
+    EXPECT_EQ(arena.getStats().indexBytesUsed, 0u);
+
+    // Freed data isn't matched any more: adding it again uploads it again.
+    size_t uploaded = arena.getStats().bytesUploaded;
+    addMesh(arena, quad);
+    EXPECT_EQ(arena.getStats().bytesUploaded, uploaded + sizeof(float) * 8 + sizeof(GLuint) * 6);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+}
+
+TEST(GeometryArena, GrowsByCopyingIntoALargerBuffer) {
+    ContentDispatch gl;
+    render::GeometryArena arena(gl, sizeof(float) * 2, PositionLayout, 6, 6);
+    std::vector<TestMesh> quads;
+    std::vector<render::MeshId> ids;
+    for (int i = 0; i < 5; ++i) {
+        quads.push_back(makeQuad(i));
+        ids.push_back(addMesh(arena, quads.back()));
+    }
+
+    auto stats = arena.getStats();
+    EXPECT_GT(stats.reallocations, 0u);
+    EXPECT_GE(stats.vertexBytesCapacity, 5 * 4 * sizeof(float) * 2);
+    EXPECT_NE(gl.getLog().find("glCopyBufferSubData"), std::string::npos);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        expectMesh(gl, arena, ids[i], quads[i]);
+    }
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+}
+
+TEST(GeometryArena, CompactClosesHolesAndKeepsRangesValid) {
+    ContentDispatch gl;
+    render::GeometryArena arena(gl, sizeof(float) * 2, PositionLayout, 64, 64);
+    std::vector<TestMesh> quads;
+    std::vector<render::MeshId> ids;
+    for (int i = 0; i < 8; ++i) {
+        quads.push_back(makeQuad(i));
+        ids.push_back(addMesh(arena, quads.back()));
+    }
+    for (size_t i = 0; i < ids.size(); i += 3) {
+        arena.removeMesh(ids[i]);
+    }
+
+    auto before = arena.getStats();
+    EXPECT_GT(before.vertexFragmentation, 0.f);
+    arena.compact();
+    auto after = arena.getStats();
+    EXPECT_EQ(after.vertexFragmentation, 0.f);
+    EXPECT_EQ(after.indexFragmentation, 0.f);
+    EXPECT_EQ(after.vertexBytesUsed, before.vertexBytesUsed);
+    EXPECT_EQ(after.vertexBytesCapacity, before.vertexBytesCapacity);
+    EXPECT_EQ(after.reallocations, before.reallocations + 1);
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i % 3 != 0) {
+            expectMesh(gl, arena, ids[i], quads[i]);
+        }
+    }
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+}
@@ -0,0 +1,321 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include "GeometryArena.h"
+#include "GpuTimer.h"
+#include "Hash.h"
+#include "RecordingGlDispatch.h"
+#include "RenderQueue.h"
+#include "ShaderLibrary.h"
+#include "ShapeBatcher.h"
+#include "TextureCompression.h"
+#include "TextureUploader.h"
+
+// Each test drives one part of the renderer against RecordingGlDispatch and
+// compares the call stream with tests/golden/<name>.txt. A difference means
+// the GL work changed: check the new stream and rerun with UPDATE_GOLDEN=1
+// when the change is intended. The streams must also be free of the calls
+// RecordingGlDispatch flags, redundant ones included, so a golden never
+// locks in wasted work.
+namespace {
+    using render::RecordingGlDispatch;
+
+    void expectGolden(const std::string &name, const std::string &log) {
+        std::string path = std::string(GOLDEN_DIRECTORY) + "/" + name + ".txt";
+        if (std::getenv("UPDATE_GOLDEN") != nullptr) {
+            std::ofstream(path, std::ios::binary) << log;
+            return;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        ASSERT_TRUE(file.is_open()) << "No golden stream '" << path << "'; run with UPDATE_GOLDEN=1 to write it";
+        std::stringstream expected;
+        expected << file.rdbuf();
+
+        std::istringstream expectedLines(expected.str());
+        std::istringstream actualLines(log);
+        std::string expectedLine;
+        std::string actualLine;
+        for (size_t line = 1;; ++line) {
+            bool moreExpected = static_cast<bool>(std::getline(expectedLines, expectedLine));
+            bool moreActual = static_cast<bool>(std::getline(actualLines, actualLine));
+            if (!moreExpected && !moreActual) {
+                return;
+            }
+            ASSERT_EQ(moreExpected ? expectedLine : "<end of stream>", moreActual ? actualLine : "<end of stream>")
+                    << name << ".txt, line " << line;
+        }
+    }
+
+    shaders::PreprocessedSource makeSource(const std::string &name, const std::string &text) {
+        return {text, hashing::fnv1a(text.data(), text.size()), {name}};
+    }
+
+    const char *const VertexSource = "#version 330 core\nvoid main() { gl_Position = vec4(0.0); }\n";
+    const char *const FlatSource = "#version 330 core\nuniform vec4 outColor;\nout vec4 color;\n"
+                                   "void main() { color = outColor; }\n";
+    const char *const ShapeSource = "#version 330 core\nuniform vec2 viewportSize;\nout vec4 color;\n"
+                                    "void main() { color = vec4(viewportSize, 0.0, 1.0); }\n";
+
+    GLuint buildFlatProgram(shaders::ShaderLibrary &library) {
+        return library.buildProgram(makeSource("flat.vert", VertexSource), makeSource("flat.frag", FlatSource),
+                                    {"flat.vert", "flat.frag", {}});
+    }
+
+    // Finest level first, down to 1x1, filled with a pattern so uploads hash
+    // the same from run to run.
+    std::shared_ptr<textures::TextureData> makeTexture(textures::PixelFormat format, int size) {
+        auto texture = std::make_shared<textures::TextureData>();
+        texture->format = format;
+        texture->width = size;
+        texture->height = size;
+
+        std::vector<std::pair<int, size_t>> levels;
+        size_t total = 0;
+        for (int level = size; level >= 1; level /= 2) {
+            size_t bytes = format == textures::PixelFormat::Bc1 ? textures::bc1Size(level, level)
+                                                                : static_cast<size_t>(level) * level * 4;
+            levels.push_back({level, bytes});
+            total += bytes;
+        }
+
+        texture->storage.resize(total);
+        for (size_t i = 0; i < total; ++i) {
+            texture->storage[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        size_t offset = 0;
+        for (const auto &level : levels) {
+            texture->levels.push_back({level.first, level.first, texture->storage.data() + offset, level.second});
+            offset += level.second;
+        }
+        return texture;
+    }
+}
+
+TEST(GoldenStream, ShaderLibrary) {
+    RecordingGlDispatch gl;
+    {
+        shaders::ShaderLibrary library(gl);
+        GLuint flat = buildFlatProgram(library);
+        GLuint shape = library.buildProgram(makeSource("shape.vert", VertexSource),
+                                            makeSource("shape.frag", ShapeSource),
+                                            {"shape.vert", "shape.frag", {}});
+        EXPECT_EQ(buildFlatProgram(library), flat);
+
+        // The vertex stage compiled for the failed build goes with it.
+        EXPECT_THROW(library.buildProgram(makeSource("broken.vert", "#version 330 core\nvoid main() {}\n"),
+                                          makeSource("broken.frag", "#version 330 core\n#error unfinished\n"),
+                                          {"broken.vert", "broken.frag", {}}),
+                     std::runtime_error);
+
+        // The flat program was handed out twice, so one release leaves it alive.
+        library.releaseProgram(flat);
+        library.releaseProgram(shape);
+
+        const auto &stats = library.getStats();
+        EXPECT_EQ(stats.programLinks, 2u);
+        EXPECT_EQ(stats.shaderReuses, 1u);
+    }
+
+    EXPECT_EQ(gl.getLiveObjectCount(), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("shader_library", gl.getLog());
+}
+
+TEST(GoldenStream, ProgramBinaryCacheSkipsCompiles) {
+    auto cache = std::filesystem::temp_directory_path() / "render_tests_program_binaries";
+    std::filesystem::remove_all(cache);
+
+    RecordingGlDispatch cold;
+    cold.setProgramBinarySupport(true);
+    {
+        shaders::ShaderLibrary library(cold, cache.string());
+        buildFlatProgram(library);
+        EXPECT_EQ(library.getStats().binaryMisses, 1u);
+    }
+
+    RecordingGlDispatch warm;
+    warm.setProgramBinarySupport(true);
+    {
+        shaders::ShaderLibrary library(warm, cache.string());
+        GLuint program = buildFlatProgram(library);
+        EXPECT_EQ(library.getStats().binaryHits, 1u);
+        EXPECT_EQ(library.getStats().shaderCompiles, 0u);
+        EXPECT_NE(warm.getUniformLocation(program, "outColor"), -1);
+    }
+
+    EXPECT_EQ(cold.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(warm.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(cold.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    EXPECT_EQ(warm.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    std::filesystem::remove_all(cache);
+}
+
+TEST(GoldenStream, RenderQueueFrames) {
+    RecordingGlDispatch gl;
+    shaders::ShaderLibrary library(gl);
+    GLuint program = buildFlatProgram(library);
+    GLint color = gl.getUniformLocation(program, "outColor");
+    gl.clearLog();
+
+    render::GeometryArena arena(gl, sizeof(GLfloat) * 2, {{0, 2, GL_FLOAT, GL_FALSE, 0}}, 64, 64);
+    const float quad[] = {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f};
+    const GLuint quadIndices[] = {0, 1, 2, 0, 2, 3};
+    const float triangle[] = {0.f, 1.f, -1.f, -1.f, 1.f, -1.f};
+    const GLuint triangleIndices[] = {0, 1, 2};
+    render::MeshRange quadMesh = arena.getMesh(arena.addMesh(quad, 4, quadIndices, 6));
+    render::MeshRange triangleMesh = arena.getMesh(arena.addMesh(triangle, 3, triangleIndices, 3));
+
+    render::RenderQueue queue(gl);
+    render::ProgramId flat = queue.addProgram(program);
+    render::VertexArrayId vao = queue.addVertexArray(arena.getVertexArray());
+    render::MaterialId red = queue.addMaterial({{{color, 4, {1.f, 0.f, 0.f, 1.f}}}});
+    render::MaterialId blue = queue.addMaterial({{{color, 4, {0.f, 0.f, 1.f, 1.f}}}});
+
+    auto submitFrame = [&]() {
+        for (render::MaterialId material : {red, blue, red}) {
+            queue.submit({flat, vao, material, 0, 0.f, quadMesh.indexCount, quadMesh.firstIndex, quadMesh.baseVertex});
+            queue.submit({flat, vao, material, 0, 0.5f, triangleMesh.indexCount, triangleMesh.firstIndex,
+                          triangleMesh.baseVertex});
+        }
+        queue.submit({flat, vao, blue, 1, 0.f, quadMesh.indexCount, quadMesh.firstIndex, quadMesh.baseVertex});
+        queue.flush();
+    };
+
+    submitFrame();
+    size_t firstFrameDraws = gl.getDrawCalls();
+    submitFrame();
+
+    EXPECT_EQ(gl.getDrawCalls(), firstFrameDraws * 2);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("render_queue_frames", gl.getLog());
+}
+
+TEST(GoldenStream, RenderQueueDepthOrder) {
+    RecordingGlDispatch gl;
+    shaders::ShaderLibrary library(gl);
+    GLuint flatProgram = buildFlatProgram(library);
+    render::GeometryArena arena(gl, sizeof(GLfloat) * 2, {{0, 2, GL_FLOAT, GL_FALSE, 0}}, 64, 64);
+    const float triangle[] = {0.f, 1.f, -1.f, -1.f, 1.f, -1.f};
+    const GLuint indices[] = {0, 1, 2};
+    std::vector<render::MeshRange> meshes;
+    for (int i = 0; i < 4; ++i) {
+        // Each mesh its own vertices, so none are deduplicated into one range.
+        const float offset[] = {triangle[0] + i, triangle[1], triangle[2], triangle[3], triangle[4], triangle[5]};
+        meshes.push_back(arena.getMesh(arena.addMesh(offset, 3, indices, 3)));
+    }
+    gl.clearLog();
+
+    render::RenderQueue queue(gl);
+    render::ProgramId program = queue.addProgram(flatProgram);
+    render::VertexArrayId vao = queue.addVertexArray(arena.getVertexArray());
+    render::MaterialId material = queue.addMaterial({});
+
+    // Submitted back to front; mesh 3 is drawn twice, at 0.6 and 0.2.
+    std::vector<std::pair<size_t, float>> draws = {{0, 0.9f}, {3, 0.6f}, {1, 0.4f}, {3, 0.2f}, {2, 0.1f}};
+    for (const auto &draw : draws) {
+        const render::MeshRange &mesh = meshes[draw.first];
+        queue.submit({program, vao, material, 0, draw.second, mesh.indexCount, mesh.firstIndex, mesh.baseVertex});
+    }
+    queue.flush();
+
+    // Front to back: mesh 2, then mesh 3 instanced where its front draw is,
+    // then meshes 1 and 0 in one multi-draw.
+    EXPECT_EQ(queue.getStats().drawCalls, 3u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("render_queue_depth_order", gl.getLog());
+}
+
+TEST(GoldenStream, ShapeBatcherFrames) {
+    RecordingGlDispatch gl;
+    shaders::ShaderLibrary library(gl);
+    GLuint program = library.buildProgram(makeSource("shape.vert", VertexSource),
+                                          makeSource("shape.frag", ShapeSource), {"shape.vert", "shape.frag", {}});
+    GLint viewport = gl.getUniformLocation(program, "viewportSize");
+    gl.clearLog();
+
+    {
+        render::ShapeBatcher batcher(gl, 2);
+        batcher.setProgram(program, viewport);
+
+        batcher.addCircle({10.f, 10.f}, 5.f, {1.f, 0.f, 0.f, 1.f});
+        batcher.addRing({30.f, 10.f}, 8.f, 2.f, {0.f, 1.f, 0.f, 1.f});
+        batcher.flush({640.f, 480.f});
+
+        // More shapes than the buffer holds: it grows instead of orphaning.
+        for (int i = 0; i < 3; ++i) {
+            batcher.addRoundedRect({50.f + i * 20.f, 40.f}, {8.f, 4.f}, 2.f, {0.f, 0.f, 1.f, 0.5f});
+        }
+        batcher.flush({640.f, 480.f});
+        EXPECT_EQ(batcher.getStats().capacity, 4u);
+
+        // Nothing to draw: no GL work at all.
+        batcher.flush({640.f, 480.f});
+
+        // Other code bound its own state in between, and the window was resized.
+        gl.useProgram(0);
+        gl.bindVertexArray(0);
+        batcher.invalidateBindings();
+        batcher.addCircle({10.f, 10.f}, 5.f, {1.f, 0.f, 0.f, 1.f});
+        batcher.flush({800.f, 600.f});
+    }
+
+    EXPECT_EQ(gl.getDrawCalls(), 3u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("shape_batcher_frames", gl.getLog());
+}
+
+TEST(GoldenStream, TextureUploads) {
+    RecordingGlDispatch gl;
+    gl.setExtensions({"GL_ARB_timer_query", "GL_EXT_texture_compression_s3tc"});
+    EXPECT_TRUE(textures::TextureUploader::supportsBc1(gl));
+
+    textures::TextureUploader uploader(gl, 96);
+    GLuint rgba = uploader.enqueue(makeTexture(textures::PixelFormat::Rgba8, 8));
+    GLuint bc1 = uploader.enqueue(makeTexture(textures::PixelFormat::Bc1, 8));
+
+    size_t frames = 0;
+    size_t bytes = 0;
+    while (!uploader.isIdle()) {
+        bytes += uploader.update();
+        ++frames;
+    }
+    EXPECT_EQ(bytes, (64u + 16u + 4u + 1u) * 4u + 32u + 8u + 8u + 8u);
+    EXPECT_EQ(frames, 4u);
+
+    GLuint names[] = {rgba, bc1};
+    gl.deleteTextures(2, names);
+
+    EXPECT_EQ(gl.getLiveObjectCount(), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("texture_uploads", gl.getLog());
+}
+
+TEST(GoldenStream, GpuTimerFrames) {
+    RecordingGlDispatch gl;
+    {
+        profiling::GpuTimer timer(gl);
+        for (int frame = 0; frame < 3; ++frame) {
+            timer.begin("scene");
+            timer.end();
+            timer.begin("shapes");
+            timer.endFrame();
+        }
+        ASSERT_EQ(timer.getResults().size(), 2u);
+        EXPECT_STREQ(timer.getResults()[1].name, "shapes");
+    }
+
+    EXPECT_EQ(gl.getLiveObjectCount(), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Invalid), 0u);
+    EXPECT_EQ(gl.countIssues(RecordingGlDispatch::IssueType::Redundant), 0u);
+    expectGolden("gpu_timer_frames", gl.getLog());
+}
@@ -0,0 +1,106 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include "MeshFile.h"
+#include "RecordingGlDispatch.h"
+
+namespace {
+    using render::RecordingGlDispatch;
+    using IssueType = render::RecordingGlDispatch::IssueType;
+
+    // Two quads, each its own submesh with 16-bit indices relative to its base vertex.
+    const uint16_t QuadIndices[] = {0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 2, 3};
+
+    class MeshFile : public testing::Test {
+    protected:
+        void TearDown() override { std::filesystem::remove(path); }
+
+        void write(const std::vector<meshes::Submesh> &submeshes) {
+            meshes::MeshHeader header = {};
+            header.magic = meshes::MeshMagic;
+            header.version = meshes::MeshVersion;
+            header.vertexCount = 8;
+            header.indexCount = 12;
+            header.indexType = static_cast<uint32_t>(meshes::IndexType::Uint16);
+            header.submeshCount = static_cast<uint32_t>(submeshes.size());
+            header.boundsMax[0] = header.boundsMax[1] = header.boundsMax[2] = 1.f;
+            header.vertexOffset = 64;
+            header.indexOffset = header.vertexOffset + header.vertexCount * sizeof(meshes::PackedVertex);
+            header.submeshOffset = header.indexOffset + 32;
+
+            std::vector<char> image(header.submeshOffset + submeshes.size() * sizeof(meshes::Submesh));
+            std::memcpy(image.data(), &header, sizeof(header));
+            std::memcpy(image.data() + header.indexOffset, QuadIndices, sizeof(QuadIndices));
+            std::memcpy(image.data() + header.submeshOffset, submeshes.data(),
+                        submeshes.size() * sizeof(meshes::Submesh));
+            std::ofstream(path, std::ios::binary).write(image.data(), static_cast<std::streamsize>(image.size()));
+        }
+
+        std::string path = (std::filesystem::temp_directory_path() / "render_tests_mesh.mesh").string();
+    };
+}
+
+TEST_F(MeshFile, UploadsBothSectionsIntoOneVertexArray) {
+    write({{0, 6, 0, 4, 0}, {6, 6, 4, 4, 1}});
+    meshes::MeshFile mesh(path);
+
+    RecordingGlDispatch gl;
+    GLuint program = gl.createProgram();
+    for (GLenum stage : {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER}) {
+        GLuint shader = gl.createShader(stage);
+        gl.compileShader(shader);
+        gl.attachShader(program, shader);
+    }
+    gl.linkProgram(program);
+    gl.clearLog();
+
+    meshes::MeshBuffers buffers = mesh.upload(gl);
+    EXPECT_EQ(buffers.indexType, static_cast<GLenum>(GL_UNSIGNED_SHORT));
+    EXPECT_EQ(gl.getLog(), "glGenVertexArrays(1) -> [4]\n"
+                           "glGenBuffers(1) -> [5]\n"
+                           "glGenBuffers(1) -> [6]\n"
+                           "glBindVertexArray(4)\n"
+                           "glBindBuffer(GL_ARRAY_BUFFER, 5)\n"
+                           "glBufferData(GL_ARRAY_BUFFER, 128, data:ef8fd403950e2dc5, GL_STATIC_DRAW)\n"
+                           "glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, 16, 0)\n"
+                           "glEnableVertexAttribArray(0)\n"
+                           "glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, 16, 8)\n"
+                           "glEnableVertexAttribArray(1)\n"
+                           "glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, 16, 12)\n"
+                           "glEnableVertexAttribArray(2)\n"
+                           "glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 6)\n"
+                           "glBufferData(GL_ELEMENT_ARRAY_BUFFER, 24, data:b5bd1a25351f2d25, GL_STATIC_DRAW)\n"
+                           "glBindVertexArray(0)\n");
+
+    // Every submesh draws inside the element buffer.
+    gl.useProgram(program);
+    gl.bindVertexArray(buffers.vertexArray);
+    for (size_t i = 0; i < mesh.getSubmeshCount(); ++i) {
+        const meshes::Submesh &submesh = mesh.getSubmeshes()[i];
+        gl.drawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(submesh.indexCount), buffers.indexType,
+                                  reinterpret_cast<const void *>(submesh.firstIndex * mesh.getIndexSize()),
+                                  static_cast<GLint>(submesh.baseVertex));
+    }
+    EXPECT_EQ(gl.getDrawCalls(), 2u);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 0u) << gl.getLog();
+    EXPECT_EQ(gl.countIssues(IssueType::Redundant), 0u) << gl.getLog();
+}
+
+TEST_F(MeshFile, RejectsSubmeshesOutsideTheirSections) {
+    write({{0, 6, 0, 4, 0}, {6, 6, 4, 4, 1}});
+    EXPECT_NO_THROW(meshes::MeshFile{path});
+
+    write({{0, 6, 0, 4, 0}, {6, 8, 4, 4, 1}});
+    EXPECT_THROW(meshes::MeshFile{path}, std::runtime_error);
+
+    write({{0, 6, 0, 4, 0}, {6, 6, 5, 4, 1}});
+    EXPECT_THROW(meshes::MeshFile{path}, std::runtime_error);
+
+    // Sums that wrap around in 32 bits.
+    write({{0xfffffffau, 6, 0, 4, 0}});
+    EXPECT_THROW(meshes::MeshFile{path}, std::runtime_error);
+    write({{0, 6, 0xffffffffu, 4, 0}});
+    EXPECT_THROW(meshes::MeshFile{path}, std::runtime_error);
+}
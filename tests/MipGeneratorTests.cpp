@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MipGenerator.h"
+
+namespace {
+    std::vector<uint8_t> makeNoise(int width, int height, unsigned seed) {
+        std::mt19937 random(seed);
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+        for (auto &value : pixels) {
+            value = static_cast<uint8_t>(random());
+        }
+        return pixels;
+    }
+
+    int clampIndex(int index, int size) {
+        return std::min(std::max(index, 0), size - 1);
+    }
+
+    // Straight from the definition, one pixel and channel at a time.
+    std::vector<uint8_t> boxReference(const std::vector<uint8_t> &source, int width, int height) {
+        int targetWidth = std::max(width / 2, 1);
+        int targetHeight = std::max(height / 2, 1);
+        std::vector<uint8_t> result(static_cast<size_t>(targetWidth) * targetHeight * 4);
+        for (int y = 0; y < targetHeight; ++y) {
+            for (int x = 0; x < targetWidth; ++x) {
+                for (int channel = 0; channel < 4; ++channel) {
+                    int sum = 0;
+                    for (int dy = 0; dy < 2; ++dy) {
+                        for (int dx = 0; dx < 2; ++dx) {
+                            int sourceX = clampIndex(2 * x + dx, width);
+                            int sourceY = clampIndex(2 * y + dy, height);
+                            sum += source[(static_cast<size_t>(sourceY) * width + sourceX) * 4 + channel];
+                        }
+                    }
+                    result[(static_cast<size_t>(y) * targetWidth + x) * 4 + channel] =
+                            static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    // The 8-tap Kaiser-windowed sinc (alpha 4) in double precision, applied as
+    // a full 2D sum rather than two passes.
+    std::vector<uint8_t> kaiserReference(const std::vector<uint8_t> &source, int width, int height) {
+        const double Pi = 3.14159265358979323846;
+        auto besselI0 = [](double x) {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int k = 1; k < 32; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+        double weights[8];
+        double total = 0.0;
+        for (int i = 0; i < 8; ++i) {
+            double offset = i - 3.5;
+            double window = offset / 4.0;
+            weights[i] = std::sin(Pi * offset / 2.0) / (Pi * offset / 2.0) *
+                         besselI0(4.0 * std::sqrt(1.0 - window * window)) / besselI0(4.0);
+            total += weights[i];
+        }
+        for (double &weight : weights) {
+            weight /= total;
+        }
+
+        int targetWidth = std::max(width / 2, 1);
+        int targetHeight = std::max(height / 2, 1);
+        std::vector<uint8_t> result(static_cast<size_t>(targetWidth) * targetHeight * 4);
+        for (int y = 0; y < targetHeight; ++y) {
+            for (int x = 0; x < targetWidth; ++x) {
+                for (int channel = 0; channel < 4; ++channel) {
+                    double sum = 0.0;
+                    for (int ty = 0; ty < 8; ++ty) {
+                        int sourceY = clampIndex(2 * y - 3 + ty, height);
+                        for (int tx = 0; tx < 8; ++tx) {
+                            int sourceX = clampIndex(2 * x - 3 + tx, width);
+                            sum += weights[ty] * weights[tx] *
+                                   source[(static_cast<size_t>(sourceY) * width + sourceX) * 4 + channel];
+                        }
+                    }
+                    result[(static_cast<size_t>(y) * targetWidth + x) * 4 + channel] =
+                            static_cast<uint8_t>(std::min(std::max(std::lround(sum), 0L), 255L));
+                }
+            }
+        }
+        return result;
+    }
+
+    // Sizes that hit the vector loop, its scalar tail, odd edges and 1-pixel sides.
+    const std::pair<int, int> Sizes[] = {{16, 16}, {19, 7}, {13, 1}, {1, 9}, {1, 1}, {2, 3}, {33, 2}};
+}
+
+TEST(MipGenerator, BoxMatchesTheReference) {
+    for (auto size : Sizes) {
+        auto source = makeNoise(size.first, size.second, 1);
+        auto expected = boxReference(source, size.first, size.second);
+        std::vector<uint8_t> result(expected.size());
+        textures::downsampleBox(source.data(), size.first, size.second, result.data());
+        EXPECT_EQ(result, expected) << size.first << "x" << size.second;
+    }
+}
+
+TEST(MipGenerator, KaiserMatchesTheReferenceWithinRounding) {
+    for (auto size : Sizes) {
+        auto source = makeNoise(size.first, size.second, 2);
+        auto expected = kaiserReference(source, size.first, size.second);
+        std::vector<uint8_t> result(expected.size());
+        textures::downsampleKaiser(source.data(), size.first, size.second, result.data());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_LE(std::abs(result[i] - expected[i]), 1) << size.first << "x" << size.second << " byte " << i;
+        }
+    }
+}
+
+TEST(MipGenerator, ChainRunsDownToOnePixel) {
+    auto source = makeNoise(12, 5, 3);
+    auto chain = textures::generateMipChain(source.data(), 12, 5, textures::MipFilter::Box);
+    std::vector<std::pair<int, int>> sizes;
+    for (const auto &level : chain.levels) {
+        sizes.emplace_back(level.width, level.height);
+        EXPECT_EQ(level.size, static_cast<size_t>(level.width) * level.height * 4);
+    }
+    EXPECT_EQ(sizes, (std::vector<std::pair<int, int>>{{12, 5}, {6, 2}, {3, 1}, {1, 1}}));
+    EXPECT_EQ(chain.levels.back().offset + chain.levels.back().size, chain.pixels.size());
+    EXPECT_TRUE(std::equal(source.begin(), source.end(), chain.pixels.begin()));
+
+    auto second = boxReference(source, 12, 5);
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), chain.pixels.begin() + chain.levels[1].offset));
+}
@@ -0,0 +1,204 @@
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Profiler.h"
+
+namespace {
+    struct JsonValue {
+        enum class Type { Null, Boolean, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> elements;   // array elements or object members
+        std::vector<std::string> keys;     // object members only
+
+        const JsonValue &operator[](const std::string &key) const {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) {
+                    return elements[i];
+                }
+            }
+            throw std::runtime_error("no member '" + key + "'");
+        }
+    };
+
+    // Just enough of RFC 8259 to check that a trace is well-formed JSON; throws
+    // std::runtime_error at the first thing that isn't.
+    class JsonParser {
+    public:
+        explicit JsonParser(const std::string &text) : text(text) {}
+
+        JsonValue parse() {
+            JsonValue value = parseValue();
+            skipSpace();
+            if (position != text.size()) {
+                fail("trailing characters");
+            }
+            return value;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string &what) const {
+            throw std::runtime_error(what + " at offset " + std::to_string(position));
+        }
+
+        void skipSpace() {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+        }
+
+        bool consume(char expected) {
+            skipSpace();
+            if (position < text.size() && text[position] == expected) {
+                ++position;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char expected) {
+            if (!consume(expected)) {
+                fail(std::string("expected '") + expected + "'");
+            }
+        }
+
+        std::string parseString() {
+            expect('"');
+            std::string result;
+            while (position < text.size() && text[position] != '"') {
+                if (text[position] == '\\' && ++position == text.size()) {
+                    break;
+                }
+                result += text[position++];
+            }
+            expect('"');
+            return result;
+        }
+
+        JsonValue parseValue() {
+            skipSpace();
+            JsonValue value;
+            if (position == text.size()) {
+                fail("unexpected end");
+            } else if (consume('{')) {
+                value.type = JsonValue::Type::Object;
+                if (!consume('}')) {
+                    do {
+                        value.keys.push_back(parseString());
+                        expect(':');
+                        value.elements.push_back(parseValue());
+                    } while (consume(','));
+                    expect('}');
+                }
+            } else if (consume('[')) {
+                value.type = JsonValue::Type::Array;
+                if (!consume(']')) {
+                    do {
+                        value.elements.push_back(parseValue());
+                    } while (consume(','));
+                    expect(']');
+                }
+            } else if (text[position] == '"') {
+                value.type = JsonValue::Type::String;
+                value.string = parseString();
+            } else if (text.compare(position, 4, "true") == 0 || text.compare(position, 5, "false") == 0) {
+                value.type = JsonValue::Type::Boolean;
+                position += text[position] == 't' ? 4 : 5;
+            } else if (text.compare(position, 4, "null") == 0) {
+                position += 4;
+            } else {
+                char *end = nullptr;
+                value.type = JsonValue::Type::Number;
+                value.number = std::strtod(text.c_str() + position, &end);
+                if (end == text.c_str() + position) {
+                    fail("unexpected character");
+                }
+                position = static_cast<size_t>(end - text.c_str());
+            }
+            return value;
+        }
+
+        const std::string &text;
+        size_t position = 0;
+    };
+}
+
+TEST(Profiler, FrameTimePercentilesOverAKnownSequence) {
+    auto &profiler = profiling::Profiler::instance();
+    const size_t window = profiling::Profiler::FrameWindow;
+
+    // A full window replaces whatever earlier frames left. Frame i takes one
+    // of 1 to window ms, each once, in an order that isn't sorted.
+    int64_t now = profiling::nowNanoseconds();
+    profiler.endFrame(now);
+    for (size_t i = 0; i < window; ++i) {
+        now += static_cast<int64_t>((i * 7 % window + 1) * 1000000);
+        profiler.endFrame(now);
+    }
+
+    auto stats = profiler.getFrameTimeStats();
+    EXPECT_EQ(stats.samples, window);
+    EXPECT_DOUBLE_EQ(stats.mean, (window + 1) / 2.0);
+    // Nearest rank: the ceil(p * n)th smallest.
+    EXPECT_DOUBLE_EQ(stats.p50, 256.0);
+    EXPECT_DOUBLE_EQ(stats.p95, 487.0);
+    EXPECT_DOUBLE_EQ(stats.p99, 507.0);
+}
+
+TEST(Profiler, CountsEventsLostToARingOverflow) {
+    auto &profiler = profiling::Profiler::instance();
+    const size_t capacity = profiling::Profiler::RingCapacity;
+
+    // Nothing drains between the records, so the first 100 are overwritten.
+    profiler.startCapture();
+    for (size_t i = 0; i < capacity + 100; ++i) {
+        profiler.record("Overflow", static_cast<int64_t>(i), static_cast<int64_t>(i + 1));
+    }
+    profiler.stopCapture();
+
+    EXPECT_EQ(profiler.getDroppedEventCount(), 100u);
+    EXPECT_EQ(profiler.getCapturedEventCount(), capacity);
+}
+
+TEST(Profiler, WritesTraceEventJson) {
+    auto &profiler = profiling::Profiler::instance();
+    profiler.startCapture();
+    profiler.record("Scope \"quoted\"", 1000, 3000);
+    profiler.counter("Queue depth", 3.0);
+    profiler.stopCapture();
+
+    std::string path = (std::filesystem::temp_directory_path() / "render_tests_trace.json").string();
+    ASSERT_TRUE(profiler.writeTrace(path));
+    std::stringstream text;
+    text << std::ifstream(path).rdbuf();
+    std::filesystem::remove(path);
+
+    JsonValue trace;
+    ASSERT_NO_THROW(trace = JsonParser(text.str()).parse()) << text.str();
+    const JsonValue &events = trace["traceEvents"];
+    ASSERT_EQ(events.type, JsonValue::Type::Array);
+    ASSERT_EQ(events.elements.size(), 2u);
+
+    // Timestamps and durations in microseconds from the earliest event.
+    const JsonValue &scope = events.elements[0];
+    EXPECT_EQ(scope["name"].string, "Scope \"quoted\"");
+    EXPECT_EQ(scope["ph"].string, "X");
+    EXPECT_DOUBLE_EQ(scope["ts"].number, 0.0);
+    EXPECT_DOUBLE_EQ(scope["dur"].number, 2.0);
+    EXPECT_EQ(scope["pid"].type, JsonValue::Type::Number);
+    EXPECT_EQ(scope["tid"].type, JsonValue::Type::Number);
+
+    const JsonValue &counter = events.elements[1];
+    EXPECT_EQ(counter["name"].string, "Queue depth");
+    EXPECT_EQ(counter["ph"].string, "C");
+    EXPECT_GT(counter["ts"].number, 0.0);
+    EXPECT_DOUBLE_EQ(counter["args"]["value"].number, 3.0);
+}
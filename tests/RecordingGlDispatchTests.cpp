@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "RecordingGlDispatch.h"
+
+namespace {
+    using render::RecordingGlDispatch;
+    using IssueType = render::RecordingGlDispatch::IssueType;
+
+    GLuint linkProgram(RecordingGlDispatch &gl) {
+        GLuint program = gl.createProgram();
+        for (GLenum stage : {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER}) {
+            GLuint shader = gl.createShader(stage);
+            gl.compileShader(shader);
+            gl.attachShader(program, shader);
+        }
+        gl.linkProgram(program);
+        return program;
+    }
+
+    // A linked program in use and a vertex array with one configured
+    // attribute and an element buffer of indexBytes.
+    void setUpDraw(RecordingGlDispatch &gl, GLsizeiptr indexBytes) {
+        gl.useProgram(linkProgram(gl));
+
+        GLuint vao;
+        GLuint buffers[2];
+        gl.genVertexArrays(1, &vao);
+        gl.genBuffers(2, buffers);
+        gl.bindVertexArray(vao);
+        gl.bindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        gl.bufferData(GL_ARRAY_BUFFER, 64, nullptr, GL_STATIC_DRAW);
+        gl.vertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8, nullptr);
+        gl.enableVertexAttribArray(0);
+        gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+        gl.bufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
+    }
+}
+
+TEST(RecordingGlDispatch, LogsCallsWithTheirIssues) {
+    RecordingGlDispatch gl;
+    GLuint buffer;
+    gl.genBuffers(1, &buffer);
+    gl.bindBuffer(GL_ARRAY_BUFFER, buffer);
+    gl.bindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    EXPECT_EQ(gl.getLog(), "glGenBuffers(1) -> [1]\n"
+                           "glBindBuffer(GL_ARRAY_BUFFER, 1)\n"
+                           "glBindBuffer(GL_ARRAY_BUFFER, 1)\n"
+                           "  ! redundant: buffer 1 is already bound to GL_ARRAY_BUFFER\n");
+    ASSERT_EQ(gl.getIssues().size(), 1u);
+    EXPECT_EQ(gl.getIssues()[0].call, 2u);
+
+    gl.clearLog();
+    EXPECT_TRUE(gl.getCalls().empty());
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    EXPECT_TRUE(gl.getIssues().empty());
+}
+
+TEST(RecordingGlDispatch, CleanDrawHasNoIssues) {
+    RecordingGlDispatch gl;
+    setUpDraw(gl, 24);
+    gl.drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+
+    EXPECT_TRUE(gl.getIssues().empty()) << gl.getLog();
+    EXPECT_EQ(gl.getDrawCalls(), 1u);
+}
+
+TEST(RecordingGlDispatch, FlagsDrawsOutsideTheElementBuffer) {
+    RecordingGlDispatch gl;
+    setUpDraw(gl, 24);
+    gl.drawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, reinterpret_cast<const void *>(12), 0);
+
+    ASSERT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+    EXPECT_EQ(gl.getIssues()[0].message, "reads indices past the end of element array buffer 6");
+}
+
+TEST(RecordingGlDispatch, ElementBufferBelongsToTheVertexArray) {
+    RecordingGlDispatch gl;
+    setUpDraw(gl, 24);
+
+    GLuint other;
+    gl.genVertexArrays(1, &other);
+    gl.bindVertexArray(other);
+    gl.drawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+
+    gl.bindVertexArray(4);
+    gl.drawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 1u) << gl.getLog();
+}
+
+TEST(RecordingGlDispatch, FlagsDrawsWithoutProgramOrPointers) {
+    RecordingGlDispatch gl;
+    GLuint vao;
+    gl.genVertexArrays(1, &vao);
+    gl.bindVertexArray(vao);
+    gl.enableVertexAttribArray(1);
+    gl.drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 0);
+
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 2u) << gl.getLog();
+    EXPECT_EQ(gl.countIssues(IssueType::Redundant), 1u) << gl.getLog();
+}
+
+TEST(RecordingGlDispatch, FlagsWritesPastBufferStorage) {
+    RecordingGlDispatch gl;
+    GLuint buffer;
+    gl.genBuffers(1, &buffer);
+    gl.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    gl.bufferSubData(GL_COPY_WRITE_BUFFER, 0, 4, "data");
+    gl.bufferData(GL_COPY_WRITE_BUFFER, 16, nullptr, GL_STATIC_DRAW);
+    gl.bufferSubData(GL_COPY_WRITE_BUFFER, 8, 8, "abcdefgh");
+    gl.bufferSubData(GL_COPY_WRITE_BUFFER, 12, 8, "abcdefgh");
+
+    ASSERT_EQ(gl.countIssues(IssueType::Invalid), 2u);
+    EXPECT_EQ(gl.getIssues()[0].message, "buffer 1 has no storage");
+    EXPECT_EQ(gl.getIssues()[1].message, "writes past the end of buffer 1");
+}
+
+TEST(RecordingGlDispatch, FlagsRedundantUniformsAndState) {
+    RecordingGlDispatch gl;
+    GLuint program = linkProgram(gl);
+    GLint location = gl.getUniformLocation(program, "color");
+    gl.useProgram(program);
+    gl.uniform4f(location, 1.f, 0.f, 0.f, 1.f);
+    gl.uniform4f(location, 1.f, 0.f, 0.f, 1.f);
+    gl.uniform4f(location, 0.f, 0.f, 0.f, 1.f);
+    gl.useProgram(program);
+    gl.enable(GL_BLEND);
+    gl.enable(GL_BLEND);
+    gl.blendFunc(GL_ONE, GL_ZERO);
+
+    EXPECT_EQ(gl.countIssues(IssueType::Redundant), 4u) << gl.getLog();
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 0u) << gl.getLog();
+
+    gl.uniform1f(location + 1, 1.f);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+}
+
+TEST(RecordingGlDispatch, DefersDeletingTheProgramInUse) {
+    RecordingGlDispatch gl;
+    GLuint program = linkProgram(gl);
+    gl.useProgram(program);
+    size_t live = gl.getLiveObjectCount();
+
+    gl.deleteProgram(program);
+    EXPECT_EQ(gl.getLiveObjectCount(), live - 1);
+    gl.useProgram(0);
+    gl.useProgram(program);
+
+    ASSERT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+    EXPECT_EQ(gl.getIssues()[0].message, "1 is not a program");
+}
+
+TEST(RecordingGlDispatch, ErrorDirectiveFailsCompileAndLink) {
+    RecordingGlDispatch gl;
+    const char *source = "#version 330 core\n#error not yet\nvoid main() {}\n";
+    GLuint shader = gl.createShader(GL_FRAGMENT_SHADER);
+    gl.shaderSource(shader, 1, &source, nullptr);
+    gl.compileShader(shader);
+
+    GLint status;
+    gl.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+    EXPECT_EQ(status, GL_FALSE);
+    GLchar log[64];
+    gl.getShaderInfoLog(shader, sizeof(log), nullptr, log);
+    EXPECT_STREQ(log, "ERROR: #error not yet\n");
+
+    GLuint program = gl.createProgram();
+    gl.attachShader(program, shader);
+    gl.linkProgram(program);
+    gl.getProgramiv(program, GL_LINK_STATUS, &status);
+    EXPECT_EQ(status, GL_FALSE);
+    EXPECT_EQ(gl.getUniformLocation(program, "color"), -1);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+}
+
+TEST(RecordingGlDispatch, QueriesEndBeforeTheyAreRead) {
+    RecordingGlDispatch gl;
+    GLuint query;
+    gl.genQueries(1, &query);
+    gl.beginQuery(GL_TIME_ELAPSED, query);
+
+    GLint available;
+    gl.getQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 1u);
+
+    gl.endQuery(GL_TIME_ELAPSED);
+    gl.getQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    EXPECT_EQ(available, GL_TRUE);
+    gl.endQuery(GL_TIME_ELAPSED);
+    EXPECT_EQ(gl.countIssues(IssueType::Invalid), 2u);
+}
+
+TEST(RecordingGlDispatch, TextureWritesStayInsideTheirLevel) {
+    RecordingGlDispatch gl;
+    GLuint texture;
+    gl.genTextures(1, &texture);
+    gl.bindTexture(GL_TEXTURE_2D, texture);
+    gl.texImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl.texSubImage2D(GL_TEXTURE_2D, 0, 0, 2, 4, 2, GL_RGBA, GL_UNSIGNED_BYTE, "0123456789abcdef0123456789abcdef");
+    gl.texSubImage2D(GL_TEXTURE_2D, 0, 0, 3, 4, 2, GL_RGBA, GL_UNSIGNED_BYTE, "0123456789abcdef0123456789abcdef");
+    gl.texSubImage2D(GL_TEXTURE_2D, 1, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, "0123");
+    gl.pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    ASSERT_EQ(gl.countIssues(IssueType::Invalid), 2u) << gl.getLog();
+    EXPECT_EQ(gl.getIssues()[0].message, "writes outside level 0 of texture 1");
+    EXPECT_EQ(gl.getIssues()[1].message, "level 1 of texture 1 has no storage");
+    EXPECT_EQ(gl.countIssues(IssueType::Redundant), 1u);
+}
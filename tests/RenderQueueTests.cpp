@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+#include "RenderQueue.h"
+
+namespace {
+    void submitFrame(render::RenderQueue &queue, render::MaterialId material) {
+        queue.submit({0, 0, material, 0, 0.f, 6, 0, 0});
+        queue.flush();
+    }
+}
+
+TEST(RenderQueue, InvalidatingBindingsKeepsUniformsCached) {
+    render::CountingGlDispatch gl;
+    render::RenderQueue queue(gl);
+    queue.addProgram(1);
+    queue.addVertexArray(2);
+    render::MaterialId material = queue.addMaterial({{{0, 4, {1.f, 0.f, 0.f, 1.f}}}});
+
+    submitFrame(queue, material);
+    queue.invalidateBindings();
+    submitFrame(queue, material);
+    EXPECT_EQ(gl.counters.programBinds, 2u);
+    EXPECT_EQ(gl.counters.vertexArrayBinds, 2u);
+    EXPECT_EQ(gl.counters.uniforms, 1u);
+
+    queue.invalidateState();
+    submitFrame(queue, material);
+    EXPECT_EQ(gl.counters.uniforms, 2u);
+}
@@ -0,0 +1,120 @@
+#include <chrono>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "GlDispatch.h"
+#include "RenderThread.h"
+
+namespace {
+    // A render device without a context: programs are made-up names and
+    // present does nothing, so the render thread runs on a mock dispatch.
+    class NullRenderDevice : public render::RenderDevice {
+    public:
+        void makeCurrent() override {}
+        Programs loadPrograms() override { return {1, 0, 2, 0}; }
+        bool reloadPrograms(Programs &) override { return false; }
+        void beginFrame() override {}
+        void present() override {}
+        void release() override {}
+    };
+
+    // Counts the calls like its base and checks that every shape upload holds
+    // one whole snapshot: the test gives all shapes of a snapshot the same
+    // ring thickness, so a snapshot mixed from two publishes shows up as an
+    // upload with two thicknesses.
+    class SnapshotCheckingDispatch : public render::CountingGlDispatch {
+    public:
+        size_t shapeUploads = 0;
+        size_t tornUploads = 0;
+
+        void bindBuffer(GLenum target, GLuint buffer) override {
+            arrayBufferBound = target == GL_ARRAY_BUFFER ? buffer != 0 : arrayBufferBound;
+            CountingGlDispatch::bindBuffer(target, buffer);
+        }
+
+        void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) override {
+            if (target == GL_ARRAY_BUFFER && arrayBufferBound) {
+                auto shapes = static_cast<const render::ShapeInstance *>(data);
+                size_t count = static_cast<size_t>(size) / sizeof(render::ShapeInstance);
+                ++shapeUploads;
+                for (size_t i = 1; i < count; ++i) {
+                    if (shapes[i].parameter != shapes[0].parameter) {
+                        ++tornUploads;
+                        break;
+                    }
+                }
+            }
+            CountingGlDispatch::bufferSubData(target, offset, size, data);
+        }
+
+    private:
+        bool arrayBufferBound = false;
+    };
+}
+
+// The simulation side churns meshes through a small command queue every tick
+// and now and then stalls, like a heavy update would, while the render thread
+// draws flat out. No snapshot may arrive torn and every command must run.
+TEST(RenderThread, SurvivesChurnWithoutTornSnapshots) {
+    timing::SchedulerConfig config;
+    config.targetRate = 0.0;
+    NullRenderDevice device;
+    SnapshotCheckingDispatch gl;
+    timing::SteadyClock clock;
+    render::RenderThread renderThread(device, gl, clock, config, 64);
+    renderThread.start();
+
+    GLuint indices[] = {0, 1, 2, 0, 2, 3};
+    auto material = renderThread.createMaterial({1.0, 1.0, 1.0, 1.0});
+    std::vector<render::MeshHandle> meshes;
+    size_t commands = 1;
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (uint32_t tick = 0; tick < 200 && renderThread.isRunning(); ++tick) {
+        // A few meshes come and go every tick; more than the queue holds at
+        // times, so the simulation side stalls on it too.
+        size_t churn = 1 + random() % 80;
+        for (size_t i = 0; i < churn; ++i) {
+            float x = static_cast<float>(unit(random)) * 1.8f - 1.f;
+            float y = static_cast<float>(unit(random)) * 1.8f - 1.f;
+            meshes.push_back(renderThread.createMesh({x, y, x + 0.1f, y, x + 0.1f, y + 0.1f, x, y + 0.1f},
+                                                     {indices, indices + 6}));
+            ++commands;
+        }
+        while (meshes.size() > 256) {
+            renderThread.destroyMesh(meshes.front());
+            meshes.erase(meshes.begin());
+            ++commands;
+        }
+
+        if (unit(random) < 0.05) {
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+            while (std::chrono::steady_clock::now() < end) {
+            }
+        }
+
+        auto &snapshot = renderThread.beginSnapshot();
+        snapshot.framebufferSize = {1920, 1080};
+        snapshot.draws.clear();
+        for (auto mesh : meshes) {
+            snapshot.draws.push_back({mesh, material});
+        }
+        snapshot.shapes.clear();
+        float thickness = 1.f + tick % 8;
+        for (size_t i = 0; i < 1000; ++i) {
+            glm::vec2 center((i * 37) % 1920, (i * 91) % 1080);
+            snapshot.shapes.push_back(render::makeRing(center, 12.f, thickness, {0.0, 0.5, 1.0, 1.0}));
+        }
+        renderThread.publishSnapshot();
+    }
+
+    renderThread.stop();
+    EXPECT_EQ(renderThread.getError(), "");
+    auto stats = renderThread.getStats();
+    EXPECT_EQ(stats.commands, commands);
+    EXPECT_EQ(stats.snapshotsPublished, 200u);
+    EXPECT_GT(stats.snapshotsRendered, 0u);
+    EXPECT_GT(gl.shapeUploads, 0u);
+    EXPECT_EQ(gl.tornUploads, 0u);
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include "SceneFile.h"
+#include "SceneText.h"
+
+namespace {
+    // Two roots, one with a child, and a mesh shared by all three nodes.
+    std::vector<char> makeImage() {
+        scene::SceneDescription description;
+        description.meshes.push_back({"quad", {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f}, {0, 1, 2, 0, 2, 3}});
+        description.materials.push_back({"white"});
+        description.nodes.push_back({"a", scene::NoIndex, 0, 0});
+        description.nodes.push_back({"b", 0, 0, 0});
+        description.nodes.push_back({"c", scene::NoIndex, 0, 0});
+        return scene::compileScene(description);
+    }
+
+    scene::SceneHeader &headerOf(std::vector<char> &image) {
+        return *reinterpret_cast<scene::SceneHeader *>(image.data());
+    }
+
+    std::string openError(std::vector<char> image) {
+        try {
+            scene::SceneFile file(std::move(image), "test");
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+        return {};
+    }
+}
+
+TEST(SceneFile, OpensACompiledImage) {
+    scene::SceneFile file(makeImage(), "test");
+    EXPECT_EQ(file.getRootCount(), 2u);
+    EXPECT_EQ(file.getNodeCount(), 3u);
+    ASSERT_EQ(file.getMeshCount(), 1u);
+    EXPECT_EQ(file.getIndices(file.getMeshes()[0])[2], 2u);
+    EXPECT_EQ(file.getVertices(file.getMeshes()[0])[2], 1.f);
+}
+
+TEST(SceneFile, RejectsTruncatedImages) {
+    std::vector<char> image = makeImage();
+    EXPECT_EQ(openError({image.begin(), image.begin() + sizeof(scene::SceneHeader) - 1}), "Scene 'test' is truncated");
+    // Every cut that loses part of a section.
+    const scene::SceneHeader &header = headerOf(image);
+    size_t end = std::max({header.rootOffset + header.rootCount * sizeof(scene::SceneRoot),
+                           header.meshOffset + header.meshCount * sizeof(scene::SceneMesh),
+                           header.materialOffset + header.materialCount * sizeof(scene::SceneMaterial),
+                           header.nodeOffset + header.nodeCount * sizeof(scene::SceneNode),
+                           header.vertexOffset + header.vertexCount * 2 * sizeof(float),
+                           header.indexOffset + header.indexCount * sizeof(uint32_t)});
+    ASSERT_LE(end, image.size());
+    for (size_t size = sizeof(scene::SceneHeader); size < end; size += 4) {
+        EXPECT_EQ(openError({image.begin(), image.begin() + size}), "Scene 'test' is corrupt") << size;
+    }
+}
+
+TEST(SceneFile, RejectsForeignAndCorruptHeaders) {
+    std::vector<char> image = makeImage();
+    headerOf(image).magic = 0;
+    EXPECT_EQ(openError(image), "'test' is not a compiled scene");
+
+    image = makeImage();
+    headerOf(image).version = scene::SceneVersion + 1;
+    EXPECT_EQ(openError(image), "Scene 'test' has version 2, expected 1; compile it again");
+
+    image = makeImage();
+    headerOf(image).nodeOffset += 1;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    image = makeImage();
+    headerOf(image).indexCount = ~0u;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    image = makeImage();
+    headerOf(image).vertexOffset = ~uint64_t(0) & ~(scene::SceneAlignment - 1);
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+}
+
+TEST(SceneFile, RejectsRootsMeshesAndIndicesOutOfRange) {
+    std::vector<char> image = makeImage();
+    auto *roots = reinterpret_cast<scene::SceneRoot *>(image.data() + headerOf(image).rootOffset);
+    roots[1].node = 3;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    image = makeImage();
+    auto *meshes = reinterpret_cast<scene::SceneMesh *>(image.data() + headerOf(image).meshOffset);
+    meshes[0].firstIndex = 1;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    image = makeImage();
+    meshes = reinterpret_cast<scene::SceneMesh *>(image.data() + headerOf(image).meshOffset);
+    meshes[0].firstVertex = ~0u;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    // An index past the mesh's own vertices, though still inside the section.
+    image = makeImage();
+    meshes = reinterpret_cast<scene::SceneMesh *>(image.data() + headerOf(image).meshOffset);
+    meshes[0].vertexCount = 3;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+
+    image = makeImage();
+    auto *indices = reinterpret_cast<uint32_t *>(image.data() + headerOf(image).indexOffset);
+    indices[5] = 4;
+    EXPECT_EQ(openError(image), "Scene 'test' is corrupt");
+}
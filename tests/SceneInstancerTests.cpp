@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "SceneInstancer.h"
+#include "SceneText.h"
+#include "ShapeBatcher.h"
+
+namespace {
+    scene::Frustum everything() {
+        return scene::Frustum::fromMatrix(glm::ortho(-10.f, 10.f, -10.f, 10.f, -1.f, 1.f), 0.f, 0.f);
+    }
+
+    // Two roots with a quad each, the second with a material out of range.
+    std::vector<char> makeCorruptImage() {
+        scene::SceneDescription description;
+        description.meshes.push_back({"quad", {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f}, {0, 1, 2}});
+        description.materials.push_back({"white"});
+        description.nodes.push_back({"first", scene::NoIndex, 0, 0});
+        description.nodes.push_back({"second", scene::NoIndex, 0, 0});
+        std::vector<char> image = scene::compileScene(description);
+
+        scene::SceneHeader header;
+        std::memcpy(&header, image.data(), sizeof(header));
+        uint32_t material = 7;
+        std::memcpy(image.data() + header.nodeOffset + sizeof(scene::SceneNode) + offsetof(scene::SceneNode, material),
+                    &material, sizeof(material));
+        return image;
+    }
+
+    scene::NodeDescription makeNode(const char *name, uint32_t parent, uint32_t mesh, glm::vec3 position) {
+        scene::NodeDescription node;
+        node.name = name;
+        node.parent = parent;
+        node.mesh = mesh;
+        node.material = mesh == scene::NoIndex ? scene::NoIndex : 0;
+        node.position = position;
+        return node;
+    }
+
+    // Depth first: near 0 with children 1 in view and 2 off to the right, far
+    // 3 with child 4 further right, and empty 5 with child 6, neither of which
+    // has a mesh.
+    std::vector<char> makeSpreadImage() {
+        scene::SceneDescription description;
+        description.meshes.push_back({"quad", {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f}, {0, 1, 2, 0, 2, 3}});
+        description.materials.push_back({"white"});
+        description.nodes.push_back(makeNode("near", scene::NoIndex, scene::NoIndex, {0.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("inView", 0, 0, {0.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("outOfView", 0, 0, {30.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("far", scene::NoIndex, scene::NoIndex, {100.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("farChild", 3, 0, {0.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("empty", scene::NoIndex, scene::NoIndex, {0.f, 0.f, 0.f}));
+        description.nodes.push_back(makeNode("emptyChild", 5, scene::NoIndex, {0.f, 0.f, 0.f}));
+        return scene::compileScene(description);
+    }
+
+    std::string instantiateError(scene::SceneInstancer &instancer) {
+        try {
+            instancer.instantiate(everything());
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+        return {};
+    }
+}
+
+TEST(SceneInstancer, InstantiatesOnlyWhatComesIntoView) {
+    scene::SceneFile file(makeSpreadImage(), "spread");
+    threading::ThreadPool pool(1);
+    scene::TransformSystem transforms(pool);
+    scene::SceneInstancer instancer(file, transforms);
+    EXPECT_EQ(instancer.getPendingCount(), 3u);
+
+    EXPECT_EQ(instancer.instantiate(everything()), (std::vector<uint32_t>{0, 1}));
+    EXPECT_EQ(instancer.getPendingCount(), 2u);
+    EXPECT_EQ(transforms.size(), 2u);
+    EXPECT_EQ(transforms.getParent(instancer.getObject(1)), instancer.getObject(0));
+    EXPECT_EQ(instancer.getObject(2), scene::NoParent);
+
+    // Nothing new in view creates nothing.
+    EXPECT_TRUE(instancer.instantiate(everything()).empty());
+
+    auto right = scene::Frustum::fromMatrix(glm::ortho(20.f, 120.f, -10.f, 10.f, -1.f, 1.f), 0.f, 0.f);
+    EXPECT_EQ(instancer.instantiate(right), (std::vector<uint32_t>{2, 3, 4}));
+    EXPECT_EQ(instancer.getPendingCount(), 0u);
+    EXPECT_EQ(instancer.getInstantiatedCount(), 5u);
+
+    // Subtrees without meshes are never instantiated, whatever the view.
+    auto all = scene::Frustum::fromMatrix(glm::ortho(-200.f, 200.f, -200.f, 200.f, -1.f, 1.f), 0.f, 0.f);
+    EXPECT_TRUE(instancer.instantiate(all).empty());
+    EXPECT_EQ(instancer.getObject(5), scene::NoParent);
+    EXPECT_EQ(instancer.getObject(6), scene::NoParent);
+}
+
+TEST(SceneInstancer, StaysFailedAfterACorruptNode) {
+    scene::SceneFile file(makeCorruptImage(), "corrupt");
+    threading::ThreadPool pool(1);
+    scene::TransformSystem transforms(pool);
+    scene::SceneInstancer instancer(file, transforms);
+
+    EXPECT_EQ(instantiateError(instancer), "Scene node 1 is corrupt");
+    EXPECT_EQ(instancer.getInstantiatedCount(), 1u);
+    EXPECT_NE(instancer.getObject(0), scene::NoParent);
+
+    // Retrying neither creates the first root again nor gets past the second.
+    EXPECT_EQ(instantiateError(instancer), "Scene node 1 is corrupt");
+    EXPECT_EQ(instancer.getInstantiatedCount(), 1u);
+}
+
+TEST(SceneInstancer, FigureHeadBecomesARoundPixelCircle) {
+    scene::SceneMesh quad = {0, 4, 0, 6, {-1.f, -1.f}, {1.f, 1.f}};
+    glm::mat4 world = glm::scale(glm::translate(glm::mat4(1.f), {0.f, 0.7f, 0.f}), {0.2f, 0.2f, 1.f});
+    scene::SceneCircle circle = scene::getInscribedCircle(quad, world);
+    EXPECT_FLOAT_EQ(circle.center.y, 0.7f);
+    EXPECT_FLOAT_EQ(circle.radius, 0.2f);
+
+    render::ShapeInstance shape = render::makeNdcCircle(circle.center, circle.radius, {640.f, 480.f}, glm::vec4(1.f));
+    EXPECT_FLOAT_EQ(shape.center[0], 320.f);
+    EXPECT_FLOAT_EQ(shape.center[1], 72.f);
+    EXPECT_FLOAT_EQ(shape.halfSize[0], 48.f);
+    EXPECT_FLOAT_EQ(shape.halfSize[1], 48.f);
+}
@@ -0,0 +1,90 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include "SceneText.h"
+
+namespace {
+    const char *const Figure = "# comment\n"
+                               "mesh quad\n"
+                               "    vertex -1 -1\n"
+                               "    vertex 1 -1\n"
+                               "    vertex 1 1\n"
+                               "    vertex -1 1\n"
+                               "    triangle 0 1 2\n"
+                               "    triangle 0 2 3\n"
+                               "end\n"
+                               "\n"
+                               "material black 0 0 0 1\n"
+                               "material green 0 1 0 1 circle\n"
+                               "node figure\n"
+                               "node body parent figure mesh quad material black position 0 0.1 0 scale 0.3 0.4 1\n"
+                               "node head parent figure mesh quad material green position 0 0.7 0 "
+                               "rotation 30 0 0 1 scale 0.2 0.2 1\n";
+
+    scene::SceneDescription parse(const std::string &text) {
+        std::istringstream input(text);
+        return scene::parseSceneText(input, "test.scene.txt");
+    }
+
+    std::string parseError(const std::string &text) {
+        try {
+            parse(text);
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+        return {};
+    }
+}
+
+TEST(SceneText, ReadsBackWhatItWrites) {
+    scene::SceneDescription original = parse(Figure);
+    ASSERT_EQ(original.nodes.size(), 3u);
+    EXPECT_EQ(original.nodes[2].parent, 0u);
+    EXPECT_EQ(original.materials[1].shader, scene::MaterialShader::Circle);
+
+    std::ostringstream written;
+    scene::writeSceneText(original, written);
+    scene::SceneDescription copy = parse(written.str());
+
+    ASSERT_EQ(copy.meshes.size(), original.meshes.size());
+    EXPECT_EQ(copy.meshes[0].name, "quad");
+    EXPECT_EQ(copy.meshes[0].vertices, original.meshes[0].vertices);
+    EXPECT_EQ(copy.meshes[0].indices, original.meshes[0].indices);
+
+    ASSERT_EQ(copy.materials.size(), original.materials.size());
+    for (size_t i = 0; i < copy.materials.size(); ++i) {
+        EXPECT_EQ(copy.materials[i].name, original.materials[i].name);
+        EXPECT_EQ(copy.materials[i].color, original.materials[i].color);
+        EXPECT_EQ(copy.materials[i].shader, original.materials[i].shader);
+    }
+
+    ASSERT_EQ(copy.nodes.size(), original.nodes.size());
+    for (size_t i = 0; i < copy.nodes.size(); ++i) {
+        const scene::NodeDescription &node = copy.nodes[i];
+        const scene::NodeDescription &expected = original.nodes[i];
+        EXPECT_EQ(node.name, expected.name);
+        EXPECT_EQ(node.parent, expected.parent);
+        EXPECT_EQ(node.mesh, expected.mesh);
+        EXPECT_EQ(node.material, expected.material);
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(node.position[axis], expected.position[axis], 1e-5f) << node.name;
+            EXPECT_NEAR(node.scale[axis], expected.scale[axis], 1e-5f) << node.name;
+        }
+        // q and -q are the same rotation.
+        EXPECT_NEAR(std::abs(glm::dot(node.rotation, expected.rotation)), 1.f, 1e-5f) << node.name;
+    }
+}
+
+TEST(SceneText, NamesTheLineOfTheFirstError) {
+    EXPECT_EQ(parseError("material red 1 0 0 1\nnode a mesh quad material red\n"),
+              "test.scene.txt:2: Mesh 'quad' isn't declared above");
+    EXPECT_EQ(parseError("mesh quad\n    vertex 0 0\n    triangle 0 1 2\nend\n"),
+              "test.scene.txt:4: mesh 'quad' uses vertex 1 of 1");
+    EXPECT_EQ(parseError("material red 1 0 zero 1\n"), "test.scene.txt:1: 'zero' is not a number");
+    EXPECT_EQ(parseError("node a\nnode a\n"), "test.scene.txt:2: Node 'a' is declared twice");
+    EXPECT_EQ(parseError("node a spin 1\n"), "test.scene.txt:1: unknown node option 'spin'");
+    EXPECT_EQ(parseError("\nlight sun\n"), "test.scene.txt:2: unknown statement 'light'");
+    EXPECT_EQ(parseError("mesh quad\n    vertex 0 0\n"), "test.scene.txt:2: mesh 'quad' has no end");
+}
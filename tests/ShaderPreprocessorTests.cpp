@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include "ShaderPreprocessor.h"
+
+namespace {
+    // Serves shader files from a map and counts what it was asked for.
+    class ShaderPreprocessor : public testing::Test {
+    protected:
+        shaders::ShaderPreprocessor preprocessor{[this](const std::string &path, std::string &contents) {
+            ++reads[path];
+            auto file = files.find(path);
+            if (file == files.end()) {
+                return false;
+            }
+            contents = file->second;
+            return true;
+        }};
+
+        std::map<std::string, std::string> files;
+        std::map<std::string, int> reads;
+    };
+}
+
+TEST_F(ShaderPreprocessor, ExpandsNestedIncludesWithLineDirectives) {
+    files["shaders/main.glsl"] = "#version 330 core\n#include \"lib/a.glsl\"\nvoid main() {}\n";
+    files["shaders/lib/a.glsl"] = "float a;\n#include \"b.glsl\"\nfloat a2;\n";
+    files["shaders/lib/b.glsl"] = "float b;\n";
+
+    auto result = preprocessor.preprocess("shaders/main.glsl");
+    EXPECT_EQ(result->source, "#version 330 core\n"
+                              "#line 2 0\n"
+                              "#line 1 1\n"
+                              "float a;\n"
+                              "#line 1 2\n"
+                              "float b;\n"
+                              "\n"
+                              "#line 3 1\n"
+                              "float a2;\n"
+                              "\n"
+                              "#line 3 0\n"
+                              "void main() {}\n"
+                              "\n");
+    EXPECT_EQ(result->files,
+              (std::vector<std::string>{"shaders/main.glsl", "shaders/lib/a.glsl", "shaders/lib/b.glsl"}));
+}
+
+TEST_F(ShaderPreprocessor, InjectsDefinesAfterTheVersion) {
+    files["main.glsl"] = "// header\n#version 330 core\nvoid main() {}";
+    auto result = preprocessor.preprocess("main.glsl", {"SHADOWS", "SAMPLES=4"});
+    EXPECT_EQ(result->source, "// header\n"
+                              "#version 330 core\n"
+                              "#define SHADOWS\n"
+                              "#define SAMPLES 4\n"
+                              "#line 3 0\n"
+                              "void main() {}\n");
+
+    // Without a version line the defines go first.
+    files["bare.glsl"] = "void main() {}";
+    EXPECT_EQ(preprocessor.preprocess("bare.glsl", {"A"})->source, "#define A\n#line 1 0\nvoid main() {}\n");
+}
+
+TEST_F(ShaderPreprocessor, IncludesPragmaOnceFilesOnce) {
+    files["main.glsl"] = "#version 330 core\n"
+                         "#include \"common.glsl\"\n"
+                         "#include \"common.glsl\"\n"
+                         "#include \"other.glsl\"\n";
+    files["common.glsl"] = "#pragma once\nfloat common;\n";
+    files["other.glsl"] = "#include \"common.glsl\"\nfloat other;\n";
+
+    auto result = preprocessor.preprocess("main.glsl");
+    size_t first = result->source.find("float common;");
+    ASSERT_NE(first, std::string::npos);
+    EXPECT_EQ(result->source.find("float common;", first + 1), std::string::npos);
+    EXPECT_NE(result->source.find("float other;"), std::string::npos);
+    EXPECT_EQ(reads["common.glsl"], 1);
+}
+
+TEST_F(ShaderPreprocessor, ReportsIncludeCyclesAndMissingFiles) {
+    files["a.glsl"] = "#include \"b.glsl\"\n";
+    files["b.glsl"] = "#include \"a.glsl\"\n";
+    try {
+        preprocessor.preprocess("a.glsl");
+        FAIL() << "the cycle wasn't reported";
+    } catch (const std::runtime_error &error) {
+        EXPECT_STREQ(error.what(), "Shader include cycle: a.glsl -> b.glsl -> a.glsl");
+    }
+
+    files["c.glsl"] = "#include \"missing.glsl\"\n";
+    EXPECT_THROW(preprocessor.preprocess("c.glsl"), std::runtime_error);
+    EXPECT_THROW(preprocessor.preprocess("none.glsl"), std::runtime_error);
+}
+
+TEST_F(ShaderPreprocessor, ResolvesAgainstIncludeDirectories) {
+    preprocessor.addIncludeDirectory("shared/");
+    files["shaders/main.glsl"] = "#include <noise.glsl>\n";
+    files["shared/noise.glsl"] = "float noise;\n";
+    auto result = preprocessor.preprocess("shaders/main.glsl");
+    EXPECT_EQ(result->files, (std::vector<std::string>{"shaders/main.glsl", "shared/noise.glsl"}));
+}
+
+TEST_F(ShaderPreprocessor, InvalidatingADependencyDropsTheResultsUsingIt) {
+    files["flat.glsl"] = "#version 330 core\n#include \"common.glsl\"\n";
+    files["shape.glsl"] = "#version 330 core\n#include \"common.glsl\"\n";
+    files["plain.glsl"] = "#version 330 core\n";
+    files["common.glsl"] = "float version1;\n";
+
+    auto flat = preprocessor.preprocess("flat.glsl");
+    preprocessor.preprocess("flat.glsl", {"A"});
+    preprocessor.preprocess("shape.glsl");
+    preprocessor.preprocess("plain.glsl");
+    EXPECT_EQ(preprocessor.preprocess("flat.glsl"), flat);
+    EXPECT_EQ(preprocessor.getStats().resultHits, 1u);
+
+    files["common.glsl"] = "float version2;\n";
+    auto roots = preprocessor.invalidate("./common.glsl");
+    std::sort(roots.begin(), roots.end());
+    EXPECT_EQ(roots, (std::vector<std::string>{"flat.glsl", "shape.glsl"}));
+
+    auto reloaded = preprocessor.preprocess("flat.glsl");
+    EXPECT_NE(reloaded->hash, flat->hash);
+    EXPECT_NE(reloaded->source.find("version2"), std::string::npos);
+    // Only the changed file is read again; the others stay parsed.
+    EXPECT_EQ(reads["common.glsl"], 2);
+    EXPECT_EQ(reads["flat.glsl"], 1);
+    preprocessor.preprocess("plain.glsl");
+    EXPECT_EQ(preprocessor.getStats().resultHits, 2u);
+}
@@ -0,0 +1,36 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include "ShapeBatcher.h"
+
+namespace {
+    // Summed over the pixels around a shape, the coverage approximates its area.
+    double sumCoverage(const render::ShapeInstance &shape) {
+        int x0 = static_cast<int>(shape.center[0] - shape.halfSize[0]) - 2;
+        int y0 = static_cast<int>(shape.center[1] - shape.halfSize[1]) - 2;
+        int x1 = static_cast<int>(shape.center[0] + shape.halfSize[0]) + 2;
+        int y1 = static_cast<int>(shape.center[1] + shape.halfSize[1]) + 2;
+
+        double covered = 0.0;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                covered += render::shapeCoverage(shape, {x + 0.5f, y + 0.5f});
+            }
+        }
+        return covered;
+    }
+
+    const float Pi = 3.14159265f;
+    const glm::vec4 White = {1.f, 1.f, 1.f, 1.f};
+}
+
+TEST(ShapeBatcher, CoverageAddsUpToTheExactArea) {
+    double circle = Pi * 20.3f * 20.3f;
+    EXPECT_NEAR(sumCoverage(render::makeCircle({50.25f, 50.5f}, 20.3f, White)), circle, circle * 0.005);
+
+    double ring = Pi * (30.f * 30.f - 24.f * 24.f);
+    EXPECT_NEAR(sumCoverage(render::makeRing({50.f, 50.f}, 30.f, 6.f, White)), ring, ring * 0.005);
+
+    double roundedRect = 80.f * 50.f - (4.f - Pi) * 8.f * 8.f;
+    EXPECT_NEAR(sumCoverage(render::makeRoundedRect({60.5f, 40.f}, {40.f, 25.f}, 8.f, White)), roundedRect,
+                roundedRect * 0.005);
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+
+namespace {
+    const uint32_t Black = 0xFF000000u;
+    const uint32_t White = 0xFFFFFFFFu;
+
+    // The pixels one draw call covers on its own, as a mask over the target.
+    std::vector<bool> coverage(raster::SoftwareRasterizer &rasterizer, const raster::DrawCall &call) {
+        rasterizer.clear({0.f, 0.f, 0.f, 1.f});
+        rasterizer.draw(call);
+        rasterizer.flush();
+
+        std::vector<bool> covered;
+        for (uint32_t pixel : rasterizer.getPixels()) {
+            covered.push_back(pixel == White);
+        }
+        return covered;
+    }
+}
+
+TEST(SoftwareRasterizer, ShadesEveryPixelOfAFanExactlyOnce) {
+    threading::ThreadPool pool(2);
+    raster::SoftwareRasterizer rasterizer(96, 64, pool, 16);
+
+    // Triangles around an off-center point out to the corners and the edge
+    // midpoints, so the fan covers the whole target. The first diagonal runs
+    // through pixel centers, where only the fill rule decides the owner.
+    std::vector<float> positions = {-1.f / 3.f, 0.f, -1.f, -1.f, 0.f, -1.f, 1.f, -1.f, 1.f, 0.f,
+                                    1.f, 1.f, 0.f, 1.f, -1.f, 1.f, -1.f, 0.f};
+    std::vector<uint32_t> indices;
+    for (uint32_t outer = 1; outer <= 8; ++outer) {
+        indices.insert(indices.end(), {0, outer, outer % 8 + 1});
+    }
+
+    std::vector<int> shaded(96 * 64, 0);
+    for (size_t first = 0; first < indices.size(); first += 3) {
+        auto covered = coverage(rasterizer, {positions.data(), indices.data() + first, 3});
+        for (size_t pixel = 0; pixel < covered.size(); ++pixel) {
+            shaded[pixel] += covered[pixel];
+        }
+    }
+
+    for (size_t pixel = 0; pixel < shaded.size(); ++pixel) {
+        ASSERT_EQ(shaded[pixel], 1) << "pixel " << pixel % 96 << ", " << pixel / 96;
+    }
+}
+
+TEST(SoftwareRasterizer, CircleIsRoundAndCoversItsArea) {
+    threading::ThreadPool pool(2);
+    raster::SoftwareRasterizer rasterizer(200, 100, pool, 32);
+
+    // A full-target quad, so only the circle test limits the coverage. The
+    // radius is in half heights: 25 pixels across a wider-than-tall target.
+    std::vector<float> positions = {-1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f, 1.f};
+    std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3};
+    raster::DrawCall call = {positions.data(), indices.data(), indices.size(), raster::Shader::Circle,
+                             {1.f, 1.f, 1.f, 1.f}, {0.f, 0.f}, 0.5f};
+    auto covered = coverage(rasterizer, call);
+
+    long count = std::count(covered.begin(), covered.end(), true);
+    int minX = 200, maxX = -1, minY = 100, maxY = -1;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 200; ++x) {
+            if (covered[y * 200 + x]) {
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+        }
+    }
+
+    const float radius = 25.f;
+    EXPECT_NEAR(static_cast<float>(count), 3.14159265f * radius * radius, radius);
+    EXPECT_EQ(maxX - minX + 1, 50);
+    EXPECT_EQ(maxY - minY + 1, 50);
+    EXPECT_EQ(minX, 75);
+    EXPECT_EQ(minY, 25);
+    EXPECT_EQ(rasterizer.getPixels()[0], Black);
+}
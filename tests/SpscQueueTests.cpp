@@ -0,0 +1,70 @@
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <gtest/gtest.h>
+#include "SpscQueue.h"
+
+TEST(SpscQueue, KeepsOrderAcrossTheWrap) {
+    threading::SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    int value = 0;
+    EXPECT_FALSE(queue.tryPop(value));
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            value = round * 4 + i;
+            ASSERT_TRUE(queue.tryPush(value));
+        }
+        // Full: the value is left for the caller to retry with.
+        value = -1;
+        EXPECT_FALSE(queue.tryPush(value));
+        EXPECT_EQ(value, -1);
+        EXPECT_EQ(queue.sizeApprox(), 4u);
+
+        for (int i = 0; i < 4; ++i) {
+            ASSERT_TRUE(queue.tryPop(value));
+            EXPECT_EQ(value, round * 4 + i);
+        }
+        EXPECT_FALSE(queue.tryPop(value));
+    }
+}
+
+TEST(SpscQueue, MovesValuesThroughAndOut) {
+    threading::SpscQueue<std::unique_ptr<int>> queue(2);
+    auto value = std::make_unique<int>(7);
+    ASSERT_TRUE(queue.tryPush(value));
+    EXPECT_EQ(value, nullptr);
+
+    std::unique_ptr<int> popped;
+    ASSERT_TRUE(queue.tryPop(popped));
+    EXPECT_EQ(*popped, 7);
+}
+
+TEST(SpscQueue, TransfersEverythingBetweenThreads) {
+    const uint64_t Count = 200000;
+    threading::SpscQueue<uint64_t> queue(64);
+
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= Count; ++i) {
+            uint64_t value = i;
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 1;
+    size_t outOfOrder = 0;
+    uint64_t value;
+    while (expected <= Count) {
+        if (queue.tryPop(value)) {
+            outOfOrder += value != expected;
+            expected = value + 1;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_EQ(queue.sizeApprox(), 0u);
+}
@@ -0,0 +1,66 @@
+#include <filesystem>
+#include <gtest/gtest.h>
+#include "TextureCache.h"
+#include "TextureCompression.h"
+
+namespace {
+    const textures::CacheStamp Stamp = {1234, 5678, textures::MipFilter::Box, false};
+
+    // A full chain of the given level sizes; the data is never read back.
+    textures::TextureData makeTexture(textures::PixelFormat format, std::vector<std::pair<int, int>> sizes) {
+        textures::TextureData texture;
+        texture.format = format;
+        texture.width = sizes.front().first;
+        texture.height = sizes.front().second;
+        texture.storage.resize(1 << 12);
+        for (const auto &size : sizes) {
+            size_t bytes = format == textures::PixelFormat::Bc1 ? textures::bc1Size(size.first, size.second)
+                                                                : static_cast<size_t>(size.first) * size.second * 4;
+            texture.levels.push_back({size.first, size.second, texture.storage.data(), bytes});
+        }
+        return texture;
+    }
+
+    class TextureCache : public testing::Test {
+    protected:
+        void TearDown() override { std::filesystem::remove(path); }
+
+        std::shared_ptr<textures::TextureData> roundTrip(const textures::TextureData &texture) {
+            EXPECT_TRUE(textures::writeTextureCache(path, Stamp, texture));
+            return textures::readTextureCache(path, Stamp);
+        }
+
+        std::string path = (std::filesystem::temp_directory_path() / "render_tests_texture.txc").string();
+    };
+}
+
+TEST_F(TextureCache, ReadsBackTheFullChain) {
+    auto texture = roundTrip(makeTexture(textures::PixelFormat::Rgba8, {{8, 2}, {4, 1}, {2, 1}, {1, 1}}));
+    ASSERT_NE(texture, nullptr);
+    ASSERT_EQ(texture->levels.size(), 4u);
+    EXPECT_EQ(texture->levels[1].width, 4);
+    EXPECT_EQ(texture->levels[1].size, 16u);
+
+    EXPECT_NE(roundTrip(makeTexture(textures::PixelFormat::Bc1, {{4, 4}, {2, 2}, {1, 1}})), nullptr);
+}
+
+TEST_F(TextureCache, RejectsLevelsWhoseSizeDisagreesWithTheirData) {
+    auto texture = makeTexture(textures::PixelFormat::Rgba8, {{4, 4}, {2, 2}, {1, 1}});
+    texture.levels[1].size = 4;
+    EXPECT_EQ(roundTrip(texture), nullptr);
+
+    texture = makeTexture(textures::PixelFormat::Bc1, {{4, 4}, {2, 2}, {1, 1}});
+    texture.levels[0].size = 64;
+    EXPECT_EQ(roundTrip(texture), nullptr);
+}
+
+TEST_F(TextureCache, RejectsChainsThatDontHalveDownToOne) {
+    EXPECT_EQ(roundTrip(makeTexture(textures::PixelFormat::Rgba8, {{4, 4}, {4, 4}, {1, 1}})), nullptr);
+    EXPECT_EQ(roundTrip(makeTexture(textures::PixelFormat::Rgba8, {{4, 4}, {2, 2}})), nullptr);
+    EXPECT_EQ(roundTrip(makeTexture(textures::PixelFormat::Rgba8, {{4, 4}, {2, 2}, {1, 1}, {1, 1}})), nullptr);
+
+    // The first level has to match the header.
+    auto texture = makeTexture(textures::PixelFormat::Rgba8, {{4, 4}, {2, 2}, {1, 1}});
+    texture.width = 5;
+    EXPECT_EQ(roundTrip(texture), nullptr);
+}
@@ -0,0 +1,125 @@
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TextureCompression.h"
+
+namespace {
+    // Decodes BC1 back to RGB as a GPU would, both palette modes.
+    std::vector<uint8_t> decodeBc1(const std::vector<uint8_t> &blocks, int width, int height) {
+        std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+        int blocksX = (width + 3) / 4;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const uint8_t *block = blocks.data() + (static_cast<size_t>(y / 4) * blocksX + x / 4) * 8;
+                uint16_t color0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+                uint16_t color1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+                int palette[4][3];
+                for (int entry = 0; entry < 2; ++entry) {
+                    uint16_t packed = entry == 0 ? color0 : color1;
+                    int r = packed >> 11 & 31;
+                    int g = packed >> 5 & 63;
+                    int b = packed & 31;
+                    palette[entry][0] = r << 3 | r >> 2;
+                    palette[entry][1] = g << 2 | g >> 4;
+                    palette[entry][2] = b << 3 | b >> 2;
+                }
+                for (int channel = 0; channel < 3; ++channel) {
+                    if (color0 > color1) {
+                        palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+                        palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+                    } else {
+                        palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+                        palette[3][channel] = 0;
+                    }
+                }
+
+                uint32_t indices = static_cast<uint32_t>(block[4] | block[5] << 8 | block[6] << 16) |
+                                   static_cast<uint32_t>(block[7]) << 24;
+                int index = indices >> (2 * ((y % 4) * 4 + x % 4)) & 3;
+                for (int channel = 0; channel < 3; ++channel) {
+                    rgb[(static_cast<size_t>(y) * width + x) * 3 + channel] =
+                            static_cast<uint8_t>(palette[index][channel]);
+                }
+            }
+        }
+        return rgb;
+    }
+
+    std::vector<uint8_t> compress(const std::vector<uint8_t> &rgba, int width, int height) {
+        std::vector<uint8_t> blocks(textures::bc1Size(width, height));
+        textures::compressBc1(rgba.data(), width, height, blocks.data());
+        return blocks;
+    }
+
+    int largestError(const std::vector<uint8_t> &rgba, const std::vector<uint8_t> &rgb) {
+        int largest = 0;
+        for (size_t i = 0; i < rgb.size() / 3; ++i) {
+            for (int channel = 0; channel < 3; ++channel) {
+                largest = std::max(largest, std::abs(rgba[i * 4 + channel] - rgb[i * 3 + channel]));
+            }
+        }
+        return largest;
+    }
+}
+
+TEST(TextureCompression, SolidBlockUsesOneEndpoint) {
+    std::vector<uint8_t> rgba;
+    for (int i = 0; i < 16; ++i) {
+        rgba.insert(rgba.end(), {255, 0, 0, 255});
+    }
+    auto blocks = compress(rgba, 4, 4);
+    ASSERT_EQ(blocks.size(), 8u);
+    // Pure red is 0xf800 in RGB565 for both endpoints, and every index is 0.
+    EXPECT_EQ(blocks, (std::vector<uint8_t>{0x00, 0xf8, 0x00, 0xf8, 0, 0, 0, 0}));
+    EXPECT_EQ(largestError(rgba, decodeBc1(blocks, 4, 4)), 0);
+}
+
+TEST(TextureCompression, TwoColourBlockPicksTheNearestEntries) {
+    // Left half dark, right half light; the inset keeps both inside the palette.
+    std::vector<uint8_t> rgba;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            uint8_t value = x < 2 ? 40 : 200;
+            rgba.insert(rgba.end(), {value, value, value, 255});
+        }
+    }
+    auto blocks = compress(rgba, 4, 4);
+    uint16_t color0 = static_cast<uint16_t>(blocks[0] | blocks[1] << 8);
+    uint16_t color1 = static_cast<uint16_t>(blocks[2] | blocks[3] << 8);
+    EXPECT_GT(color0, color1);
+    auto rgb = decodeBc1(blocks, 4, 4);
+    EXPECT_LE(largestError(rgba, rgb), 16);
+    // Each half decodes to one colour.
+    EXPECT_EQ(rgb[0], rgb[3]);
+    EXPECT_EQ(rgb[2 * 3], rgb[3 * 3]);
+}
+
+TEST(TextureCompression, PartialEdgeBlocksRepeatTheLastPixels) {
+    EXPECT_EQ(textures::bc1Size(5, 3), 16u);
+    EXPECT_EQ(textures::bc1Size(1, 1), 8u);
+
+    // A 5x3 image: a ramp whose channels rise together across the first
+    // block, so it lies along the bounding box diagonal, and one colour in
+    // the second, which only has its first column filled from the image.
+    std::vector<uint8_t> rgba;
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            uint8_t value = x == 4 ? 128 : static_cast<uint8_t>(x * 60 + y * 10);
+            rgba.insert(rgba.end(), {value, static_cast<uint8_t>(value / 2), 64, 255});
+        }
+    }
+    auto blocks = compress(rgba, 5, 3);
+    EXPECT_LE(largestError(rgba, decodeBc1(blocks, 5, 3)), 24);
+
+    // The second block saw only repeats of its one pixel, so it is solid.
+    EXPECT_EQ(blocks[8], blocks[10]);
+    EXPECT_EQ(blocks[9], blocks[11]);
+    EXPECT_EQ(blocks[12] | blocks[13] | blocks[14] | blocks[15], 0);
+}
+
+TEST(TextureCompression, FindsTransparency) {
+    std::vector<uint8_t> rgba = {1, 2, 3, 255, 4, 5, 6, 255};
+    EXPECT_FALSE(textures::hasTransparency(rgba.data(), 2));
+    rgba[7] = 254;
+    EXPECT_TRUE(textures::hasTransparency(rgba.data(), 2));
+}
@@ -0,0 +1,148 @@
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "TransformSystem.h"
+
+namespace {
+    // Everything in [-10, 10]^2, with no screen-size limit.
+    scene::Frustum everything() {
+        return scene::Frustum::fromMatrix(glm::ortho(-10.f, 10.f, -10.f, 10.f, -1.f, 1.f), 0.f, 0.f);
+    }
+
+    struct Local {
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    glm::mat4 toMatrix(const Local &local) {
+        return glm::translate(glm::mat4(1.f), local.position) * glm::mat4_cast(local.rotation) *
+               glm::scale(glm::mat4(1.f), local.scale);
+    }
+
+    // Roots scattered around the origin, each with children and grandchildren,
+    // every object turned and scaled differently. A few have nothing to draw.
+    std::vector<Local> makeForest(scene::TransformSystem &transforms, size_t count) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> spread(-40.f, 40.f);
+        std::uniform_real_distribution<float> offset(-3.f, 3.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        std::vector<Local> locals;
+        for (size_t i = 0; i < count; ++i) {
+            // Groups of nine: a root, two children and two chains of three below them.
+            size_t slot = i % 9;
+            scene::ObjectId parent =
+                    slot == 0 ? scene::NoParent : static_cast<scene::ObjectId>(slot < 3 ? i - slot : i - 2);
+            Local local;
+            local.position = parent == scene::NoParent ? glm::vec3(spread(random), spread(random), spread(random))
+                                                       : glm::vec3(offset(random), offset(random), offset(random));
+            local.rotation = glm::angleAxis(unit(random) * 6.2831853f,
+                                            glm::normalize(glm::vec3(unit(random), unit(random), 0.5f)));
+            local.scale = glm::vec3(0.5f + unit(random), 0.5f + unit(random), 0.5f + unit(random));
+
+            scene::ObjectId object = transforms.create(parent);
+            transforms.setPosition(object, local.position);
+            transforms.setRotation(object, local.rotation);
+            transforms.setScale(object, local.scale);
+            transforms.setLocalBounds(object, glm::vec3(offset(random), 0.f, 0.f), i % 13 == 0 ? -1.f : unit(random));
+            locals.push_back(local);
+        }
+        return locals;
+    }
+
+    void expectWorldMatrices(const scene::TransformSystem &transforms, const std::vector<Local> &locals) {
+        std::vector<glm::mat4> world(locals.size());
+        for (scene::ObjectId object = 0; object < locals.size(); ++object) {
+            scene::ObjectId parent = transforms.getParent(object);
+            world[object] = (parent == scene::NoParent ? glm::mat4(1.f) : world[parent]) * toMatrix(locals[object]);
+            for (int column = 0; column < 4; ++column) {
+                for (int row = 0; row < 4; ++row) {
+                    ASSERT_NEAR(transforms.getWorldMatrix(object)[column][row], world[object][column][row], 1e-3f)
+                            << "object " << object;
+                }
+            }
+        }
+    }
+}
+
+TEST(TransformSystem, NegativeRadiusNeverPassesCull) {
+    threading::ThreadPool pool(1);
+    scene::TransformSystem transforms(pool);
+    // More than a SIMD batch, so both the vector and the scalar tail paths see some.
+    for (int i = 0; i < 19; ++i) {
+        scene::ObjectId object = transforms.create();
+        transforms.setPosition(object, {static_cast<float>(i % 5), 0.f, 0.f});
+        transforms.setLocalBounds(object, glm::vec3(0.f), i % 3 == 0 ? -1.f : 0.f);
+    }
+    // A zero scale turns the negative radius into -0.
+    transforms.setScale(0, glm::vec3(0.f));
+    transforms.update();
+
+    std::vector<scene::ObjectId> visible;
+    transforms.cull(everything(), visible);
+    for (scene::ObjectId object : visible) {
+        EXPECT_NE(object % 3, 0u) << object;
+    }
+    EXPECT_EQ(visible.size(), 12u);
+
+    EXPECT_FALSE(everything().isVisible(glm::vec3(0.f), -1.f));
+    EXPECT_FALSE(everything().isVisible(glm::vec3(0.f), -0.f));
+    EXPECT_TRUE(everything().isVisible(glm::vec3(0.f), 0.f));
+}
+
+TEST(TransformSystem, CullMatchesTheScalarTest) {
+    threading::ThreadPool pool(2);
+    scene::TransformSystem transforms(pool);
+    makeForest(transforms, 1003);
+    transforms.update();
+
+    // Looking down +z from inside the cloud, so spheres fail every plane, and
+    // with a screen-size limit that drops the far small ones.
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 60.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, -20.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    auto frustum = scene::Frustum::fromMatrix(projection * view, projection[1][1] * 1080.f * 0.5f, 8.f);
+
+    std::vector<scene::ObjectId> expected;
+    for (scene::ObjectId object = 0; object < transforms.size(); ++object) {
+        glm::vec4 bounds = transforms.getWorldBounds(object);
+        if (frustum.isVisible(glm::vec3(bounds), bounds.w)) {
+            expected.push_back(object);
+        }
+    }
+    ASSERT_GT(expected.size(), 50u);
+    ASSERT_LT(expected.size(), 800u);
+
+    std::vector<scene::ObjectId> visible;
+    transforms.cull(frustum, visible);
+    EXPECT_EQ(visible, expected);
+    EXPECT_EQ(transforms.getStats().visible, expected.size());
+}
+
+TEST(TransformSystem, UpdatesFollowTheHierarchy) {
+    threading::ThreadPool pool(2);
+    scene::TransformSystem transforms(pool);
+    std::vector<Local> locals = makeForest(transforms, 90);
+    transforms.update();
+    EXPECT_EQ(transforms.getStats().updated, locals.size());
+    expectWorldMatrices(transforms, locals);
+
+    transforms.update();
+    EXPECT_EQ(transforms.getStats().updated, 0u);
+
+    // Moving a root carries its eight descendants along and nothing else.
+    locals[18].rotation = glm::angleAxis(0.5f, glm::vec3(0.f, 0.f, 1.f)) * locals[18].rotation;
+    transforms.setRotation(18, locals[18].rotation);
+    // Deeper in another group, an object moves with its two descendants.
+    locals[40].position += glm::vec3(1.f, 0.f, 0.f);
+    transforms.setPosition(40, locals[40].position);
+    transforms.update();
+    EXPECT_EQ(transforms.getStats().updated, 12u);
+    expectWorldMatrices(transforms, locals);
+
+    std::vector<glm::mat4> gathered(2);
+    transforms.gatherMatrices({18, 40}, gathered.data());
+    EXPECT_EQ(gathered[0], transforms.getWorldMatrix(18));
+    EXPECT_EQ(gathered[1], transforms.getWorldMatrix(40));
+}
@@ -0,0 +1,64 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TripleBuffer.h"
+
+TEST(TripleBuffer, HandsOverTheNewestValue) {
+    threading::TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.hasUpdate());
+    EXPECT_FALSE(buffer.update());
+
+    buffer.getBack() = 1;
+    EXPECT_TRUE(buffer.publish());
+    buffer.getBack() = 2;
+    // 1 was never seen.
+    EXPECT_FALSE(buffer.publish());
+
+    EXPECT_TRUE(buffer.hasUpdate());
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getFront(), 2);
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.getFront(), 2);
+
+    // The writer's slot never aliases the front one.
+    buffer.getBack() = 3;
+    EXPECT_EQ(buffer.getFront(), 2);
+    EXPECT_TRUE(buffer.publish());
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getFront(), 3);
+}
+
+TEST(TripleBuffer, ReaderNeverSeesATornValue) {
+    const uint64_t Publishes = 20000;
+    threading::TripleBuffer<std::vector<uint64_t>> buffer;
+
+    std::thread writer([&] {
+        for (uint64_t sequence = 1; sequence <= Publishes; ++sequence) {
+            buffer.getBack().assign(64, sequence);
+            buffer.publish();
+        }
+    });
+
+    uint64_t last = 0;
+    size_t torn = 0;
+    while (last < Publishes) {
+        if (!buffer.update()) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Failing here would leave the writer unjoined, so only count.
+        const auto &value = buffer.getFront();
+        if (value.size() != 64) {
+            ++torn;
+            break;
+        }
+        for (uint64_t element : value) {
+            torn += element != value.front();
+        }
+        torn += value.front() <= last;
+        last = value.front();
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0u);
+}
@@ -0,0 +1,112 @@
+// Renders the figure scene with the software rasterizer, no window or GL
+// context, and writes the last frame as a PPM. Links only render_core, so it
+// builds and runs where GLFW and GLEW aren't available.
+//
+// Usage: headless_renderer [--frames N] [--threads N] [--size WxH] [--output file.ppm] [--trace file.json]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Profiler.h"
+#include "SceneInstancer.h"
+#include "SceneText.h"
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include "TransformSystem.h"
+
+namespace {
+    const char *const ScenePath = "resources/scenes/figure.scene";
+}
+
+int main(int argc, char **argv) {
+    size_t frames = 1000;
+    unsigned threads = std::thread::hardware_concurrency();
+    int width = 640;
+    int height = 480;
+    std::string output = "frame.ppm";
+    std::string tracePath;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+
+        if (option == "--frames") {
+            frames = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (option == "--size") {
+            auto separator = value.find('x');
+            width = std::atoi(value.substr(0, separator).c_str());
+            height = separator == std::string::npos ? width : std::atoi(value.substr(separator + 1).c_str());
+        } else if (option == "--output") {
+            output = value;
+        } else if (option == "--trace") {
+            tracePath = value;
+        } else {
+            std::cerr << "Unknown option '" << option << "'.\n";
+            return -1;
+        }
+    }
+
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Invalid framebuffer size.\n";
+        return -1;
+    }
+
+    threading::ThreadPool pool(threads);
+    raster::SoftwareRasterizer rasterizer(width, height, pool);
+
+    std::unique_ptr<scene::SceneFile> figure;
+    try {
+        figure = scene::loadScene(ScenePath);
+    } catch (const std::runtime_error &error) {
+        std::cerr << error.what() << '\n';
+        return -1;
+    }
+
+    // The figure is small and entirely on screen: one call instantiates it.
+    scene::TransformSystem transforms(pool);
+    scene::SceneInstancer instancer(*figure, transforms);
+    const auto &created = instancer.instantiate(scene::Frustum::fromMatrix(glm::mat4(1.f), height * 0.5f, 0.5f));
+    transforms.update();
+    std::vector<scene::BakedNode> nodes;
+    scene::bakeSceneNodes(*figure, instancer, transforms, created, nodes);
+
+    std::vector<raster::DrawCall> draws;
+    for (const auto &node : nodes) {
+        const float *color = figure->getMaterials()[node.material].color;
+        draws.push_back({node.vertices.data(), node.indices, node.indexCount,
+                         node.circle ? raster::Shader::Circle : raster::Shader::Flat,
+                         {color[0], color[1], color[2], color[3]}, node.center, node.radius});
+    }
+
+#ifdef PROFILER_ENABLED
+    if (!tracePath.empty()) {
+        profiling::Profiler::instance().startCapture();
+    }
+#endif
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < frames; ++frame) {
+        rasterizer.clear({1.f, 0.5f, 0.f, 1.0f});
+        for (auto &draw : draws) {
+            rasterizer.draw(draw);
+        }
+        rasterizer.flush();
+        PROFILE_END_FRAME();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (frames != 0) {
+        std::cout << "Software path: " << frames << " frames, " << elapsed.count() / frames << " ms/frame, "
+                  << frames * 1000.0 / elapsed.count() << " frames/s on " << pool.size() << " threads\n";
+    }
+    profiling::reportProfile(tracePath);
+
+    return rasterizer.writePpm(output.c_str()) ? 0 : -1;
+}
@@ -0,0 +1,309 @@
+// Offline converter from anything Assimp imports to the MeshFormat.h binary.
+//
+// Usage: mesh_converter input.(obj|fbx|...) output.mesh [--no-optimize]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include "glm_utils.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+
+namespace {
+    // What a runtime Assimp path would have to ask for to get drawable data.
+    const unsigned ImportFlags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals;
+
+    struct SourceMesh {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec2> uvs;
+        std::vector<uint32_t> indices;
+        uint32_t materialIndex;
+    };
+
+    struct Bounds {
+        glm::vec3 min = glm::vec3(INFINITY);
+        glm::vec3 max = glm::vec3(-INFINITY);
+    };
+
+    // Bakes the node hierarchy: one source mesh per mesh instance.
+    void collectMeshes(const aiScene *scene, const aiNode *node, const glm::mat4 &parent,
+                       std::vector<SourceMesh> &meshes, Bounds &bounds) {
+        glm::mat4 transform = parent * glm::toGlm(node->mTransformation);
+        glm::mat3 normalTransform = glm::inverseTranspose(glm::mat3(transform));
+
+        for (unsigned i = 0; i < node->mNumMeshes; ++i) {
+            const aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
+            SourceMesh source;
+            source.materialIndex = mesh->mMaterialIndex;
+
+            for (unsigned vertex = 0; vertex < mesh->mNumVertices; ++vertex) {
+                glm::vec3 position = glm::vec3(transform * glm::vec4(glm::toGlm(mesh->mVertices[vertex]), 1.f));
+                source.positions.push_back(position);
+                bounds.min = glm::min(bounds.min, position);
+                bounds.max = glm::max(bounds.max, position);
+
+                glm::vec3 normal = mesh->HasNormals() ? normalTransform * glm::toGlm(mesh->mNormals[vertex])
+                                                      : glm::vec3(0.f, 0.f, 1.f);
+                float length = glm::length(normal);
+                source.normals.push_back(length > 0.f ? normal / length : glm::vec3(0.f, 0.f, 1.f));
+
+                source.uvs.push_back(mesh->HasTextureCoords(0) ? glm::vec2(glm::toGlm(mesh->mTextureCoords[0][vertex]))
+                                                               : glm::vec2(0.f));
+            }
+
+            // Points and lines can survive triangulation; they aren't drawn.
+            for (unsigned face = 0; face < mesh->mNumFaces; ++face) {
+                const aiFace &indices = mesh->mFaces[face];
+                if (indices.mNumIndices == 3) {
+                    source.indices.insert(source.indices.end(), indices.mIndices, indices.mIndices + 3);
+                }
+            }
+
+            if (!source.indices.empty()) {
+                meshes.push_back(std::move(source));
+            }
+        }
+
+        for (unsigned i = 0; i < node->mNumChildren; ++i) {
+            collectMeshes(scene, node->mChildren[i], transform, meshes, bounds);
+        }
+    }
+
+    uint16_t toHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = bits >> 16 & 0x8000;
+        int exponent = static_cast<int>(bits >> 23 & 0xff) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if (exponent <= 0) {
+            return static_cast<uint16_t>(sign);  // flush denormals, UVs don't need them
+        }
+        if (exponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7c00);
+        }
+
+        // Round to nearest; a carry into the exponent is still correct.
+        return static_cast<uint16_t>(sign | ((exponent << 10 | mantissa >> 13) + (mantissa >> 12 & 1)));
+    }
+
+    uint32_t packNormal(const glm::vec3 &normal) {
+        auto component = [](float value) {
+            return static_cast<uint32_t>(static_cast<int32_t>(std::round(glm::clamp(value, -1.f, 1.f) * 511.f)) & 0x3ff);
+        };
+        return component(normal.x) | component(normal.y) << 10 | component(normal.z) << 20;
+    }
+
+    meshes::PackedVertex packVertex(const SourceMesh &source, size_t vertex, const Bounds &bounds) {
+        meshes::PackedVertex packed = {};
+        glm::vec3 extent = bounds.max - bounds.min;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            float unit = extent[axis] > 0.f ? (source.positions[vertex][axis] - bounds.min[axis]) / extent[axis] : 0.f;
+            packed.position[axis] = static_cast<uint16_t>(std::round(glm::clamp(unit, 0.f, 1.f) * 65535.f));
+        }
+        packed.normal = packNormal(source.normals[vertex]);
+        packed.uv[0] = toHalf(source.uvs[vertex].x);
+        packed.uv[1] = toHalf(source.uvs[vertex].y);
+        return packed;
+    }
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + meshes::MeshAlignment - 1) & ~(meshes::MeshAlignment - 1);
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: mesh_converter input output.mesh [--no-optimize]\n";
+        return -1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+    bool optimize = !(argc > 3 && std::string(argv[3]) == "--no-optimize");
+
+    Assimp::Importer importer;
+    auto start = std::chrono::steady_clock::now();
+    const aiScene *scene = importer.ReadFile(inputPath, ImportFlags);
+    double assimpMs = millisecondsSince(start);
+
+    if (scene == nullptr || scene->mRootNode == nullptr) {
+        std::cerr << "Can't import '" << inputPath << "': " << importer.GetErrorString() << '\n';
+        return -1;
+    }
+
+    std::vector<SourceMesh> sources;
+    Bounds bounds;
+    collectMeshes(scene, scene->mRootNode, glm::mat4(1.f), sources, bounds);
+    if (sources.empty()) {
+        std::cerr << "'" << inputPath << "' has no triangles.\n";
+        return -1;
+    }
+
+    size_t assimpVertices = 0;
+    for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
+        assimpVertices += scene->mMeshes[i]->mNumVertices;
+    }
+
+    std::vector<meshes::PackedVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<meshes::Submesh> submeshes;
+    float missRatioBefore = 0.f;
+    float missRatioAfter = 0.f;
+
+    for (const auto &source : sources) {
+        std::vector<meshes::PackedVertex> packed;
+        for (size_t vertex = 0; vertex < source.positions.size(); ++vertex) {
+            packed.push_back(packVertex(source, vertex, bounds));
+        }
+
+        std::vector<uint32_t> local = source.indices;
+        meshes::deduplicateVertices(packed, local);
+
+        // Quantization can collapse tiny triangles; they'd only cost vertex work.
+        std::vector<uint32_t> kept;
+        for (size_t i = 0; i < local.size(); i += 3) {
+            if (local[i] != local[i + 1] && local[i] != local[i + 2] && local[i + 1] != local[i + 2]) {
+                kept.insert(kept.end(), local.begin() + i, local.begin() + i + 3);
+            }
+        }
+        local.swap(kept);
+        if (local.empty()) {
+            continue;
+        }
+
+        float triangles = static_cast<float>(local.size() / 3);
+        missRatioBefore += meshes::averageCacheMissRatio(local, packed.size()) * triangles;
+
+        if (optimize) {
+            std::vector<glm::vec3> positions;
+            for (const auto &vertex : packed) {
+                positions.emplace_back(bounds.min + glm::vec3(vertex.position[0], vertex.position[1],
+                                                              vertex.position[2]) / 65535.f * (bounds.max - bounds.min));
+            }
+
+            meshes::optimizeVertexCache(local, packed.size());
+            meshes::optimizeOverdraw(local, positions);
+        }
+        meshes::optimizeVertexFetch(packed, local);
+        missRatioAfter += meshes::averageCacheMissRatio(local, packed.size()) * triangles;
+
+        submeshes.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(local.size()),
+                             static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(packed.size()),
+                             source.materialIndex});
+        vertices.insert(vertices.end(), packed.begin(), packed.end());
+        indices.insert(indices.end(), local.begin(), local.end());
+    }
+
+    if (indices.empty()) {
+        std::cerr << "'" << inputPath << "' has no triangles left after quantization.\n";
+        return -1;
+    }
+
+    bool shortIndices = std::all_of(submeshes.begin(), submeshes.end(),
+                                    [](const meshes::Submesh &submesh) { return submesh.vertexCount <= 65536; });
+    size_t indexSize = shortIndices ? 2 : 4;
+
+    meshes::MeshHeader header = {};
+    header.magic = meshes::MeshMagic;
+    header.version = meshes::MeshVersion;
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.indexType = static_cast<uint32_t>(shortIndices ? meshes::IndexType::Uint16 : meshes::IndexType::Uint32);
+    header.submeshCount = static_cast<uint32_t>(submeshes.size());
+    for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = bounds.min[axis];
+        header.boundsMax[axis] = bounds.max[axis];
+    }
+    header.vertexOffset = alignUp(sizeof(header));
+    header.indexOffset = alignUp(header.vertexOffset + vertices.size() * sizeof(meshes::PackedVertex));
+    header.submeshOffset = alignUp(header.indexOffset + indices.size() * indexSize);
+
+    {
+        std::ofstream stream(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            std::cerr << "Can't write '" << outputPath << "'.\n";
+            return -1;
+        }
+
+        const char padding[meshes::MeshAlignment] = {};
+        auto pad = [&stream, &padding](uint64_t offset) {
+            stream.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(stream.tellp())));
+        };
+
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        pad(header.vertexOffset);
+        stream.write(reinterpret_cast<const char *>(vertices.data()), vertices.size() * sizeof(meshes::PackedVertex));
+        pad(header.indexOffset);
+        if (shortIndices) {
+            std::vector<uint16_t> narrow(indices.begin(), indices.end());
+            stream.write(reinterpret_cast<const char *>(narrow.data()), narrow.size() * sizeof(uint16_t));
+        } else {
+            stream.write(reinterpret_cast<const char *>(indices.data()), indices.size() * sizeof(uint32_t));
+        }
+        pad(header.submeshOffset);
+        stream.write(reinterpret_cast<const char *>(submeshes.data()), submeshes.size() * sizeof(meshes::Submesh));
+
+        if (!stream) {
+            std::cerr << "Can't write '" << outputPath << "'.\n";
+            return -1;
+        }
+    }
+
+    // Open and touch every page, so the time includes faulting the data in
+    // rather than just reserving address space.
+    const int LoadRuns = 10;
+    double loadMs = 0.0;
+    size_t fileSize = 0;
+    try {
+        for (int run = 0; run < LoadRuns; ++run) {
+            start = std::chrono::steady_clock::now();
+            meshes::MeshFile file(outputPath);
+            auto bytes = reinterpret_cast<const volatile char *>(file.getVertices());
+            size_t span = header.submeshOffset - header.vertexOffset;
+            char sum = 0;
+            for (size_t offset = 0; offset < span; offset += 4096) {
+                sum = static_cast<char>(sum + bytes[offset]);
+            }
+            (void) sum;
+            loadMs += millisecondsSince(start);
+            fileSize = header.submeshOffset + submeshes.size() * sizeof(meshes::Submesh);
+        }
+    } catch (std::runtime_error &exception) {
+        std::cerr << exception.what() << '\n';
+        return -1;
+    }
+
+    float triangleCount = static_cast<float>(indices.size() / 3);
+    std::cout << inputPath << " -> " << outputPath << '\n'
+              << "  " << submeshes.size() << " submeshes, " << vertices.size() << " vertices (Assimp: "
+              << assimpVertices << "), " << indices.size() / 3 << " triangles, "
+              << (shortIndices ? "16" : "32") << "-bit indices\n"
+              << "  ACMR (16-entry FIFO): " << missRatioBefore / triangleCount << " -> "
+              << missRatioAfter / triangleCount << '\n'
+              << "  bytes/vertex: " << sizeof(meshes::PackedVertex) << " (Assimp float position/normal/uv: "
+              << sizeof(float) * 8 << ")\n"
+              << "  load: " << loadMs / LoadRuns << " ms mmap of " << fileSize << " bytes (Assimp import: "
+              << assimpMs << " ms)\n";
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <glm/geometric.hpp>
+#include "Hash.h"
+#include "MeshOptimizer.h"
+
+namespace {
+    const int CacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+
+    float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+        if (remainingTriangles == 0) {
+            return -1.f;
+        }
+
+        float score = 0.f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // Just used: a strip-like continuation would be too good a deal.
+                score = LastTriangleScore;
+            } else {
+                float scaler = 1.f / (CacheSize - 3);
+                score = std::pow(1.f - (cachePosition - 3) * scaler, CacheDecayPower);
+            }
+        }
+
+        // Vertices with few triangles left get a boost, so they're finished off
+        // instead of lingering as islands.
+        return score + ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+    }
+
+    struct VertexHash {
+        size_t operator()(const meshes::PackedVertex &vertex) const {
+            return static_cast<size_t>(hashing::fnv1a(&vertex, sizeof(vertex)));
+        }
+    };
+
+    struct VertexEqual {
+        bool operator()(const meshes::PackedVertex &a, const meshes::PackedVertex &b) const {
+            return std::memcmp(&a, &b, sizeof(a)) == 0;
+        }
+    };
+}
+
+void meshes::deduplicateVertices(std::vector<PackedVertex> &vertices, std::vector<uint32_t> &indices) {
+    std::unordered_map<PackedVertex, uint32_t, VertexHash, VertexEqual> unique;
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<PackedVertex> merged;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto inserted = unique.emplace(vertices[i], static_cast<uint32_t>(merged.size()));
+        if (inserted.second) {
+            merged.push_back(vertices[i]);
+        }
+        remap[i] = inserted.first->second;
+    }
+
+    for (auto &index : indices) {
+        index = remap[index];
+    }
+    vertices.swap(merged);
+}
+
+void meshes::optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Triangles around each vertex; the first `remaining` entries of a vertex's
+    // range are the ones not emitted yet.
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices) {
+        ++remaining[index];
+    }
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        scores[vertex] = vertexScore(-1, remaining[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        triangleScores[triangle] = scores[indices[triangle * 3]] + scores[indices[triangle * 3 + 1]] +
+                                   scores[indices[triangle * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    size_t scanCursor = 0;
+    long best = static_cast<long>(std::max_element(triangleScores.begin(), triangleScores.end()) -
+                                  triangleScores.begin());
+
+    while (output.size() < indices.size()) {
+        if (best < 0) {
+            // Nothing in the cache touches a live triangle: start a new island.
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            best = static_cast<long>(scanCursor);
+        }
+
+        emitted[best] = true;
+        const uint32_t *triangle = &indices[best * 3];
+        nextCache.assign(triangle, triangle + 3);
+
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t vertex = triangle[corner];
+            output.push_back(vertex);
+
+            uint32_t *begin = &adjacency[offsets[vertex]];
+            uint32_t *end = begin + remaining[vertex];
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(best)), end - 1);
+            --remaining[vertex];
+        }
+
+        for (uint32_t vertex : cache) {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            uint32_t vertex = nextCache[i];
+            cachePosition[vertex] = i < CacheSize ? static_cast<int>(i) : -1;
+            scores[vertex] = vertexScore(cachePosition[vertex], remaining[vertex]);
+        }
+
+        // Only triangles around vertices whose score just changed can change.
+        best = -1;
+        float bestScore = -1.f;
+        for (uint32_t vertex : nextCache) {
+            for (uint32_t i = 0; i < remaining[vertex]; ++i) {
+                uint32_t candidate = adjacency[offsets[vertex] + i];
+                const uint32_t *corners = &indices[candidate * 3];
+                float score = scores[corners[0]] + scores[corners[1]] + scores[corners[2]];
+                triangleScores[candidate] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = candidate;
+                }
+            }
+        }
+
+        if (nextCache.size() > CacheSize) {
+            nextCache.resize(CacheSize);
+        }
+        cache.swap(nextCache);
+    }
+
+    indices.swap(output);
+}
+
+void meshes::optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions) {
+    const size_t FifoSize = 16;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    std::vector<size_t> clusterStarts;
+    std::vector<uint32_t> fifo(positions.size(), 0);
+    uint32_t time = FifoSize + 1;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if (time - fifo[vertex] > FifoSize) {
+                fifo[vertex] = time++;
+                ++misses;
+            }
+        }
+
+        if (misses == 3 || triangle == 0) {
+            clusterStarts.push_back(triangle);
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.f);
+    for (const auto &position : positions) {
+        meshCentroid += position;
+    }
+    meshCentroid /= static_cast<float>(std::max<size_t>(positions.size(), 1));
+
+    size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+        glm::vec3 centroid(0.f);
+        glm::vec3 normal(0.f);
+        float area = 0.f;
+
+        for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle) {
+            const glm::vec3 &a = positions[indices[triangle * 3]];
+            const glm::vec3 &b = positions[indices[triangle * 3 + 1]];
+            const glm::vec3 &c = positions[indices[triangle * 3 + 2]];
+
+            glm::vec3 cross = glm::cross(b - a, c - a);
+            float triangleArea = glm::length(cross);
+            centroid += (a + b + c) * (triangleArea / 3.f);
+            normal += cross;
+            area += triangleArea;
+        }
+
+        if (area > 0.f) {
+            centroid /= area;
+        }
+        float normalLength = glm::length(normal);
+        sortKeys[cluster] = normalLength > 0.f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t cluster : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3,
+                      indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+void meshes::optimizeVertexFetch(std::vector<PackedVertex> &vertices, std::vector<uint32_t> &indices) {
+    const uint32_t Unused = ~0u;
+    std::vector<uint32_t> remap(vertices.size(), Unused);
+    std::vector<PackedVertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (auto &index : indices) {
+        if (remap[index] == Unused) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+}
+
+float meshes::averageCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount, size_t cacheSize) {
+    if (indices.size() < 3) {
+        return 0.f;
+    }
+
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (time - insertedAt[index] > cacheSize) {
+            insertedAt[index] = time++;
+            ++misses;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+#include "MeshFormat.h"
+
+// Index and vertex reordering used by mesh_converter. All functions work on
+// triangle lists.
+namespace meshes {
+    // Merges bit-identical vertices (after quantization, so near-duplicates that
+    // quantize alike merge too) and rewrites the indices.
+    void deduplicateVertices(std::vector<PackedVertex> &vertices, std::vector<uint32_t> &indices);
+
+    // Tom Forsyth's linear-speed vertex cache optimization: greedily emits the
+    // triangle whose vertices score best against a simulated LRU cache.
+    void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+    // Splits a cache-optimized order into clusters at the triangles that miss
+    // the cache on all three vertices, where the order can be broken at little
+    // cost, and sorts the clusters so outward-facing ones on the outside of the
+    // mesh draw first and occlude the rest.
+    void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions);
+
+    // Renumbers vertices in order of first use and drops unused ones, so the
+    // vertex fetch walks memory forward.
+    void optimizeVertexFetch(std::vector<PackedVertex> &vertices, std::vector<uint32_t> &indices);
+
+    // Cache misses per triangle for a FIFO cache of the given size; 0.5 is the
+    // best a regular grid can do, 3 the worst anything can.
+    float averageCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount, size_t cacheSize = 16);
+}
@@ -0,0 +1,63 @@
+// Offline compiler from the SceneText.h authoring form to the SceneFormat.h
+// binary.
+//
+// Usage: scene_compiler input.scene.txt output.scene
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SceneFile.h"
+#include "SceneText.h"
+
+namespace {
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: scene_compiler input.scene.txt output.scene\n";
+        return -1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+
+    std::ifstream input(inputPath);
+    if (!input.is_open()) {
+        std::cerr << "Can't open '" << inputPath << "'\n";
+        return -1;
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        scene::SceneDescription description = scene::parseSceneText(input, inputPath);
+        double parseMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<char> image = scene::compileScene(description);
+        double compileMs = millisecondsSince(start);
+
+        std::ofstream output(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        output.write(image.data(), static_cast<std::streamsize>(image.size()));
+        output.close();
+        if (!output) {
+            std::cerr << "Can't write '" << outputPath << "'\n";
+            return -1;
+        }
+
+        // Reads the result back the way the runtime will.
+        scene::SceneFile compiled(outputPath);
+        std::cout << inputPath << ": " << compiled.getNodeCount() << " nodes, " << compiled.getMeshCount()
+                  << " meshes, " << compiled.getMaterialCount() << " materials, " << compiled.getSize()
+                  << " bytes (parsed in " << parseMs << " ms, compiled in " << compileMs << " ms)\n";
+    } catch (const std::runtime_error &error) {
+        std::cerr << error.what() << '\n';
+        return -1;
+    }
+    return 0;
+}